@@ -84,6 +84,7 @@ public:
     int read();
     int read(const char *line);
     int close();
+    int forked();
     int reset();
     int line();
     int call_level();
@@ -98,6 +99,8 @@ public:
             double settings[ACTIVE_SETTINGS],
             StateTag const &tag);
     int restore_from_tag(StateTag const &tag);
+    int save_checkpoint(std::string &state);
+    int restore_checkpoint(const char *state);
     void set_loglevel(int level);
     FILE *f;
     char filename[PATH_MAX];
@@ -690,6 +693,13 @@ int Canterp::close() {
     return INTERP_OK;
 }
 
+// the FILE shares its read position with the parent, leave it alone
+int Canterp::forked() {
+    f = NULL;
+    filename[0] = 0;
+    return INTERP_OK;
+}
+
 int Canterp::exit() { return 0; }
 int Canterp::synch() { return 0; }
 int Canterp::reset() { return 0; }
@@ -730,6 +740,8 @@ void Canterp::active_m_codes(int emms[]) { std::fill(emms, emms + ACTIVE_M_CODES
 void Canterp::active_settings(double sets[]) { std::fill(sets, sets + ACTIVE_SETTINGS, 0.0); }
 //NOT necessary for canterp
 int Canterp::restore_from_tag(StateTag const &tag) {return -1;}
+int Canterp::save_checkpoint(std::string &state) {return -1;}
+int Canterp::restore_checkpoint(const char *state) {return -1;}
 
 int Canterp::active_modes(int g_codes[ACTIVE_G_CODES],
         int m_codes[ACTIVE_M_CODES],
@@ -53,6 +53,15 @@
   HOME_LATCH_VEL <float>       homing speed, latch phase
   HOME_USE_INDEX <bool>        use index pulse when homing?
   HOME_IGNORE_LIMITS <bool>    ignore limit switches when homing?
+  HOME_SEQUENCE <int>          step of the home-all sequence
+  HOME_GROUP <int>             axes in different groups step through their
+                               sequences independently (default 0)
+  HOME_SEARCH_JERK <float>     if set, stop the search with this jerk limit
+                               when the switch is found (default 0, off)
+  HOME_INDEX_DIRECT <bool>     arm the index when the search finds the
+                               switch, without a latch pass (needs hardware
+                               index capture, and SEARCH_VEL and LATCH_VEL
+                               of the same sign)
   COMP_FILE <filename>         file of axis compensation points
 
   calls:
@@ -68,7 +77,8 @@
   emcAxisSetFerror(int axis, double ferror);
   emcAxisSetMinFerror(int axis, double ferror);
   emcAxisSetHomingParams(int axis, double home, double offset,
-    double search_vel, double latch_vel, int use_index, int ignore_limits );
+    double search_vel, double latch_vel, int use_index, int ignore_limits,
+    ..., int home_group, double search_jerk, int index_direct);
   emcAxisActivate(int axis);
   emcAxisDeactivate(int axis);
   emcAxisSetMaxVelocity(int axis, double vel);
@@ -96,6 +106,9 @@ static int loadAxis(int axis, EmcIniFile *axisIniFile)
     bool ignore_limits;
     bool is_shared;
     int sequence;
+    int home_group;
+    double search_jerk;
+    bool index_direct;
     int volatile_home;
     int locking_indexer;
     int comp_file_type; //type for the compensation file. type==0 means nom, forw, rev. 
@@ -214,6 +227,12 @@ static int loadAxis(int axis, EmcIniFile *axisIniFile)
         axisIniFile->Find(&ignore_limits, "HOME_IGNORE_LIMITS", axisString);
         sequence = -1;	                // default
         axisIniFile->Find(&sequence, "HOME_SEQUENCE", axisString);
+        home_group = 0;	                // default
+        axisIniFile->Find(&home_group, "HOME_GROUP", axisString);
+        search_jerk = 0;	        // default (accel limited stop)
+        axisIniFile->Find(&search_jerk, "HOME_SEARCH_JERK", axisString);
+        index_direct = false;	        // default
+        axisIniFile->Find(&index_direct, "HOME_INDEX_DIRECT", axisString);
         volatile_home = 0;	        // default
         axisIniFile->Find(&volatile_home, "VOLATILE_HOME", axisString);
         locking_indexer = false;
@@ -222,7 +241,8 @@ static int loadAxis(int axis, EmcIniFile *axisIniFile)
         // issue NML message to set all params
         if (0 != emcAxisSetHomingParams(axis, home, offset, home_final_vel, search_vel,
                                         latch_vel, (int)use_index, (int)ignore_limits,
-                                        (int)is_shared, sequence, volatile_home, locking_indexer)) {
+                                        (int)is_shared, sequence, volatile_home, locking_indexer,
+                                        home_group, search_jerk, (int)index_direct)) {
             if (emc_debug & EMC_DEBUG_CONFIG) {
                 rcs_print_error("bad return from emcAxisSetHomingParams\n");
             }
@@ -43,6 +43,9 @@ int ini_hal_init_pins(void);
 [AXIS_n]HOME_USE_INDEX
 [AXIS_n]HOME_IGNORE_LIMITS
 [AXIS_n]HOME_SEQUENCE
+[AXIS_n]HOME_GROUP
+[AXIS_n]HOME_SEARCH_JERK
+[AXIS_n]HOME_INDEX_DIRECT
 [AXIS_n]VOLATILE_HOME
 [AXIS_n]LOCKING_INDEXER
 [AXIS_n]COMP_FILE_TYPE
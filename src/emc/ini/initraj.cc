@@ -29,6 +29,23 @@
 
 extern value_inihal_data old_inihal_data;
 
+/* axis mask, bit 0 = X .. bit 8 = W, from a string of axis letters */
+static int axisMaskFromLetters(const char *coord)
+{
+    int axismask = 0;
+
+    if(strchr(coord, 'x') || strchr(coord, 'X')) axismask |= 1;
+    if(strchr(coord, 'y') || strchr(coord, 'Y')) axismask |= 2;
+    if(strchr(coord, 'z') || strchr(coord, 'Z')) axismask |= 4;
+    if(strchr(coord, 'a') || strchr(coord, 'A')) axismask |= 8;
+    if(strchr(coord, 'b') || strchr(coord, 'B')) axismask |= 16;
+    if(strchr(coord, 'c') || strchr(coord, 'C')) axismask |= 32;
+    if(strchr(coord, 'u') || strchr(coord, 'U')) axismask |= 64;
+    if(strchr(coord, 'v') || strchr(coord, 'V')) axismask |= 128;
+    if(strchr(coord, 'w') || strchr(coord, 'W')) axismask |= 256;
+    return axismask;
+}
+
 /*
   loadTraj()
 
@@ -43,6 +60,16 @@ extern value_inihal_data old_inihal_data;
   MAX_ACCELERATION <float>      max acceleration
   DEFAULT_ACCELERATION <float>  default acceleration
   HOME <float> ...              world coords of home, in X Y Z R P W
+  VOLUMETRIC_COMP_FILE <file>   grid of corrections for joints 0-2
+                                (at most motmod vol_comp_size points,
+                                1331 by default)
+  AUX_PLANNER_<n>_AXES <axes>   axes driven by auxiliary planner n, e.g. UV
+  JOINT_LIMIT_SAMPLES <int>     samples per segment for joint limits, 0 = off,
+                                at most 8; costs up to 2 * (2n + 1) inverse
+                                kinematics solves per queued move in the
+                                servo thread
+  PREPLAN_MAX_JERK <float>      jerk limit for corner and arc speed caps
+                                computed in canon, 0 = off
 
   calls:
 
@@ -54,6 +81,8 @@ extern value_inihal_data old_inihal_data;
   emcTrajSetMaxVelocity(double vel);
   emcTrajSetMaxAcceleration(double acc);
   emcTrajSetHome(EmcPose home);
+  emcTrajLoadVolComp(const char *file);
+  emcTrajSetAuxPlanner(int planner, int axis_mask);
   */
 
 static int loadTraj(EmcIniFile *trajInifile)
@@ -78,15 +107,7 @@ static int loadTraj(EmcIniFile *trajInifile)
 	int axismask = 0;
 	const char *coord = trajInifile->Find("COORDINATES", "TRAJ");
 	if(coord) {
-	    if(strchr(coord, 'x') || strchr(coord, 'X')) axismask |= 1;
-	    if(strchr(coord, 'y') || strchr(coord, 'Y')) axismask |= 2;
-	    if(strchr(coord, 'z') || strchr(coord, 'Z')) axismask |= 4;
-	    if(strchr(coord, 'a') || strchr(coord, 'A')) axismask |= 8;
-	    if(strchr(coord, 'b') || strchr(coord, 'B')) axismask |= 16;
-	    if(strchr(coord, 'c') || strchr(coord, 'C')) axismask |= 32;
-	    if(strchr(coord, 'u') || strchr(coord, 'U')) axismask |= 64;
-	    if(strchr(coord, 'v') || strchr(coord, 'V')) axismask |= 128;
-	    if(strchr(coord, 'w') || strchr(coord, 'W')) axismask |= 256;
+	    axismask = axisMaskFromLetters(coord);
 	} else {
 	    axismask = 1 | 2 | 4;		// default: XYZ machine
 	}
@@ -169,6 +190,8 @@ static int loadTraj(EmcIniFile *trajInifile)
         int arcBlendGapCycles = 4;
         double arcBlendRampFreq = 100.0;
         double arcBlendTangentKinkRatio = 0.1;
+        int segmentMergeEnable = 0;
+        int jointLimitSamples = 0;
 
         trajInifile->Find(&arcBlendEnable, "ARC_BLEND_ENABLE", "TRAJ");
         trajInifile->Find(&arcBlendFallbackEnable, "ARC_BLEND_FALLBACK_ENABLE", "TRAJ");
@@ -176,9 +199,15 @@ static int loadTraj(EmcIniFile *trajInifile)
         trajInifile->Find(&arcBlendGapCycles, "ARC_BLEND_GAP_CYCLES", "TRAJ");
         trajInifile->Find(&arcBlendRampFreq, "ARC_BLEND_RAMP_FREQ", "TRAJ");
         trajInifile->Find(&arcBlendTangentKinkRatio, "ARC_BLEND_KINK_RATIO", "TRAJ");
+        trajInifile->Find(&segmentMergeEnable, "SEGMENT_MERGE_ENABLE", "TRAJ");
+        trajInifile->Find(&jointLimitSamples, "JOINT_LIMIT_SAMPLES", "TRAJ");
+
+        // speed caps computed in canon, not sent to motion
+        trajInifile->Find(&traj_preplan_max_jerk, "PREPLAN_MAX_JERK", "TRAJ");
 
         if (0 != emcSetupArcBlends(arcBlendEnable, arcBlendFallbackEnable,
-                    arcBlendOptDepth, arcBlendGapCycles, arcBlendRampFreq, arcBlendTangentKinkRatio)) {
+                    arcBlendOptDepth, arcBlendGapCycles, arcBlendRampFreq, arcBlendTangentKinkRatio,
+                    segmentMergeEnable, jointLimitSamples)) {
             if (emc_debug & EMC_DEBUG_CONFIG) {
                 rcs_print("bad return value from emcSetupArcBlends\n");
             }
@@ -194,6 +223,23 @@ static int loadTraj(EmcIniFile *trajInifile)
             }
             return -1;
         } 
+
+        // auxiliary planners, as many as motion was loaded with
+        // (num_aux_planners=)
+        for (t = 1; t <= EMCMOT_MAX_AUX_PLANNERS; t++) {
+            char key[LINELEN];
+            snprintf(key, sizeof(key), "AUX_PLANNER_%d_AXES", t);
+            const char *auxAxes = trajInifile->Find(key, "TRAJ");
+            if (auxAxes == NULL) {
+                continue;
+            }
+            if (0 != emcTrajSetAuxPlanner(t, axisMaskFromLetters(auxAxes))) {
+                if (emc_debug & EMC_DEBUG_CONFIG) {
+                    rcs_print("bad return value from emcTrajSetAuxPlanner\n");
+                }
+                return -1;
+            }
+        }
     }
 
     catch(EmcIniFile::Exception &e){
@@ -277,6 +323,15 @@ static int loadTraj(EmcIniFile *trajInifile)
 	return -1;
     }
 
+    if (NULL != (inistring = trajInifile->Find("VOLUMETRIC_COMP_FILE", "TRAJ"))) {
+        if (0 != emcTrajLoadVolComp(inistring)) {
+            if (emc_debug & EMC_DEBUG_CONFIG) {
+                rcs_print_error("bad return from emcTrajLoadVolComp\n");
+            }
+            return -1;
+        }
+    }
+
     return 0;
 }
 
@@ -80,6 +80,71 @@ int kinematicsInverse(const EmcPose * pos,
     return 0;
 }
 
+static inline void copy_batch(double *dst, const double *src, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+	dst[i] = src[i];
+    }
+}
+
+/* the batch versions read the pivot length once; the rotary and UVW
+   joints are copied first so the loops below only read them */
+int kinematicsForwardBatch(int n,
+			   double * const *joints,
+			   const EmcPoseBatch * pos,
+			   const KINEMATICS_FORWARD_FLAGS * fflags,
+			   KINEMATICS_INVERSE_FLAGS * iflags)
+{
+    double pivot = *(haldata->pivot_length);
+    int i;
+
+    copy_batch(pos->a, joints[3], n);
+    copy_batch(pos->b, joints[4], n);
+    copy_batch(pos->c, joints[5], n);
+    copy_batch(pos->u, joints[6], n);
+    copy_batch(pos->v, joints[7], n);
+    copy_batch(pos->w, joints[8], n);
+
+    for (i = 0; i < n; i++) {
+	PmCartesian r = s2r(pivot + pos->w[i], pos->c[i], 180.0 - pos->b[i]);
+
+	pos->x[i] = joints[0][i] + r.x;
+	pos->y[i] = joints[1][i] + r.y;
+	pos->z[i] = joints[2][i] + pivot + r.z;
+    }
+
+    return n;
+}
+
+int kinematicsInverseBatch(int n,
+			   const EmcPoseBatch * pos,
+			   double * const *joints,
+			   const KINEMATICS_INVERSE_FLAGS * iflags,
+			   KINEMATICS_FORWARD_FLAGS * fflags)
+{
+    double pivot = *(haldata->pivot_length);
+    int i;
+
+    for (i = 0; i < n; i++) {
+	PmCartesian r = s2r(pivot + pos->w[i], pos->c[i], 180.0 - pos->b[i]);
+
+	joints[0][i] = pos->x[i] - r.x;
+	joints[1][i] = pos->y[i] - r.y;
+	joints[2][i] = pos->z[i] - pivot - r.z;
+    }
+
+    copy_batch(joints[3], pos->a, n);
+    copy_batch(joints[4], pos->b, n);
+    copy_batch(joints[5], pos->c, n);
+    copy_batch(joints[6], pos->u, n);
+    copy_batch(joints[7], pos->v, n);
+    copy_batch(joints[8], pos->w, n);
+
+    return n;
+}
+
 /* implemented for these kinematics as giving joints preference */
 int kinematicsHome(EmcPose * world,
 		   double *joint,
@@ -98,13 +163,15 @@ KINEMATICS_TYPE kinematicsType(void)
 }
 
 MODULE_LICENSE("GPL");
-#define VTVERSION VTKINEMATICS_VERSION1
+#define VTVERSION VTKINEMATICS_VERSION2
 
 static vtkins_t vtk = {
     .kinematicsForward = kinematicsForward,
     .kinematicsInverse  = kinematicsInverse,
     // .kinematicsHome = kinematicsHome,
-    .kinematicsType = kinematicsType
+    .kinematicsType = kinematicsType,
+    .kinematicsForwardBatch = kinematicsForwardBatch,
+    .kinematicsInverseBatch = kinematicsInverseBatch,
 };
 
 static int comp_id, vtable_id;
@@ -15,7 +15,7 @@
 #include "rtapi.h"
 #include "rtapi_math.h"
 
-#define VTVERSION VTKINEMATICS_VERSION1
+#define VTVERSION VTKINEMATICS_VERSION2
 
 struct haldata {
     hal_float_t *Y_offset;
@@ -77,6 +77,63 @@ static int kinematicsInverse(const EmcPose * pos,
     return 0;
 }
 
+/* the batch versions read the offsets once and take each point's sines
+   and cosines in the same loop as the transform */
+static int kinematicsForwardBatch(int n,
+				  double * const *joints,
+				  const EmcPoseBatch * pos,
+				  const KINEMATICS_FORWARD_FLAGS * fflags,
+				  KINEMATICS_INVERSE_FLAGS * iflags)
+{
+    double dy = *(haldata->Y_offset);
+    double dz = *(haldata->Z_offset) + *(haldata->Tool_offset);
+    int i;
+
+    for (i = 0; i < n; i++) {
+	double a_rad = joints[3][i] * M_PI/180;
+	double c_rad = joints[5][i] * M_PI/180;
+	double sa = rtapi_sin(a_rad), ca = rtapi_cos(a_rad);
+	double sc = rtapi_sin(c_rad), cc = rtapi_cos(c_rad);
+	double jy = joints[1][i] - dy;
+	double jz = joints[2][i] - dz;
+
+	pos->x[i] = cc * joints[0][i] + sc * ca * jy + sc * sa * jz + sc * dy;
+	pos->y[i] = -sc * joints[0][i] + cc * ca * jy + cc * sa * jz + cc * dy;
+	pos->z[i] = -sa * jy + ca * jz + dz;
+	pos->a[i] = joints[3][i];
+	pos->b[i] = joints[4][i];
+	pos->c[i] = joints[5][i];
+    }
+    return n;
+}
+
+static int kinematicsInverseBatch(int n,
+				  const EmcPoseBatch * pos,
+				  double * const *joints,
+				  const KINEMATICS_INVERSE_FLAGS * iflags,
+				  KINEMATICS_FORWARD_FLAGS * fflags)
+{
+    double dy = *(haldata->Y_offset);
+    double dz = *(haldata->Z_offset) + *(haldata->Tool_offset);
+    int i;
+
+    for (i = 0; i < n; i++) {
+	double a_rad = pos->a[i] * M_PI/180;
+	double c_rad = pos->c[i] * M_PI/180;
+	double sa = rtapi_sin(a_rad), ca = rtapi_cos(a_rad);
+	double sc = rtapi_sin(c_rad), cc = rtapi_cos(c_rad);
+	double x = pos->x[i], y = pos->y[i], z = pos->z[i];
+
+	joints[0][i] = cc * x - sc * y;
+	joints[1][i] = sc * ca * x + cc * ca * y - sa * z - ca * dy + sa * dz + dy;
+	joints[2][i] = sc * sa * x + cc * sa * y + ca * z - sa * dy - ca * dz + dz;
+	joints[3][i] = pos->a[i];
+	joints[4][i] = pos->b[i];
+	joints[5][i] = pos->c[i];
+    }
+    return n;
+}
+
 static KINEMATICS_TYPE kinematicsType()
 {
     return KINEMATICS_BOTH;
@@ -92,7 +149,9 @@ static vtkins_t vtk = {
     .kinematicsForward = kinematicsForward,
     .kinematicsInverse  = kinematicsInverse,
     // .kinematicsHome = kinematicsHome,
-    .kinematicsType = kinematicsType
+    .kinematicsType = kinematicsType,
+    .kinematicsForwardBatch = kinematicsForwardBatch,
+    .kinematicsInverseBatch = kinematicsInverseBatch,
 };
 
 static int comp_id, vtable_id;
@@ -57,6 +57,41 @@ static CUBIC_COEFF cubicCoeff(double x0, double v0,
     return retval;
 }
 
+/*
+   quinticCoeff calculates the coefficients of the quintic polynomial
+   fit to the values of x, v and a at 0 and t.
+   deltaT is the length of the interval.
+
+   Derivation:
+   With f = x0, e = v0 and d = a0 / 2, solve
+
+	 a t^5 +  b t^4 +  c t^3 + ... = xn,
+	5a t^4 + 4b t^3 + 3c t^2 + ... = vn,
+       20a t^3 + 12b t^2 + 6c t  + ... = an
+
+   for a, b and c.
+*/
+static QUINTIC_COEFF quinticCoeff(double x0, double v0, double a0,
+				  double xn, double vn, double an,
+				  double deltaT)
+{
+    QUINTIC_COEFF retval;
+    double t2 = deltaT * deltaT;
+    double t3 = t2 * deltaT;
+
+    retval.f = x0;
+    retval.e = v0;
+    retval.d = 0.5 * a0;
+    retval.c = (20.0 * (xn - x0) - (8.0 * vn + 12.0 * v0) * deltaT -
+	(3.0 * a0 - an) * t2) / (2.0 * t3);
+    retval.b = (30.0 * (x0 - xn) + (14.0 * vn + 16.0 * v0) * deltaT +
+	(3.0 * a0 - 2.0 * an) * t2) / (2.0 * t3 * deltaT);
+    retval.a = (12.0 * (xn - x0) - 6.0 * (vn + v0) * deltaT -
+	(a0 - an) * t2) / (2.0 * t3 * t2);
+
+    return retval;
+}
+
 /*
    Interpolate points along a cubic, given t and cubic params
 */
@@ -93,6 +128,30 @@ static double interpolateJerk(CUBIC_COEFF coeff, double t)
     return 6.0 * coeff.a;
 }
 
+/*
+   Interpolate position, velocity, acceleration and jerk along a quintic
+*/
+static double interpolateQuintic(QUINTIC_COEFF q, double t)
+{
+    return ((((q.a * t + q.b) * t + q.c) * t + q.d) * t + q.e) * t + q.f;
+}
+
+static double interpolateQuinticVel(QUINTIC_COEFF q, double t)
+{
+    return (((5.0 * q.a * t + 4.0 * q.b) * t + 3.0 * q.c) * t +
+	2.0 * q.d) * t + q.e;
+}
+
+static double interpolateQuinticAccel(QUINTIC_COEFF q, double t)
+{
+    return ((20.0 * q.a * t + 12.0 * q.b) * t + 6.0 * q.c) * t + 2.0 * q.d;
+}
+
+static double interpolateQuinticJerk(QUINTIC_COEFF q, double t)
+{
+    return (60.0 * q.a * t + 24.0 * q.b) * t + 6.0 * q.c;
+}
+
 /*
    Calculate the cubic spline way point, given a point and its
    previous and successive neighbors
@@ -115,6 +174,20 @@ static double velPoint(double xMinus1, double xPlus1, double deltaT)
     }
 }
 
+/*
+   Calculate the acceleration at a point by central differencing, given
+   the point and its previous and successive neighbors
+*/
+static double accelPoint(double xMinus1, double x, double xPlus1,
+			 double deltaT)
+{
+    if (deltaT <= 0.0) {
+	return 0.0;
+    } else {
+	return (xMinus1 - 2.0 * x + xPlus1) / (deltaT * deltaT);
+    }
+}
+
 int cubicInit(CUBIC_STRUCT * ci)
 {
     if (0 == ci) {
@@ -122,6 +195,7 @@ int cubicInit(CUBIC_STRUCT * ci)
     }
 
     ci->configured = 0;
+    ci->order = 3;
     ci->segmentTime = 0.0;
     ci->interpolationRate = 0;
     ci->interpolationIncrement = 0.0;
@@ -171,6 +245,24 @@ int cubicSetInterpolationRate(CUBIC_STRUCT * ci, int rate)
     return 0;
 }
 
+/*
+  cubicSetOrder(CUBIC_STRUCT * ci, int order)
+  Select the interpolating polynomial. Order 3 (the default) fits the
+  cubic spline through the way points, which smooths the input points.
+  Order 5 fits a quintic that passes through the input points themselves,
+  with velocity and acceleration taken from central differences, so that
+  position, velocity and acceleration are continuous between segments.
+  Both use the same four-point queue, so the delay is the same.
+*/
+int cubicSetOrder(CUBIC_STRUCT * ci, int order)
+{
+    if (0 == ci || (order != 3 && order != 5)) {
+	return -1;
+    }
+    ci->order = order;
+    return 0;
+}
+
 int cubicGetInterpolationRate(CUBIC_STRUCT * ci)
 {
     if (0 == ci || !(ci->configured & INTERPOLATION_RATE_SET)) {
@@ -249,6 +341,13 @@ int cubicAddPoint(CUBIC_STRUCT * ci, double point)
     ci->velp1 = velPoint(ci->x1, ci->x3, ci->segmentTime);
     ci->coeff = cubicCoeff(ci->wp0, ci->velp0, ci->wp1,
 			   ci->velp1, ci->segmentTime);
+    if (ci->order == 5) {
+	ci->qcoeff = quinticCoeff(ci->x1, ci->velp0,
+				  accelPoint(ci->x0, ci->x1, ci->x2, ci->segmentTime),
+				  ci->x2, ci->velp1,
+				  accelPoint(ci->x1, ci->x2, ci->x3, ci->segmentTime),
+				  ci->segmentTime);
+    }
     ci->interpolationTime = 0.0;
     ci->needNextPoint = 0;
 
@@ -282,6 +381,7 @@ int cubicOffset(CUBIC_STRUCT * ci, double offset)
 
     /* only the D coeff is affected, so we can change this directly */
     ci->coeff.d += offset;
+    ci->qcoeff.f += offset;
 
     return 0;
 }
@@ -309,20 +409,38 @@ double cubicInterpolate(CUBIC_STRUCT * ci,
 	cubicAddPoint(ci, ci->x3);
     }
 
-    retval = interpolateCubic(ci->coeff, ci->interpolationTime);
+    if (ci->order == 5) {
+	retval = interpolateQuintic(ci->qcoeff, ci->interpolationTime);
 
-    /* do optional ones */
-    if (x != 0) {
-	*x = retval;
-    }
-    if (v != 0) {
-	*v = interpolateVel(ci->coeff, ci->interpolationTime);
-    }
-    if (a != 0) {
-	*a = interpolateAccel(ci->coeff, ci->interpolationTime);
-    }
-    if (j != 0) {
-	*j = interpolateJerk(ci->coeff, ci->interpolationTime);
+	/* do optional ones */
+	if (x != 0) {
+	    *x = retval;
+	}
+	if (v != 0) {
+	    *v = interpolateQuinticVel(ci->qcoeff, ci->interpolationTime);
+	}
+	if (a != 0) {
+	    *a = interpolateQuinticAccel(ci->qcoeff, ci->interpolationTime);
+	}
+	if (j != 0) {
+	    *j = interpolateQuinticJerk(ci->qcoeff, ci->interpolationTime);
+	}
+    } else {
+	retval = interpolateCubic(ci->coeff, ci->interpolationTime);
+
+	/* do optional ones */
+	if (x != 0) {
+	    *x = retval;
+	}
+	if (v != 0) {
+	    *v = interpolateVel(ci->coeff, ci->interpolationTime);
+	}
+	if (a != 0) {
+	    *a = interpolateAccel(ci->coeff, ci->interpolationTime);
+	}
+	if (j != 0) {
+	    *j = interpolateJerk(ci->coeff, ci->interpolationTime);
+	}
     }
 
     ci->interpolationTime += ci->interpolationIncrement;
@@ -353,6 +471,8 @@ int cubicDrain(CUBIC_STRUCT * ci)
     ci->coeff.b = 0.0;
     ci->coeff.c = 0.0;
     ci->coeff.d = 0.0;
+    ci->qcoeff.a = ci->qcoeff.b = ci->qcoeff.c = 0.0;
+    ci->qcoeff.d = ci->qcoeff.e = ci->qcoeff.f = 0.0;
 
     return 0;
 }
@@ -362,19 +482,20 @@ int cubicDrain(CUBIC_STRUCT * ci)
 #include <stdio.h>
 
 /*
-  syntax: testcubic <segment time> <interpolation rate>
+  syntax: testcubic <segment time> <interpolation rate> [order]
 */
 int main(int argc, char *argv[])
 {
     CUBIC_STRUCT cubic;
     double segmentTime;
     int interpolationRate;
+    int order = 3;
     double xin;
     double xout;
     double time = 0.0;
 
-    if (argc != 3) {
-	fprintf(stderr, "syntax: %s <segment time> <interpolation rate>\n",
+    if (argc != 3 && argc != 4) {
+	fprintf(stderr, "syntax: %s <segment time> <interpolation rate> [order]\n",
 		argv[0]);
 	return 1;
     }
@@ -405,6 +526,12 @@ int main(int argc, char *argv[])
 	return 1;
     }
 
+    if (argc == 4 && (1 != sscanf(argv[3], "%d", &order) ||
+	0 != cubicSetOrder(&cubic, order))) {
+	fprintf(stderr, "invalid order %s\n", argv[3]);
+	return 1;
+    }
+
     while (!feof(stdin)) {
 	if (cubicNeedNextPoint(&cubic)) {
 	    if (1 != scanf("%lf", &xin)) {
@@ -28,8 +28,24 @@ typedef struct {
     double d;
 } CUBIC_COEFF;
 
+/*
+   Coefficients of a quintic polynomial,
+
+   a * x^5 + b * x^4 + c * x^3 + d * x^2 + e * x + f
+*/
+
+typedef struct {
+    double a;
+    double b;
+    double c;
+    double d;
+    double e;
+    double f;
+} QUINTIC_COEFF;
+
 typedef struct {
     int configured;
+    int order;			/* 3 (cubic spline) or 5 (quintic) */
     double segmentTime;
     int interpolationRate;
     double interpolationTime;
@@ -40,6 +56,7 @@ typedef struct {
     int filled;
     int needNextPoint;
     CUBIC_COEFF coeff;
+    QUINTIC_COEFF qcoeff;
 } CUBIC_STRUCT;
 
 extern int cubicInit(CUBIC_STRUCT * ci);
@@ -47,6 +64,7 @@ extern int cubicSetSegmentTime(CUBIC_STRUCT * ci, double time);
 extern double cubicGetSegmentTime(CUBIC_STRUCT * ci);
 extern int cubicSetInterpolationRate(CUBIC_STRUCT * ci, int rate);
 extern int cubicGetInterpolationRate(CUBIC_STRUCT * ci);
+extern int cubicSetOrder(CUBIC_STRUCT * ci, int order);
 extern int cubicAddPoint(CUBIC_STRUCT * ci, double point);
 extern int cubicOffset(CUBIC_STRUCT * ci, double offset);
 extern double cubicGetInterpolationIncrement(CUBIC_STRUCT * ci);
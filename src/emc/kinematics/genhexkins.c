@@ -54,7 +54,36 @@
 #include "genhexkins.h"
 #include "kinematics.h"             /* these decls, KINEMATICS_FORWARD_FLAGS */
 
-#define VTVERSION VTKINEMATICS_VERSION1
+#define VTVERSION VTKINEMATICS_VERSION2
+
+#define HIGH_CONV_CRITERION   (1e-12)
+#define MEDIUM_CONV_CRITERION (1e-5)
+#define LOW_CONV_CRITERION    (1e-3)
+#define MEDIUM_CONV_ITERATIONS  50
+#define LOW_CONV_ITERATIONS    100
+#define FAIL_CONV_ITERATIONS   150
+#define LARGE_CONV_ERROR 10000
+
+/* The forward kinematics run every servo cycle, seeded with the previous
+   cycle's pose, so they normally converge in a few iterations. The
+   iteration limit and the convergence criterion on the strut lengths are
+   HAL parameters, so the worst case time can be bounded to fit a fast
+   servo thread; the pin reports the iterations the last solution took. */
+#ifdef RTAPI
+#include "hal.h"
+
+struct haldata {
+  hal_s32_t max_iterations;
+  hal_float_t conv_criterion;
+  hal_s32_t *last_iterations;
+} *haldata = 0;
+
+#define MAX_ITERATIONS (haldata ? haldata->max_iterations : FAIL_CONV_ITERATIONS)
+#define CONV_CRITERION (haldata ? haldata->conv_criterion : HIGH_CONV_CRITERION)
+#else
+#define MAX_ITERATIONS FAIL_CONV_ITERATIONS
+#define CONV_CRITERION HIGH_CONV_CRITERION
+#endif
 
 /******************************* MatInvert() ***************************/
 
@@ -157,6 +186,61 @@ static void MatMult(double J[][6], const double x[], double Ans[])
   }
 }
 
+/******************************** MatSolve() ********************************/
+
+/*---------------------------------------------------------------------------
+  This function solves J x = y for a 6x6 matrix by Gaussian elimination
+  with partial pivoting, which takes about a third of the work of
+  inverting J and multiplying. J is destroyed, x holds y on entry.
+  Returns -1 if J is singular.
+  ---------------------------------------------------------------------------*/
+
+static int MatSolve(double J[][NUM_STRUTS], double x[])
+{
+  double m, temp;
+  int j, k, n, p;
+
+  for (k = 0; k < NUM_STRUTS; ++k) {
+    /* bring the largest remaining entry of column k to the pivot */
+    p = k;
+    for (j = k + 1; j < NUM_STRUTS; ++j) {
+      if (rtapi_fabs(J[j][k]) > rtapi_fabs(J[p][k])) {
+        p = j;
+      }
+    }
+    if (rtapi_fabs(J[p][k]) < 1e-12) {
+      return -1;
+    }
+    if (p != k) {
+      for (n = k; n < NUM_STRUTS; ++n) {
+        temp = J[k][n];
+        J[k][n] = J[p][n];
+        J[p][n] = temp;
+      }
+      temp = x[k];
+      x[k] = x[p];
+      x[p] = temp;
+    }
+    for (j = k + 1; j < NUM_STRUTS; ++j) {
+      m = J[j][k] / J[k][k];
+      for (n = k + 1; n < NUM_STRUTS; ++n) {
+        J[j][n] -= m * J[k][n];
+      }
+      x[j] -= m * x[k];
+    }
+  }
+
+  /* back substitution */
+  for (k = NUM_STRUTS - 1; k >= 0; --k) {
+    for (n = k + 1; n < NUM_STRUTS; ++n) {
+      x[k] -= J[k][n] * x[n];
+    }
+    x[k] /= J[k][k];
+  }
+
+  return 0;
+}
+
 /* define position of base strut ends in base (world) coordinate system */
 static PmCartesian b[6] = {{BASE_0_X, BASE_0_Y, BASE_0_Z},
 			   {BASE_1_X, BASE_1_Y, BASE_1_Z},
@@ -331,36 +415,28 @@ int jacobianForward(const double * joints,
    passed in. */
 
 static int iteration = 0;	/* global so we can report it */
-int kinematicsForward(const double * joints,
-                      EmcPose * pos,
-                      const KINEMATICS_FORWARD_FLAGS * fflags,
-                      KINEMATICS_INVERSE_FLAGS * iflags)
+static int genhexForward(const double * joints,
+                         EmcPose * pos)
 {
   PmCartesian aw;
   PmCartesian InvKinStrutVect,InvKinStrutVectUnit;
   PmCartesian q_trans, RMatrix_a, RMatrix_a_cross_Strut;
 
-  double Jacobian[NUM_STRUTS][NUM_STRUTS];
   double InverseJacobian[NUM_STRUTS][NUM_STRUTS];
   double InvKinStrutLength, StrutLengthDiff[NUM_STRUTS];
   double delta[NUM_STRUTS];
   double conv_err = 1.0;
 
-  PmRotationMatrix RMatrix;
+  PmRotationMatrix RMatrix, DeltaMatrix, NewMatrix;
+  PmRotationVector DeltaRot;
   PmRpy q_RPY;
 
   int iterate = 1;
   int i;
   int retval = 0;
 
-#define HIGH_CONV_CRITERION   (1e-12)
-#define MEDIUM_CONV_CRITERION (1e-5)
-#define LOW_CONV_CRITERION    (1e-3)
-#define MEDIUM_CONV_ITERATIONS  50
-#define LOW_CONV_ITERATIONS    100
-#define FAIL_CONV_ITERATIONS   150
-#define LARGE_CONV_ERROR 10000
-  double conv_criterion = HIGH_CONV_CRITERION;
+  double conv_criterion = CONV_CRITERION;
+  int max_iterations = MAX_ITERATIONS;
 
   iteration = 0;
 
@@ -380,6 +456,7 @@ int kinematicsForward(const double * joints,
   q_RPY.r = pos->a * PM_PI / 180.0;
   q_RPY.p = pos->b * PM_PI / 180.0;
   q_RPY.y = pos->c * PM_PI / 180.0;
+  pmRpyMatConvert(&q_RPY, &RMatrix);
 
   /* Assign translation values in pos to q_trans */
   q_trans.x = pos->tran.x;
@@ -415,14 +492,11 @@ int kinematicsForward(const double * joints,
 
     /* check iteration to see if the kinematics can reach the
        convergence criterion and return error flag if it can't */
-    if (iteration > FAIL_CONV_ITERATIONS) {
+    if (iteration > max_iterations) {
       /* we can't converge */
       return -5;
     }
 
-    /* Convert q_RPY to Rotation Matrix */
-    pmRpyMatConvert(&q_RPY, &RMatrix);
-
     /* compute StrutLengthDiff[] by running inverse kins on Cartesian
      estimate to get joint estimate, subtract joints to get joint deltas,
      and compute inv J while we're at it */
@@ -448,19 +522,32 @@ int kinematicsForward(const double * joints,
       InverseJacobian[i][5] = RMatrix_a_cross_Strut.z;
     }
 
-    /* invert Inverse Jacobian */
-    MatInvert(InverseJacobian, Jacobian);
-
-    /* multiply Jacobian by LegLengthDiff */
-    MatMult(Jacobian, StrutLengthDiff, delta);
+    /* solve Inverse Jacobian * delta = LegLengthDiff */
+    for (i = 0; i < NUM_STRUTS; i++) {
+      delta[i] = StrutLengthDiff[i];
+    }
+    if (0 != MatSolve(InverseJacobian, delta)) {
+      return -1;
+    }
 
     /* subtract delta from last iterations pos values */
     q_trans.x -= delta[0];
     q_trans.y -= delta[1];
     q_trans.z -= delta[2];
-    q_RPY.r   -= delta[3];
-    q_RPY.p   -= delta[4];
-    q_RPY.y   -= delta[5];
+
+    /* the last three columns of the Inverse Jacobian are with respect to
+       a small rotation about the world axes, not to roll, pitch and yaw,
+       so rotate the platform by -delta[3..5] rather than subtracting them
+       from the angles; this keeps the convergence quadratic */
+    DeltaRot.s = pmSqrt(pmSq(delta[3]) + pmSq(delta[4]) + pmSq(delta[5]));
+    if (DeltaRot.s > 0.0) {
+      DeltaRot.x = -delta[3] / DeltaRot.s;
+      DeltaRot.y = -delta[4] / DeltaRot.s;
+      DeltaRot.z = -delta[5] / DeltaRot.s;
+      pmRotMatConvert(&DeltaRot, &DeltaMatrix);
+      pmMatMatMult(&DeltaMatrix, &RMatrix, &NewMatrix);
+      RMatrix = NewMatrix;
+    }
 
     /* determine value of conv_error (used to determine if no convergence) */
     conv_err = 0.0;
@@ -478,6 +565,7 @@ int kinematicsForward(const double * joints,
   } /* exit Newton-Raphson Iterative loop */
 
   /* assign r,p,w to a,b,c */
+  pmMatRpyConvert(&RMatrix, &q_RPY);
   pos->a = q_RPY.r * 180.0 / PM_PI;  
   pos->b = q_RPY.p * 180.0 / PM_PI;  
   pos->c = q_RPY.y * 180.0 / PM_PI;
@@ -490,6 +578,21 @@ int kinematicsForward(const double * joints,
   return retval;
 }
 
+int kinematicsForward(const double * joints,
+                      EmcPose * pos,
+                      const KINEMATICS_FORWARD_FLAGS * fflags,
+                      KINEMATICS_INVERSE_FLAGS * iflags)
+{
+  int retval = genhexForward(joints, pos);
+
+#ifdef RTAPI
+  if (haldata) {
+    *(haldata->last_iterations) = iteration;
+  }
+#endif
+  return retval;
+}
+
 int genhexKinematicsForwardIterations(void)
 {
   return iteration;
@@ -890,7 +993,6 @@ int main(int argc, char *argv[])
 #ifdef RTAPI
 #include "rtapi.h"		/* RTAPI realtime OS API */
 #include "rtapi_app.h"		/* RTAPI realtime module decls */
-#include "hal.h"
 
 MODULE_LICENSE("GPL");
 
@@ -905,8 +1007,28 @@ static int comp_id, vtable_id;
 static const char *name = "genhexkins";
 
 int rtapi_app_main(void) {
+    int res;
+
     comp_id = hal_init(name);
     if(comp_id > 0) {
+	haldata = hal_malloc(sizeof(*haldata));
+	if (!haldata) {
+	    hal_exit(comp_id);
+	    return -ENOMEM;
+	}
+	if ((res = hal_param_s32_new("genhexkins.max-iterations", HAL_RW,
+				     &haldata->max_iterations, comp_id)) < 0 ||
+	    (res = hal_param_float_new("genhexkins.convergence-criterion", HAL_RW,
+				       &haldata->conv_criterion, comp_id)) < 0 ||
+	    (res = hal_pin_s32_new("genhexkins.last-iterations", HAL_OUT,
+				   &haldata->last_iterations, comp_id)) < 0) {
+	    hal_exit(comp_id);
+	    return res;
+	}
+	haldata->max_iterations = FAIL_CONV_ITERATIONS;
+	haldata->conv_criterion = HIGH_CONV_CRITERION;
+	*(haldata->last_iterations) = 0;
+
 	vtable_id = hal_export_vtable(name, VTVERSION, &vtk, comp_id);
 	if (vtable_id < 0) {
 	    rtapi_print_msg(RTAPI_MSG_ERR,
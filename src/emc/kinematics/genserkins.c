@@ -27,11 +27,11 @@
   TODO:
     * make number of joints a loadtime parameter
     * add HAL pins for all settable parameters, including joint type: ANGULAR / LINEAR
-    * add HAL pins for debug data (num_iterations)
     * add HAL pins for ULAPI compiled version
 */
 
 #include "rtapi_math.h"
+#include "sincos.h"
 #include "gotypes.h"		/* go_result, go_integer */
 #include "gomath.h"		/* go_pose */
 #include "genserkins.h"		/* these decls */
@@ -47,6 +47,8 @@ struct haldata {
     hal_float_t *a[GENSER_MAX_JOINTS];
     hal_float_t *alpha[GENSER_MAX_JOINTS];
     hal_float_t *d[GENSER_MAX_JOINTS];
+    hal_u32_t *hist[GENSER_HIST_BINS];	// inverse kins iteration counts
+    hal_bit_t *hist_reset;
     genser_struct *kins;
     go_pose *pos;		// used in various functions, we malloc it
 				// only once in rtapi_app_main
@@ -65,6 +67,10 @@ double j[GENSER_MAX_JOINTS];
 #endif
 
 enum { GENSER_DEFAULT_MAX_ITERATIONS = 100 };
+#define GENSER_DEFAULT_DAMPING 1.0e-4
+/* largest pose error of an inverse solution, length units and radians */
+#define GENSER_TRAN_TOLERANCE 1.0e-6
+#define GENSER_ROT_TOLERANCE 1.0e-6
 
 int genser_kin_init(void) {
     genser_struct *genser = KINS_PTR;
@@ -88,6 +94,28 @@ int genser_kin_init(void) {
     return GO_RESULT_OK;
 }
 
+/* Reload the link parameters if a DH pin changed since they were last
+   loaded. The warm start histories belong to the old geometry, so they
+   are dropped. */
+static void genser_kin_refresh(genser_struct * genser)
+{
+    int t;
+
+    for (t = 0; t < GENSER_MAX_JOINTS; t++) {
+	if (genser->links[t].u.dh.a != A(t) ||
+	    genser->links[t].u.dh.alpha != ALPHA(t) ||
+	    genser->links[t].u.dh.d != D(t))
+	    break;
+    }
+    if (t == GENSER_MAX_JOINTS)
+	return;
+
+    genser_kin_init();
+    for (t = 0; t < GENSER_HISTORIES; t++) {
+	genser->history[t].have_last = 0;
+    }
+}
+
 /* compute the forward jacobian function: 
    the jacobian is a linear aproximation of the kinematics function.
    It is calculated using derivation of the position transformation matrix, 
@@ -369,7 +397,7 @@ int genser_kin_fwd(void *kins, const go_real * joints, go_pose * pos)
     int link;
     int retval;
 
-    genser_kin_init();
+    genser_kin_refresh(genser);
 
     for (link = 0; link < genser->link_num; link++) {
 	retval = go_link_joint_set(&genser->links[link], joints[link], &linkout[link]);
@@ -384,33 +412,249 @@ int genser_kin_fwd(void *kins, const go_real * joints, go_pose * pos)
     return GO_RESULT_OK;
 }
 
+/* Closed form (geometric) Jacobian.  Walks the chain once for the joint
+   values in joints[], and since each link's joint axis is the z axis of
+   its frame, column i is (z_i x (p_end - p_i), z_i) for a revolute joint
+   and (z_i, 0) for a prismatic one, in the base frame. Also returns the
+   end pose, so the solver needs no separate forward kinematics. */
+static int compute_jfwd_closed(genser_struct * genser, const go_real * joints,
+			       go_real J[6][GENSER_MAX_JOINTS], go_pose * pend)
+{
+    go_real z[GENSER_MAX_JOINTS][3], o[GENSER_MAX_JOINTS][3];
+    go_real R[3][3], p[3], M[3][3], t[3], Rn[3][3], d[3];
+    go_real sth, cth, sal, cal, theta, dd;
+    go_link linkout;
+    go_hom h;
+    go_mat m;
+    int i, r, c;
+
+    for (r = 0; r < 3; r++) {
+	for (c = 0; c < 3; c++) {
+	    R[r][c] = (r == c);
+	}
+	p[r] = 0;
+    }
+
+    for (i = 0; i < genser->link_num; i++) {
+	if (GO_LINK_DH == genser->links[i].type) {
+	    /* same as go_dh_pose_convert(), without the quaternions */
+	    if (GO_QUANTITY_LENGTH == genser->links[i].quantity) {
+		theta = genser->links[i].u.dh.theta;
+		dd = joints[i];
+	    } else {
+		theta = joints[i];
+		dd = genser->links[i].u.dh.d;
+	    }
+	    sincos(theta, &sth, &cth);
+	    sincos(genser->links[i].u.dh.alpha, &sal, &cal);
+	    M[0][0] = cth, M[0][1] = -sth, M[0][2] = 0.0;
+	    M[1][0] = sth * cal, M[1][1] = cth * cal, M[1][2] = -sal;
+	    M[2][0] = sth * sal, M[2][1] = cth * sal, M[2][2] = cal;
+	    t[0] = genser->links[i].u.dh.a;
+	    t[1] = -sal * dd;
+	    t[2] = cal * dd;
+	} else if (GO_LINK_PP == genser->links[i].type) {
+	    go_link_joint_set(&genser->links[i], joints[i], &linkout);
+	    go_pose_hom_convert(&linkout.u.pp.pose, &h);
+	    M[0][0] = h.rot.x.x, M[0][1] = h.rot.y.x, M[0][2] = h.rot.z.x;
+	    M[1][0] = h.rot.x.y, M[1][1] = h.rot.y.y, M[1][2] = h.rot.z.y;
+	    M[2][0] = h.rot.x.z, M[2][1] = h.rot.y.z, M[2][2] = h.rot.z.z;
+	    t[0] = h.tran.x, t[1] = h.tran.y, t[2] = h.tran.z;
+	} else {
+	    return GO_RESULT_IMPL_ERROR;
+	}
+	/* T_0_i = T_0_im1 * T_im1_i */
+	for (r = 0; r < 3; r++) {
+	    p[r] += R[r][0] * t[0] + R[r][1] * t[1] + R[r][2] * t[2];
+	    for (c = 0; c < 3; c++) {
+		Rn[r][c] = R[r][0] * M[0][c] + R[r][1] * M[1][c] + R[r][2] * M[2][c];
+	    }
+	}
+	for (r = 0; r < 3; r++) {
+	    for (c = 0; c < 3; c++) {
+		R[r][c] = Rn[r][c];
+	    }
+	    z[i][r] = R[r][2];
+	    o[i][r] = p[r];
+	}
+    }
+
+    for (i = 0; i < genser->link_num; i++) {
+	if (GO_QUANTITY_LENGTH == genser->links[i].quantity) {
+	    J[0][i] = z[i][0], J[1][i] = z[i][1], J[2][i] = z[i][2];
+	    J[3][i] = 0.0, J[4][i] = 0.0, J[5][i] = 0.0;
+	} else {
+	    d[0] = p[0] - o[i][0];
+	    d[1] = p[1] - o[i][1];
+	    d[2] = p[2] - o[i][2];
+	    J[0][i] = z[i][1] * d[2] - z[i][2] * d[1];
+	    J[1][i] = z[i][2] * d[0] - z[i][0] * d[2];
+	    J[2][i] = z[i][0] * d[1] - z[i][1] * d[0];
+	    J[3][i] = z[i][0], J[4][i] = z[i][1], J[5][i] = z[i][2];
+	}
+    }
+
+    m.x.x = R[0][0], m.y.x = R[0][1], m.z.x = R[0][2];
+    m.x.y = R[1][0], m.y.y = R[1][1], m.z.y = R[1][2];
+    m.x.z = R[2][0], m.y.z = R[2][1], m.z.z = R[2][2];
+    pend->tran.x = p[0];
+    pend->tran.y = p[1];
+    pend->tran.z = p[2];
+    return go_mat_quat_convert(&m, &pend->rot);
+}
+
+/* Solve A x = b in place for a symmetric positive definite A (n x n),
+   by Cholesky decomposition. */
+static int solve_spd(go_real A[GENSER_MAX_JOINTS][GENSER_MAX_JOINTS],
+		     go_real * b, int n)
+{
+    int i, j, k;
+    go_real sum;
+
+    for (j = 0; j < n; j++) {
+	sum = A[j][j];
+	for (k = 0; k < j; k++) {
+	    sum -= A[j][k] * A[j][k];
+	}
+	if (sum <= 0.0) {
+	    return GO_RESULT_SINGULAR;
+	}
+	A[j][j] = rtapi_sqrt(sum);
+	for (i = j + 1; i < n; i++) {
+	    sum = A[i][j];
+	    for (k = 0; k < j; k++) {
+		sum -= A[i][k] * A[j][k];
+	    }
+	    A[i][j] = sum / A[j][j];
+	}
+    }
+    /* forward substitution with L, then back substitution with LT */
+    for (i = 0; i < n; i++) {
+	sum = b[i];
+	for (k = 0; k < i; k++) {
+	    sum -= A[i][k] * b[k];
+	}
+	b[i] = sum / A[i][i];
+    }
+    for (i = n - 1; i >= 0; i--) {
+	sum = b[i];
+	for (k = i + 1; k < n; k++) {
+	    sum -= A[k][i] * b[k];
+	}
+	b[i] = sum / A[i][i];
+    }
+    return GO_RESULT_OK;
+}
+
+/* Pose error from pend to pos in the base frame, translation atop the
+   rotation vector, like a velocity screw. */
+static void pose_error(const go_pose * pos, const go_pose * pend, go_real * e)
+{
+    go_quat qinv, qerr;
+    go_rvec rvec;
+
+    e[0] = pos->tran.x - pend->tran.x;
+    e[1] = pos->tran.y - pend->tran.y;
+    e[2] = pos->tran.z - pend->tran.z;
+    go_quat_inv(&pend->rot, &qinv);
+    go_quat_quat_mult(&pos->rot, &qinv, &qerr);
+    go_quat_rvec_convert(&qerr, &rvec);
+    e[3] = rvec.x;
+    e[4] = rvec.y;
+    e[5] = rvec.z;
+}
+
+/* Returns the warm start history whose last solution jest[] is, or -1 if
+   the estimate does not continue any of them. */
+static int find_history(genser_struct * genser, const go_real * jest)
+{
+    genser_history *h;
+    int n, link;
+
+    for (n = 0; n < GENSER_HISTORIES; n++) {
+	h = &genser->history[n];
+	if (!h->have_last)
+	    continue;
+	for (link = 0; link < genser->link_num; link++) {
+	    if (GO_QUANTITY_LENGTH == genser->links[link].quantity) {
+		if (!GO_TRAN_CLOSE(jest[link], h->last[link]))
+		    break;
+	    } else {
+		if (!GO_ROT_CLOSE(jest[link], h->last[link]))
+		    break;
+	    }
+	}
+	if (link == genser->link_num)
+	    return n;
+    }
+    return -1;
+}
+
+static void count_iterations(genser_struct * genser, int ok)
+{
+    int bin, n;
+
+    if (!haldata->hist[0]) {
+	return;
+    }
+    if (*(haldata->hist_reset)) {
+	for (bin = 0; bin < GENSER_HIST_BINS; bin++) {
+	    *(haldata->hist[bin]) = 0;
+	}
+	*(haldata->hist_reset) = 0;
+    }
+    bin = GENSER_HIST_BINS - 1;
+    if (ok) {
+	for (bin = 0, n = 1; n < genser->iterations && bin < GENSER_HIST_BINS - 1; bin++) {
+	    n *= 2;
+	}
+    }
+    (*(haldata->hist[bin]))++;
+}
+
+/* Inverse kinematics by damped least squares (Levenberg-Marquardt).
+   Each step solves (JT J + mu diag(JT J)) dj = JT e, which stays well
+   conditioned near singularities where the plain Newton step of
+   J^-1 e blows up. The damping is lowered while the steps reduce the
+   error, so away from singularities this converges like Newton, and
+   raised when a step makes things worse, which is then undone.
+
+   The estimate starts from joints[], which motion passes as the last
+   servo cycle's joints. When that is the previous solution, the
+   solution before it is used to extrapolate, so along a path the
+   first estimate is already close. The servo cycle and the limit
+   checks solve along different paths, so each caller keeps its own
+   history, recognized by the estimate it passes in.
+
+   A step also vanishes at a local minimum of the error, or when the
+   pose is out of reach and the damping has grown large, so the pose
+   error is checked before a solution is reported. */
 int kinematicsInverse(const EmcPose * world,
 		      double *joints,
 		      const KINEMATICS_INVERSE_FLAGS * iflags,
 		      KINEMATICS_FORWARD_FLAGS * fflags)
 {
-
     genser_struct *genser = KINS_PTR;
-    GO_MATRIX_DECLARE(Jfwd, Jfwd_stg, 6, GENSER_MAX_JOINTS);
-    GO_MATRIX_DECLARE(Jinv, Jinv_stg, GENSER_MAX_JOINTS, 6);
-    go_pose T_L_0;
-    go_real dvw[6];
+    go_real J[6][GENSER_MAX_JOINTS], Jlast[6][GENSER_MAX_JOINTS];
+    go_real A[GENSER_MAX_JOINTS][GENSER_MAX_JOINTS];
+    go_real e[6], elast[6];
     go_real jest[GENSER_MAX_JOINTS];
+    go_real jlast[GENSER_MAX_JOINTS];
     go_real dj[GENSER_MAX_JOINTS];
-    go_pose pest, pestinv, Tdelta;	// pos = converted pose from EmcPose
+    go_real err, errlast = 0.0, mu;
+    go_pose pend;
     go_rpy rpy;
-    go_rvec rvec;
-    go_cart cart;
-    go_link linkout[GENSER_MAX_JOINTS];
-    int link;
+    genser_history *h;
+    int link, row, col;
     int smalls;
+    int hist;
     int retval;
+#ifdef RTAPI
+    long long int start = 0;
+#endif
 
-//    rtapi_print("kineInverse(joints: %f %f %f %f %f %f)\n", joints[0],joints[1],joints[2],joints[3],joints[4],joints[5]);
-//    rtapi_print("kineInverse(world: %f %f %f %f %f %f)\n", world->tran.x, world->tran.y, world->tran.z, world->a, world->b, world->c);
+    genser_kin_refresh(genser);
 
-//    genser_kin_init();
-    
     // FIXME-AJ: rpy or zyx ?
     rpy.y = world->c * PM_PI / 180;
     rpy.p = world->b * PM_PI / 180;
@@ -421,78 +665,92 @@ int kinematicsInverse(const EmcPose * world,
     haldata->pos->tran.y = world->tran.y;
     haldata->pos->tran.z = world->tran.z;
 
-    go_matrix_init(Jfwd, Jfwd_stg, 6, genser->link_num);
-    go_matrix_init(Jinv, Jinv_stg, genser->link_num, 6);
-
     /* jest[] is a copy of joints[], which is the joint estimate */
     for (link = 0; link < genser->link_num; link++) {
 	// jest, and the rest of joint related calcs are in radians
 	jest[link] = joints[link] * (PM_PI / 180);
     }
-
-    for (genser->iterations = 0; genser->iterations < genser->max_iterations; genser->iterations++) {
-	/* update the Jacobians */
+    hist = find_history(genser, jest);
+    if (hist >= 0 && genser->history[hist].have_last == 2) {
+	/* continuing along a path, extrapolate */
+	h = &genser->history[hist];
 	for (link = 0; link < genser->link_num; link++) {
-	    go_link_joint_set(&genser->links[link], jest[link], &linkout[link]);
+	    jest[link] += h->last[link] - h->prev[link];
 	}
-	retval = compute_jfwd(linkout, genser->link_num, &Jfwd, &T_L_0);
+    }
+
+#ifdef RTAPI
+    if (genser->max_time > 0)
+	start = rtapi_get_time();
+#endif
+    mu = genser->damping;
+    for (genser->iterations = 0; genser->iterations < genser->max_iterations; ) {
+#ifdef RTAPI
+	if (genser->max_time > 0 && genser->iterations > 0 &&
+	    rtapi_get_time() - start > genser->max_time)
+	    break;
+#endif
+	retval = compute_jfwd_closed(genser, jest, J, &pend);
 	if (GO_RESULT_OK != retval) {
 	    rtapi_print("ERR kI - compute_jfwd (joints: %f %f %f %f %f %f), (iterations=%d)\n", joints[0],joints[1],joints[2],joints[3],joints[4],joints[5], genser->iterations);
+	    count_iterations(genser, 0);
 	    return retval;
 	}
-	retval = compute_jinv(&Jfwd, &Jinv);
+	genser->iterations++;
+	pose_error(haldata->pos, &pend, e);
+	for (row = 0, err = 0.0; row < 6; row++) {
+	    err += e[row] * e[row];
+	}
+
+	if (genser->iterations > 1 && err > errlast) {
+	    /* the last step made it worse, undo it and damp harder */
+	    for (link = 0; link < genser->link_num; link++) {
+		jest[link] = jlast[link];
+	    }
+	    for (row = 0; row < 6; row++) {
+		e[row] = elast[row];
+		for (col = 0; col < genser->link_num; col++) {
+		    J[row][col] = Jlast[row][col];
+		}
+	    }
+	    err = errlast;
+	    mu *= 10.0;
+	} else {
+	    for (link = 0; link < genser->link_num; link++) {
+		jlast[link] = jest[link];
+	    }
+	    for (row = 0; row < 6; row++) {
+		elast[row] = e[row];
+		for (col = 0; col < genser->link_num; col++) {
+		    Jlast[row][col] = J[row][col];
+		}
+	    }
+	    errlast = err;
+	    if (genser->iterations > 1)
+		mu *= 0.1;
+	}
+
+	/* A = JT J + mu diag(JT J), dj = JT e */
+	for (row = 0; row < genser->link_num; row++) {
+	    for (col = 0; col <= row; col++) {
+		A[row][col] = J[0][row] * J[0][col] + J[1][row] * J[1][col] +
+		    J[2][row] * J[2][col] + J[3][row] * J[3][col] +
+		    J[4][row] * J[4][col] + J[5][row] * J[5][col];
+	    }
+	    A[row][row] += mu * A[row][row] + GO_REAL_EPSILON * GO_REAL_EPSILON;
+	    dj[row] = J[0][row] * e[0] + J[1][row] * e[1] + J[2][row] * e[2] +
+		J[3][row] * e[3] + J[4][row] * e[4] + J[5][row] * e[5];
+	}
+	retval = solve_spd(A, dj, genser->link_num);
 	if (GO_RESULT_OK != retval) {
-	    rtapi_print("ERR kI - compute_jinv (joints: %f %f %f %f %f %f), (iterations=%d)\n", joints[0],joints[1],joints[2],joints[3],joints[4],joints[5], genser->iterations);
+	    rtapi_print("ERR kI - solve (joints: %f %f %f %f %f %f), (iterations=%d)\n", joints[0],joints[1],joints[2],joints[3],joints[4],joints[5], genser->iterations);
+	    count_iterations(genser, 0);
 	    return retval;
 	}
 
-	/* pest is the resulting pose estimate given joint estimate */
-	genser_kin_fwd(KINS_PTR, jest, &pest);
-//	printf("jest: %f %f %f %f %f %f\n",jest[0],jest[1],jest[2],jest[3],jest[4],jest[5]);
-	/* pestinv is its inverse */
-	go_pose_inv(&pest, &pestinv);
-	/*
-	    Tdelta is the incremental pose from pest to pos, such that
-
-	    0        L         0
-	    . pest *  Tdelta =  pos, or
-	    L        L         L
-
-	    L         L          0
-	    .Tdelta =  pestinv *  pos
-	    L         0          L
-	*/
-	go_pose_pose_mult(&pestinv, haldata->pos, &Tdelta);
-
-	/*
-	    We need Tdelta in 0 frame, not pest frame, so rotate it
-    	    back. Since it's effectively a velocity, we just rotate it, and
-    	    don't translate it.
-        */
-
-        /* first rotate the translation differential */
-        go_quat_cart_mult(&pest.rot, &Tdelta.tran, &cart);
-        dvw[0] = cart.x;
-        dvw[1] = cart.y;
-        dvw[2] = cart.z;
-
-        /* to rotate the rotation differential, convert it to a
-    	    velocity screw and rotate that */
-        go_quat_rvec_convert(&Tdelta.rot, &rvec);
-        cart.x = rvec.x;
-        cart.y = rvec.y;
-        cart.z = rvec.z;
-        go_quat_cart_mult(&pest.rot, &cart, &cart);
-        dvw[3] = cart.x;
-        dvw[4] = cart.y;
-        dvw[5] = cart.z;
-
-	/* push the Cartesian velocity vector through the inverse Jacobian */
-	go_matrix_vector_mult(&Jinv, dvw, dj);
-
 	/* check for small joint increments, if so we're done */
 	for (link = 0, smalls = 0; link < genser->link_num; link++) {
-	    if (GO_QUANTITY_LENGTH == linkout[link].quantity) {
+	    if (GO_QUANTITY_LENGTH == genser->links[link].quantity) {
 		if (GO_TRAN_SMALL(dj[link]))
 		    smalls++;
 	    } else {
@@ -501,12 +759,30 @@ int kinematicsInverse(const EmcPose * world,
 	    }
 	}
 	if (smalls == genser->link_num) {
+	    if (e[0] * e[0] + e[1] * e[1] + e[2] * e[2] >
+		    GENSER_TRAN_TOLERANCE * GENSER_TRAN_TOLERANCE ||
+		e[3] * e[3] + e[4] * e[4] + e[5] * e[5] >
+		    GENSER_ROT_TOLERANCE * GENSER_ROT_TOLERANCE) {
+		/* stuck short of the pose */
+		break;
+	    }
+	    if (hist < 0) {
+		/* a new caller, take over the history used longest ago */
+		hist = genser->history_next;
+		genser->history[hist].have_last = 0;
+	    }
+	    genser->history_next = (hist + 1) % GENSER_HISTORIES;
+	    h = &genser->history[hist];
 	    /* converged, copy jest[] out */
 	    for (link = 0; link < genser->link_num; link++) {
+		h->prev[link] = h->last[link];
+		h->last[link] = jest[link];
 		// convert from radians back to angles
 		joints[link] = jest[link] * 180 / PM_PI;
 	    }
-//	    rtapi_print("DONEkineInverse(joints: %f %f %f %f %f %f), (iterations=%d)\n", joints[0],joints[1],joints[2],joints[3],joints[4],joints[5], genser->iterations);
+	    if (h->have_last < 2)
+		h->have_last++;
+	    count_iterations(genser, 1);
 	    return GO_RESULT_OK;
 	}
 	/* else keep iterating */
@@ -515,6 +791,9 @@ int kinematicsInverse(const EmcPose * world,
 	}
     }				/* for (iterations) */
 
+    if (hist >= 0)
+	genser->history[hist].have_last = 0;
+    count_iterations(genser, 0);
     rtapi_print("ERRkineInverse(joints: %f %f %f %f %f %f), (iterations=%d)\n", joints[0],joints[1],joints[2],joints[3],joints[4],joints[5], genser->iterations);
     return GO_RESULT_ERROR;
 }
@@ -616,8 +895,32 @@ int rtapi_app_main(void)
     if ((res=
         hal_param_s32_newf(HAL_RW, &(KINS_PTR->max_iterations), comp_id, "genserkins.max-iterations")) < 0)
         goto error;
+    if ((res=
+        hal_param_s32_newf(HAL_RW, &(KINS_PTR->max_time), comp_id, "genserkins.max-time")) < 0)
+        goto error;
+    if ((res=
+        hal_param_float_newf(HAL_RW, &(KINS_PTR->damping), comp_id, "genserkins.damping")) < 0)
+        goto error;
+    for (i = 0; i < GENSER_HIST_BINS; i++) {
+	if ((res =
+		hal_pin_u32_newf(HAL_OUT, &(haldata->hist[i]), comp_id,
+		    "genserkins.iterations-hist-%d", i)) < 0)
+	    goto error;
+	*(haldata->hist[i]) = 0;
+    }
+    if ((res =
+	    hal_pin_bit_newf(HAL_IO, &(haldata->hist_reset), comp_id,
+		"genserkins.iterations-hist-reset")) < 0)
+	goto error;
+    *(haldata->hist_reset) = 0;
 
     KINS_PTR->max_iterations = GENSER_DEFAULT_MAX_ITERATIONS;
+    KINS_PTR->max_time = 0;
+    KINS_PTR->damping = GENSER_DEFAULT_DAMPING;
+    for (i = 0; i < GENSER_HISTORIES; i++) {
+	KINS_PTR->history[i].have_last = 0;
+    }
+    KINS_PTR->history_next = 0;
 
 
     A(0) = DEFAULT_A1;
@@ -638,13 +941,14 @@ int rtapi_app_main(void)
     D(3) = DEFAULT_D4;
     D(4) = DEFAULT_D5;
     D(5) = DEFAULT_D6;
+    genser_kin_init();
 
-    vtable_id = hal_export_vtable(name, VTKINEMATICS_VERSION1, &vtk, comp_id);
+    vtable_id = hal_export_vtable(name, VTKINEMATICS_VERSION2, &vtk, comp_id);
 
     if (vtable_id < 0) {
 	rtapi_print_msg(RTAPI_MSG_ERR,
 			"%s: ERROR: hal_export_vtable(%s,%d,%p) failed: %d\n",
-			name, name,  VTKINEMATICS_VERSION1, &vtk, vtable_id );
+			name, name,  VTKINEMATICS_VERSION2, &vtk, vtable_id );
 	return -ENOENT;
     }
     hal_ready(comp_id);
@@ -701,6 +1005,14 @@ int main(int argc, char *argv[])
 
     KINS_PTR = malloc(sizeof(genser_struct));
     haldata->pos = (go_pose *) malloc(sizeof(go_pose));
+    haldata->hist[0] = NULL;	// no histogram
+    KINS_PTR->max_iterations = GENSER_DEFAULT_MAX_ITERATIONS;
+    KINS_PTR->max_time = 0;
+    KINS_PTR->damping = GENSER_DEFAULT_DAMPING;
+    for (i = 0; i < GENSER_HISTORIES; i++) {
+	KINS_PTR->history[i].have_last = 0;
+    }
+    KINS_PTR->history_next = 0;
 
     for (i = 0; i < GENSER_MAX_JOINTS ; i++) {
 	haldata->a[i] = malloc(sizeof(double));
@@ -725,6 +1037,7 @@ int main(int argc, char *argv[])
     D(3) = DEFAULT_D4;
     D(4) = DEFAULT_D5;
     D(5) = DEFAULT_D6;
+    genser_kin_init();
 
     /* syntax is a.out {i|f # # # # # #} */
     if (argc == 8) {
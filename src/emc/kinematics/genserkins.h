@@ -69,11 +69,36 @@
 #define DEFAULT_ALPHA6 -PI_2
 #define DEFAULT_D6 0
 
+/*!
+  Number of bins in the iteration count histogram of the inverse
+  kinematics. Bin 0 counts solutions found with 1 iteration, bin 1 with
+  2, bin 2 with 3-4, bin 3 with 5-8 and so on, doubling; the last bin
+  also counts the failures.
+*/
+#define GENSER_HIST_BINS 8
+
+/*!
+  Number of warm start histories. Each caller that solves along its own
+  path (the servo cycle, the limit checks) keeps its own, recognized by
+  the estimate it passes in being the last solution of that history.
+*/
+#define GENSER_HISTORIES 2
+
+typedef struct {
+  go_real last[GENSER_MAX_JOINTS]; /*!< Last two solutions, for the warm start. */
+  go_real prev[GENSER_MAX_JOINTS];
+  int have_last;	/*!< Number of valid solutions in last[] and prev[]. */
+} genser_history;
+
 typedef struct {
   go_link links[GENSER_MAX_JOINTS]; /*!< The link description of the device. */
   int link_num;		/*!< How many are actually present. */
   hal_s32_t iterations;	/*!< How many iterations were actually used to compute the inverse kinematics. */
   hal_s32_t max_iterations;	/*!< Number of iterations after which to give up and report an error. */
+  hal_s32_t max_time;	/*!< Nanoseconds after which to give up, 0 for no limit (realtime only). */
+  hal_float_t damping;	/*!< Initial damping of the least squares solver, relative to the Jacobian. */
+  genser_history history[GENSER_HISTORIES]; /*!< Warm start histories. */
+  int history_next;	/*!< History to take over for a new caller. */
 } genser_struct;
 
 extern int genser_kin_size(void); 
@@ -67,7 +67,7 @@
 #include "kinematics.h"             /* these decls */
 #include "rtapi_math.h"
 
-#define VTVERSION VTKINEMATICS_VERSION1
+#define VTVERSION VTKINEMATICS_VERSION2
 
 #ifndef __GNUC__
 #ifndef __attribute__
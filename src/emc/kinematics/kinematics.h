@@ -126,11 +126,48 @@ typedef int (* vtk_kinematicsHome_t)(struct EmcPose * world,
 
 typedef KINEMATICS_TYPE  (*vtk_kinematicsType_t)(void);
 
+/* Optional batch kinematics, for callers that transform many points at
+   once (limit checks along a path, joint limited planning). Points are
+   passed as a structure of arrays: world->x[i] is the X coordinate of
+   point i, joints[j][i] the position of joint j at point i, so a module
+   can run each formula as a plain loop over the points, which the
+   compiler vectorizes. All nine world arrays and a row for every joint
+   the single point functions use must be supplied. The flags are the
+   same for all points; the flags set by the call are those of the last
+   point. Both return the number of leading points transformed, n if all
+   of them were.
+
+   Only VTKINEMATICS_VERSION2 vtables have the batch entries. Modules
+   built against older headers export VTKINEMATICS_VERSION1, whose table
+   ends after kinematicsType. Callers reference VERSION2 first and fall
+   back to VERSION1, treating the batch entries as absent. In a VERSION2
+   vtable they may still be NULL, and callers then use the single point
+   functions. */
+typedef struct {
+    double *x, *y, *z;
+    double *a, *b, *c;
+    double *u, *v, *w;
+} EmcPoseBatch;
+
+typedef int (*vtk_kinematicsForwardBatch_t)(int n,
+				     double * const *joints,
+				     const EmcPoseBatch * world,
+				     const KINEMATICS_FORWARD_FLAGS * fflags,
+				     KINEMATICS_INVERSE_FLAGS * iflags);
+typedef int (*vtk_kinematicsInverseBatch_t)(int n,
+				     const EmcPoseBatch * world,
+				     double * const *joints,
+				     const KINEMATICS_INVERSE_FLAGS * iflags,
+				     KINEMATICS_FORWARD_FLAGS * fflags);
+
 typedef struct {
     vtk_kinematicsForward_t kinematicsForward;
     vtk_kinematicsInverse_t kinematicsInverse;
     vtk_kinematicsHome_t    kinematicsHome; // used by drawbotkins
     vtk_kinematicsType_t    kinematicsType;
+    // VTKINEMATICS_VERSION2 only, may be NULL:
+    vtk_kinematicsForwardBatch_t kinematicsForwardBatch;  // may be NULL
+    vtk_kinematicsInverseBatch_t kinematicsInverseBatch;  // may be NULL
 } vtkins_t;
 
 #endif
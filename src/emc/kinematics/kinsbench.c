@@ -0,0 +1,423 @@
+/********************************************************************
+* Description: kinsbench.c
+*   Benchmark and round trip test for kinematics modules.
+*
+*   References the vtable of any loaded kinematics module, as motion
+*   does, and sweeps poses through its inverse and forward kinematics
+*   from a HAL thread, a number of points per period. For each point it
+*   times both calls and compares the forward solution with the pose it
+*   started from. Results are HAL pins: mean and worst times, log2 time
+*   histograms, round trip errors and failure counts. The kinsbench
+*   script drives a run and prints them as JSON or CSV.
+*
+*   Poses are drawn inside a box set by the min-* and max-* pins. With
+*   step = 0 they are uniform and independent; with step > 0 each pose
+*   moves from the previous one by up to step times the box size per
+*   coordinate, so iterative kinematics see the warm starts they get on
+*   a running machine. The forward kinematics are seeded with their
+*   previous solution, as motion seeds them with the previous feedback.
+*
+*   Iterative kinematics export their iteration count (e.g. the
+*   genhexkins.last-iterations pin); net it to forward-iterations or
+*   inverse-iterations to get its mean and maximum over the run.
+*
+* Author:
+* License: GPL Version 2
+* System: Linux
+*
+* Copyright (c) 2026 All rights reserved.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+********************************************************************/
+
+#include "rtapi.h"		/* RTAPI realtime OS API */
+#include "rtapi_app.h"		/* RTAPI realtime module decls */
+#include "rtapi_math.h"
+#include "hal.h"
+#include "kinematics.h"
+
+MODULE_DESCRIPTION("Benchmark and round trip test for kinematics modules");
+MODULE_LICENSE("GPL");
+
+static char *kins = "trivkins";
+RTAPI_MP_STRING(kins, "kinematics vtable name");
+
+#define KINSBENCH_COORDS 9	/* x y z a b c u v w */
+#define KINSBENCH_JOINTS 9	/* EMCMOT_MAX_JOINTS */
+#define KINSBENCH_HIST_BINS 16
+#define KINSBENCH_HIST_MIN_NS 128	/* upper edge of bin 0, doubling */
+
+static const char coord_name[KINSBENCH_COORDS] = "xyzabcuvw";
+
+typedef struct {
+    hal_u32_t *count[KINSBENCH_HIST_BINS];
+    hal_float_t *mean_ns;
+    hal_float_t *max_ns;
+    hal_s32_t *iterations;	/* in, from the kinematics */
+    hal_float_t *iterations_mean;
+    hal_s32_t *iterations_max;
+    hal_u32_t *fail;
+    double sum_ns;
+    double sum_iterations;
+    long n;
+} kinsbench_stat_t;
+
+typedef struct {
+    /* run control */
+    hal_bit_t *start;		/* io: set to start, cleared when accepted */
+    hal_bit_t *running;
+    hal_u32_t *points;		/* points to run */
+    hal_u32_t *per_cycle;	/* points per thread period */
+    hal_u32_t *seed;
+    hal_float_t *step;
+    hal_float_t *min[KINSBENCH_COORDS];
+    hal_float_t *max[KINSBENCH_COORDS];
+
+    /* results */
+    hal_u32_t *done;
+    hal_float_t *max_error_linear;
+    hal_float_t *max_error_angular;
+    hal_float_t *rms_error_linear;
+    kinsbench_stat_t inverse;
+    kinsbench_stat_t forward;
+
+    /* run state */
+    __u32 rng;
+    double pos[KINSBENCH_COORDS];
+    double joints[KINSBENCH_JOINTS];
+    EmcPose fb;			/* previous forward solution */
+    KINEMATICS_FORWARD_FLAGS fflags;
+    KINEMATICS_INVERSE_FLAGS iflags;
+    double sum_sq_error;
+} kinsbench_t;
+
+static kinsbench_t *kb;
+static vtkins_t *vtk;
+static int comp_id, vtable_id;
+static const char *name = "kinsbench";
+
+/* xorshift32, repeatable for a given seed */
+static double kb_random(kinsbench_t *k)
+{
+    k->rng ^= k->rng << 13;
+    k->rng ^= k->rng >> 17;
+    k->rng ^= k->rng << 5;
+    return k->rng / 4294967296.0;
+}
+
+static void pose_from_array(EmcPose *p, const double *c)
+{
+    p->tran.x = c[0];
+    p->tran.y = c[1];
+    p->tran.z = c[2];
+    p->a = c[3];
+    p->b = c[4];
+    p->c = c[5];
+    p->u = c[6];
+    p->v = c[7];
+    p->w = c[8];
+}
+
+static void stat_reset(kinsbench_stat_t *s)
+{
+    int i;
+
+    for (i = 0; i < KINSBENCH_HIST_BINS; i++) {
+	*(s->count[i]) = 0;
+    }
+    *(s->mean_ns) = 0.0;
+    *(s->max_ns) = 0.0;
+    *(s->iterations_mean) = 0.0;
+    *(s->iterations_max) = 0;
+    *(s->fail) = 0;
+    s->sum_ns = 0.0;
+    s->sum_iterations = 0.0;
+    s->n = 0;
+}
+
+static void stat_add(kinsbench_stat_t *s, long long ns)
+{
+    long long edge = KINSBENCH_HIST_MIN_NS;
+    int bin = 0;
+
+    while (ns >= edge && bin < KINSBENCH_HIST_BINS - 1) {
+	edge <<= 1;
+	bin++;
+    }
+    (*(s->count[bin]))++;
+    s->n++;
+    s->sum_ns += ns;
+    *(s->mean_ns) = s->sum_ns / s->n;
+    if (ns > *(s->max_ns)) {
+	*(s->max_ns) = ns;
+    }
+    s->sum_iterations += *(s->iterations);
+    *(s->iterations_mean) = s->sum_iterations / s->n;
+    if (*(s->iterations) > *(s->iterations_max)) {
+	*(s->iterations_max) = *(s->iterations);
+    }
+}
+
+static void start_run(kinsbench_t *k)
+{
+    int i;
+
+    stat_reset(&k->inverse);
+    stat_reset(&k->forward);
+    *(k->done) = 0;
+    *(k->max_error_linear) = 0.0;
+    *(k->max_error_angular) = 0.0;
+    *(k->rms_error_linear) = 0.0;
+    k->sum_sq_error = 0.0;
+    k->rng = *(k->seed) ? *(k->seed) : 1;
+    k->fflags = 0;
+    k->iflags = 0;
+
+    /* start in the middle of the box, joints from there */
+    for (i = 0; i < KINSBENCH_COORDS; i++) {
+	k->pos[i] = 0.5 * (*(k->min[i]) + *(k->max[i]));
+    }
+    for (i = 0; i < KINSBENCH_JOINTS; i++) {
+	k->joints[i] = 0.0;
+    }
+    pose_from_array(&k->fb, k->pos);
+    vtk->kinematicsInverse(&k->fb, k->joints, &k->iflags, &k->fflags);
+}
+
+static void next_pose(kinsbench_t *k)
+{
+    double step = *(k->step);
+    double lo, hi;
+    int i;
+
+    for (i = 0; i < KINSBENCH_COORDS; i++) {
+	lo = *(k->min[i]);
+	hi = *(k->max[i]);
+	if (step <= 0.0) {
+	    k->pos[i] = lo + (hi - lo) * kb_random(k);
+	    continue;
+	}
+	k->pos[i] += step * (hi - lo) * (2.0 * kb_random(k) - 1.0);
+	if (k->pos[i] > hi) {
+	    k->pos[i] = 2.0 * hi - k->pos[i];
+	}
+	if (k->pos[i] < lo) {
+	    k->pos[i] = 2.0 * lo - k->pos[i];
+	}
+    }
+}
+
+static void run_point(kinsbench_t *k)
+{
+    double joints[KINSBENCH_JOINTS];
+    double err, lin = 0.0, ang = 0.0;
+    EmcPose pos, fb;
+    long long t0, t1;
+    int i, res;
+
+    next_pose(k);
+    pose_from_array(&pos, k->pos);
+
+    /* iterative kinematics start from the last solution */
+    for (i = 0; i < KINSBENCH_JOINTS; i++) {
+	joints[i] = k->joints[i];
+    }
+    t0 = rtapi_get_time();
+    res = vtk->kinematicsInverse(&pos, joints, &k->iflags, &k->fflags);
+    t1 = rtapi_get_time();
+    stat_add(&k->inverse, t1 - t0);
+    if (res) {
+	(*(k->inverse.fail))++;
+	return;
+    }
+    for (i = 0; i < KINSBENCH_JOINTS; i++) {
+	k->joints[i] = joints[i];
+    }
+
+    fb = k->fb;
+    t0 = rtapi_get_time();
+    res = vtk->kinematicsForward(joints, &fb, &k->fflags, &k->iflags);
+    t1 = rtapi_get_time();
+    stat_add(&k->forward, t1 - t0);
+    if (res) {
+	(*(k->forward.fail))++;
+	/* restart from the commanded pose, as motion restarts from home */
+	k->fb = pos;
+	return;
+    }
+    k->fb = fb;
+
+    lin = rtapi_fabs(fb.tran.x - pos.tran.x);
+    if ((err = rtapi_fabs(fb.tran.y - pos.tran.y)) > lin) lin = err;
+    if ((err = rtapi_fabs(fb.tran.z - pos.tran.z)) > lin) lin = err;
+    if ((err = rtapi_fabs(fb.u - pos.u)) > lin) lin = err;
+    if ((err = rtapi_fabs(fb.v - pos.v)) > lin) lin = err;
+    if ((err = rtapi_fabs(fb.w - pos.w)) > lin) lin = err;
+    ang = rtapi_fabs(fb.a - pos.a);
+    if ((err = rtapi_fabs(fb.b - pos.b)) > ang) ang = err;
+    if ((err = rtapi_fabs(fb.c - pos.c)) > ang) ang = err;
+
+    if (lin > *(k->max_error_linear)) {
+	*(k->max_error_linear) = lin;
+    }
+    if (ang > *(k->max_error_angular)) {
+	*(k->max_error_angular) = ang;
+    }
+    k->sum_sq_error += lin * lin;
+    *(k->rms_error_linear) = rtapi_sqrt(k->sum_sq_error / k->forward.n);
+}
+
+static void kinsbench_run(void *arg, long period)
+{
+    kinsbench_t *k = arg;
+    hal_u32_t n;
+
+    if (*(k->start)) {
+	*(k->start) = 0;
+	start_run(k);
+	*(k->running) = 1;
+    }
+    if (!*(k->running)) {
+	return;
+    }
+    for (n = 0; n < *(k->per_cycle) && *(k->done) < *(k->points); n++) {
+	run_point(k);
+	(*(k->done))++;
+    }
+    if (*(k->done) >= *(k->points)) {
+	*(k->running) = 0;
+    }
+}
+
+static int export_stat(kinsbench_stat_t *s, const char *which)
+{
+    int i, res;
+
+    for (i = 0; i < KINSBENCH_HIST_BINS; i++) {
+	if ((res = hal_pin_u32_newf(HAL_OUT, &(s->count[i]), comp_id,
+				    "%s.%s-hist-%d", name, which, i)) < 0)
+	    return res;
+    }
+    if (((res = hal_pin_float_newf(HAL_OUT, &(s->mean_ns), comp_id,
+				   "%s.%s-ns-mean", name, which)) < 0) ||
+	((res = hal_pin_float_newf(HAL_OUT, &(s->max_ns), comp_id,
+				   "%s.%s-ns-max", name, which)) < 0) ||
+	((res = hal_pin_s32_newf(HAL_IN, &(s->iterations), comp_id,
+				 "%s.%s-iterations", name, which)) < 0) ||
+	((res = hal_pin_float_newf(HAL_OUT, &(s->iterations_mean), comp_id,
+				   "%s.%s-iterations-mean", name, which)) < 0) ||
+	((res = hal_pin_s32_newf(HAL_OUT, &(s->iterations_max), comp_id,
+				 "%s.%s-iterations-max", name, which)) < 0) ||
+	((res = hal_pin_u32_newf(HAL_OUT, &(s->fail), comp_id,
+				 "%s.%s-fail", name, which)) < 0))
+	return res;
+    return 0;
+}
+
+static int export_pins(kinsbench_t *k)
+{
+    int i, res;
+
+    if (((res = hal_pin_bit_newf(HAL_IO, &(k->start), comp_id,
+				 "%s.start", name)) < 0) ||
+	((res = hal_pin_bit_newf(HAL_OUT, &(k->running), comp_id,
+				 "%s.running", name)) < 0) ||
+	((res = hal_pin_u32_newf(HAL_IN, &(k->points), comp_id,
+				 "%s.points", name)) < 0) ||
+	((res = hal_pin_u32_newf(HAL_IN, &(k->per_cycle), comp_id,
+				 "%s.per-cycle", name)) < 0) ||
+	((res = hal_pin_u32_newf(HAL_IN, &(k->seed), comp_id,
+				 "%s.seed", name)) < 0) ||
+	((res = hal_pin_float_newf(HAL_IN, &(k->step), comp_id,
+				   "%s.step", name)) < 0) ||
+	((res = hal_pin_u32_newf(HAL_OUT, &(k->done), comp_id,
+				 "%s.done", name)) < 0) ||
+	((res = hal_pin_float_newf(HAL_OUT, &(k->max_error_linear), comp_id,
+				   "%s.max-error-linear", name)) < 0) ||
+	((res = hal_pin_float_newf(HAL_OUT, &(k->max_error_angular), comp_id,
+				   "%s.max-error-angular", name)) < 0) ||
+	((res = hal_pin_float_newf(HAL_OUT, &(k->rms_error_linear), comp_id,
+				   "%s.rms-error-linear", name)) < 0))
+	return res;
+
+    for (i = 0; i < KINSBENCH_COORDS; i++) {
+	if (((res = hal_pin_float_newf(HAL_IN, &(k->min[i]), comp_id,
+				       "%s.min-%c", name, coord_name[i])) < 0) ||
+	    ((res = hal_pin_float_newf(HAL_IN, &(k->max[i]), comp_id,
+				       "%s.max-%c", name, coord_name[i])) < 0))
+	    return res;
+    }
+
+    if (((res = export_stat(&k->inverse, "inverse")) < 0) ||
+	((res = export_stat(&k->forward, "forward")) < 0))
+	return res;
+
+    /* defaults: a 20 unit cube around the origin */
+    *(k->points) = 10000;
+    *(k->per_cycle) = 100;
+    *(k->seed) = 1;
+    *(k->step) = 0.0;
+    for (i = 0; i < 3; i++) {
+	*(k->min[i]) = -10.0;
+	*(k->max[i]) = 10.0;
+    }
+    return 0;
+}
+
+int rtapi_app_main(void)
+{
+    int res;
+
+    comp_id = hal_init(name);
+    if (comp_id < 0)
+	return comp_id;
+
+    // only the single point entries are used, so either layout will do
+    vtable_id = hal_reference_vtable(kins, VTKINEMATICS_VERSION2, (void **) &vtk);
+    if (vtable_id < 0)
+	vtable_id = hal_reference_vtable(kins, VTKINEMATICS_VERSION1, (void **) &vtk);
+    if (vtable_id < 0) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+			"%s: ERROR: hal_reference_vtable(%s,%d) failed: %d\n",
+			name, kins, VTKINEMATICS_VERSION1, vtable_id);
+	hal_exit(comp_id);
+	return vtable_id;
+    }
+
+    kb = hal_malloc(sizeof(kinsbench_t));
+    if (!kb) {
+	res = -ENOMEM;
+	goto error;
+    }
+    if ((res = export_pins(kb)) < 0)
+	goto error;
+    if ((res = hal_export_functf(kinsbench_run, kb, 1, 0, comp_id,
+				 "%s.run", name)) < 0)
+	goto error;
+
+    hal_ready(comp_id);
+    return 0;
+
+error:
+    hal_unreference_vtable(vtable_id);
+    hal_exit(comp_id);
+    return res;
+}
+
+void rtapi_app_exit(void)
+{
+    hal_unreference_vtable(vtable_id);
+    hal_exit(comp_id);
+}
@@ -0,0 +1,219 @@
+#!/usr/bin/python2
+# encoding: utf-8
+"""
+kinsbench.py
+
+Benchmarks a kinematics module and checks its round trip error, using the
+kinsbench realtime component (see emc/kinematics/kinsbench.c). Loads the
+module and kinsbench, sweeps the workspace from a HAL thread and prints the
+call times, iteration counts and forward(inverse(pose)) errors as JSON or
+CSV. Realtime must be running.
+
+    kinsbench genhexkins -r z=20:30 -r a=-5:5 -r b=-5:5 -r c=-5:5 \\
+        --step 0.001 --forward-iterations genhexkins.last-iterations
+"""
+
+import sys
+import json
+import time
+import argparse
+import subprocess
+
+COORDS = 'xyzabcuvw'
+HIST_BINS = 16       # must match KINSBENCH_HIST_BINS
+HIST_MIN_NS = 128    # must match KINSBENCH_HIST_MIN_NS
+COMP = 'kinsbench'
+THREAD = 'kinsbench-thread'
+
+
+def halcmd(*args):
+    try:
+        return subprocess.check_output(('halcmd',) + args).strip()
+    except subprocess.CalledProcessError as e:
+        sys.stderr.write('kinsbench: halcmd %s failed\n' % ' '.join(args))
+        sys.exit(e.returncode or 1)
+
+
+def getp(names):
+    # one halcmd for all pins, reading the commands from stdin
+    p = subprocess.Popen(['halcmd', '-s', '-f'], stdin=subprocess.PIPE,
+                         stdout=subprocess.PIPE)
+    out, _ = p.communicate(''.join('getp %s\n' % n for n in names))
+    if p.returncode:
+        sys.stderr.write('kinsbench: reading the results failed\n')
+        sys.exit(p.returncode)
+    return dict(zip(names, out.split()))
+
+
+def pin_names(prefix):
+    out = halcmd('-s', 'show', 'pin', prefix)
+    return [line.split()[-1] for line in out.splitlines() if line.split()]
+
+
+def percentile(hist, q):
+    # upper edge of the bin holding the q quantile
+    total = sum(hist)
+    if not total:
+        return 0
+    acc = 0
+    for i, n in enumerate(hist):
+        acc += n
+        if acc >= q * total:
+            return HIST_MIN_NS << i
+    return HIST_MIN_NS << (len(hist) - 1)
+
+
+def stats(values, which):
+    pin = lambda s: float(values['%s.%s-%s' % (COMP, which, s)])
+    hist = [int(values['%s.%s-hist-%d' % (COMP, which, i)])
+            for i in range(HIST_BINS)]
+    return {
+        'ns_mean': pin('ns-mean'),
+        'ns_max': pin('ns-max'),
+        'ns_p50': percentile(hist, 0.5),
+        'ns_p99': percentile(hist, 0.99),
+        'hist': hist,
+        'hist_edges_ns': [HIST_MIN_NS << i for i in range(HIST_BINS - 1)],
+        'fail': int(pin('fail')),
+        'iterations_mean': pin('iterations-mean'),
+        'iterations_max': int(pin('iterations-max')),
+    }
+
+
+def flatten(d, prefix=''):
+    for k in sorted(d):
+        v = d[k]
+        name = prefix + k
+        if isinstance(v, dict):
+            for item in flatten(v, name + '.'):
+                yield item
+        elif isinstance(v, list):
+            for i, x in enumerate(v):
+                yield '%s.%d' % (name, i), x
+        else:
+            yield name, v
+
+
+def parse_range(s):
+    try:
+        coord, rng = s.split('=')
+        lo, hi = rng.split(':')
+        if coord not in COORDS:
+            raise ValueError
+        return coord, float(lo), float(hi)
+    except ValueError:
+        raise argparse.ArgumentTypeError('range must look like x=-10:10')
+
+
+def parse_setp(s):
+    if '=' not in s:
+        raise argparse.ArgumentTypeError('setp must look like pin=value')
+    return s.split('=', 1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmark a kinematics module')
+    parser.add_argument('kins', help='kinematics module, e.g. genhexkins')
+    parser.add_argument('args', nargs='*', help='loadrt arguments for the module')
+    parser.add_argument('-r', '--range', type=parse_range, action='append', default=[],
+                        help='coordinate range, e.g. z=20:30 (default x,y,z=-10:10, others 0)')
+    parser.add_argument('-n', '--points', type=int, default=10000,
+                        help='poses to run (default 10000)')
+    parser.add_argument('--per-cycle', type=int, default=100,
+                        help='poses per thread period (default 100)')
+    parser.add_argument('--period', type=int, default=1000000,
+                        help='thread period in ns (default 1000000)')
+    parser.add_argument('--step', type=float, default=0.0,
+                        help='random walk step as a fraction of each range (default 0: independent poses)')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--setp', type=parse_setp, action='append', default=[],
+                        help='set a module pin or parameter before the run, pin=value')
+    parser.add_argument('--forward-iterations', metavar='PIN',
+                        help='pin reporting the forward kinematics iterations')
+    parser.add_argument('--inverse-iterations', metavar='PIN',
+                        help='pin reporting the inverse kinematics iterations')
+    parser.add_argument('--report', metavar='PREFIX', action='append', default=[],
+                        help='also report the pins starting with PREFIX')
+    parser.add_argument('-f', '--format', choices=['json', 'csv'], default='json')
+    parser.add_argument('-o', '--output', help='output file (default stdout)')
+    args = parser.parse_args()
+
+    halcmd('loadrt', args.kins, *args.args)
+    halcmd('loadrt', COMP, 'kins=%s' % args.kins)
+    thread = False
+    try:
+        halcmd('newthread', THREAD, str(args.period), 'fp')
+        thread = True
+        halcmd('addf', '%s.run' % COMP, THREAD)
+
+        ranges = dict((c, (0.0, 0.0)) for c in COORDS)
+        ranges.update(dict((c, (-10.0, 10.0)) for c in 'xyz'))
+        for coord, lo, hi in args.range:
+            ranges[coord] = (lo, hi)
+        for c in COORDS:
+            halcmd('setp', '%s.min-%s' % (COMP, c), repr(ranges[c][0]))
+            halcmd('setp', '%s.max-%s' % (COMP, c), repr(ranges[c][1]))
+        halcmd('setp', '%s.points' % COMP, str(args.points))
+        halcmd('setp', '%s.per-cycle' % COMP, str(args.per_cycle))
+        halcmd('setp', '%s.step' % COMP, repr(args.step))
+        halcmd('setp', '%s.seed' % COMP, str(args.seed))
+        for name, value in args.setp:
+            halcmd('setp', name, value)
+        if args.forward_iterations:
+            halcmd('net', 'kinsbench-fwd-iter', args.forward_iterations,
+                   '%s.forward-iterations' % COMP)
+        if args.inverse_iterations:
+            halcmd('net', 'kinsbench-inv-iter', args.inverse_iterations,
+                   '%s.inverse-iterations' % COMP)
+
+        halcmd('start')
+        halcmd('setp', '%s.start' % COMP, '1')
+        while True:
+            time.sleep(0.1)
+            v = getp(['%s.start' % COMP, '%s.running' % COMP])
+            if v['%s.start' % COMP] == 'FALSE' and v['%s.running' % COMP] == 'FALSE':
+                break
+        halcmd('stop')
+
+        names = pin_names(COMP + '.')
+        extra = []
+        for prefix in args.report:
+            extra += pin_names(prefix)
+        values = getp(names + extra)
+    finally:
+        if thread:
+            halcmd('delthread', THREAD)
+        halcmd('unloadrt', COMP)
+        halcmd('unloadrt', args.kins)
+
+    result = {
+        'kins': args.kins,
+        'points': int(values['%s.done' % COMP]),
+        'period_ns': args.period,
+        'step': args.step,
+        'ranges': dict((c, list(ranges[c])) for c in COORDS),
+        'inverse': stats(values, 'inverse'),
+        'forward': stats(values, 'forward'),
+        'error': {
+            'max_linear': float(values['%s.max-error-linear' % COMP]),
+            'max_angular': float(values['%s.max-error-angular' % COMP]),
+            'rms_linear': float(values['%s.rms-error-linear' % COMP]),
+        },
+    }
+    if extra:
+        result['pins'] = dict((n, values[n]) for n in extra)
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    if args.format == 'json':
+        json.dump(result, out, indent=1, sort_keys=True)
+        out.write('\n')
+    else:
+        out.write('metric,value\n')
+        for name, value in flatten(result):
+            out.write('%s,%s\n' % (name, value))
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -20,7 +20,7 @@
 #include "rtapi_app.h"
 
 #include "lineardeltakins-common.h"
-#define VTVERSION VTKINEMATICS_VERSION1
+#define VTVERSION VTKINEMATICS_VERSION2
 
 struct haldata
 {
@@ -42,6 +42,72 @@ int kinematicsInverse(const EmcPose *pos, double *joints,
     return kinematics_inverse(pos, joints);
 }
 
+static inline void copy_batch(double *dst, const double *src, int n)
+{
+    int i;
+    for(i = 0; i < n; i++)
+        dst[i] = src[i];
+}
+
+// One loop per tower, each a straight line sqrt over the points. Failed
+// points come out as NaN; the first one found ends the batch there.
+int kinematicsInverseBatch(int n, const EmcPoseBatch *pos,
+        double * const *joints,
+        const KINEMATICS_INVERSE_FLAGS *iflags,
+        KINEMATICS_FORWARD_FLAGS *fflags) {
+    const double *x = pos->x, *y = pos->y, *z = pos->z;
+    double *j0 = joints[0], *j1 = joints[1], *j2 = joints[2];
+    int i;
+
+    set_geometry(*haldata->r, *haldata->l,*haldata ->j0off,*haldata ->j1off,*haldata ->j2off,*haldata ->r1off,*haldata ->r2off,*haldata ->a1off,*haldata ->a2off);
+    for(i = 0; i < n; i++)
+        j0[i] = z[i] + rtapi_sqrt(L2 - sq(Ax-x[i]) - sq(Ay-y[i])) + J0off;
+    for(i = 0; i < n; i++)
+        j1[i] = z[i] + rtapi_sqrt(L2 - sq(Bx-x[i]) - sq(By-y[i])) + J1off;
+    for(i = 0; i < n; i++)
+        j2[i] = z[i] + rtapi_sqrt(L2 - sq(Cx-x[i]) - sq(Cy-y[i])) + J2off;
+    copy_batch(joints[3], pos->a, n);
+    copy_batch(joints[4], pos->b, n);
+    copy_batch(joints[5], pos->c, n);
+    copy_batch(joints[6], pos->u, n);
+    copy_batch(joints[7], pos->v, n);
+    copy_batch(joints[8], pos->w, n);
+
+    for(i = 0; i < n; i++)
+        if(rtapi_isnan(j0[i]) || rtapi_isnan(j1[i]) || rtapi_isnan(j2[i]))
+            return i;
+    return n;
+}
+
+// The forward solution has a branch for unreachable points, so this just
+// runs the single point version over the batch.
+int kinematicsForwardBatch(int n, double * const *joints,
+        const EmcPoseBatch *pos,
+        const KINEMATICS_FORWARD_FLAGS *fflags,
+        KINEMATICS_INVERSE_FLAGS *iflags) {
+    double j[9];
+    EmcPose p;
+    int i, k;
+
+    set_geometry(*haldata->r, *haldata->l,*haldata ->j0off,*haldata ->j1off,*haldata ->j2off,*haldata ->r1off,*haldata ->r2off,*haldata ->a1off,*haldata ->a2off);
+    for(i = 0; i < n; i++) {
+        for(k = 0; k < 9; k++)
+            j[k] = joints[k][i];
+        if(kinematics_forward(j, &p))
+            return i;
+        pos->x[i] = p.tran.x;
+        pos->y[i] = p.tran.y;
+        pos->z[i] = p.tran.z;
+        pos->a[i] = p.a;
+        pos->b[i] = p.b;
+        pos->c[i] = p.c;
+        pos->u[i] = p.u;
+        pos->v[i] = p.v;
+        pos->w[i] = p.w;
+    }
+    return n;
+}
+
 KINEMATICS_TYPE kinematicsType(void)
 {
     return KINEMATICS_BOTH;
@@ -51,7 +117,9 @@ static vtkins_t vtk = {
     .kinematicsForward = kinematicsForward,
     .kinematicsInverse  = kinematicsInverse,
     // .kinematicsHome = kinematicsHome,
-    .kinematicsType = kinematicsType
+    .kinematicsType = kinematicsType,
+    .kinematicsForwardBatch = kinematicsForwardBatch,
+    .kinematicsInverseBatch = kinematicsInverseBatch,
 };
 
 static int comp_id, vtable_id;
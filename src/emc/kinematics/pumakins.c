@@ -24,7 +24,7 @@
 #include "rtapi_app.h"		/* RTAPI realtime module decls */
 #include "hal.h"
 
-#define VTVERSION VTKINEMATICS_VERSION1
+#define VTVERSION VTKINEMATICS_VERSION2
 
 struct haldata {
     hal_float_t *a2, *a3, *d3, *d4;
@@ -322,6 +322,62 @@ int kinematicsInverse(const EmcPose * world,
    return singular == 0 ? 0 : -1;
 }
 
+/* The batch versions gather each point and run the single point solution,
+   whose branches on the flags and the wrist singularity leave little for
+   the compiler to vectorize. The inverse takes the current wrist angle at
+   a singular point from the previous point's solution, or from the
+   joints passed in for the first point, as the single point version does. */
+int kinematicsForwardBatch(int n,
+                           double * const *joints,
+                           const EmcPoseBatch * world,
+                           const KINEMATICS_FORWARD_FLAGS * fflags,
+                           KINEMATICS_INVERSE_FLAGS * iflags)
+{
+   double joint[6];
+   EmcPose pos;
+   int i, k;
+
+   for (i = 0; i < n; i++) {
+      for (k = 0; k < 6; k++)
+         joint[k] = joints[k][i];
+      kinematicsForward(joint, &pos, fflags, iflags);
+      world->x[i] = pos.tran.x;
+      world->y[i] = pos.tran.y;
+      world->z[i] = pos.tran.z;
+      world->a[i] = pos.a;
+      world->b[i] = pos.b;
+      world->c[i] = pos.c;
+   }
+   return n;
+}
+
+int kinematicsInverseBatch(int n,
+                           const EmcPoseBatch * world,
+                           double * const *joints,
+                           const KINEMATICS_INVERSE_FLAGS * iflags,
+                           KINEMATICS_FORWARD_FLAGS * fflags)
+{
+   double joint[6];
+   EmcPose pos = {{0}};
+   int i, k;
+
+   if (n > 0)
+      joint[3] = joints[3][0];
+   for (i = 0; i < n; i++) {
+      pos.tran.x = world->x[i];
+      pos.tran.y = world->y[i];
+      pos.tran.z = world->z[i];
+      pos.a = world->a[i];
+      pos.b = world->b[i];
+      pos.c = world->c[i];
+      if (kinematicsInverse(&pos, joint, iflags, fflags))
+         return i;
+      for (k = 0; k < 6; k++)
+         joints[k][i] = joint[k];
+   }
+   return n;
+}
+
 int kinematicsHome(EmcPose * world,
                    double * joint,
                    KINEMATICS_FORWARD_FLAGS * fflags,
@@ -341,7 +397,9 @@ static vtkins_t vtk = {
     .kinematicsForward = kinematicsForward,
     .kinematicsInverse  = kinematicsInverse,
     // .kinematicsHome = kinematicsHome,
-    .kinematicsType = kinematicsType
+    .kinematicsType = kinematicsType,
+    .kinematicsForwardBatch = kinematicsForwardBatch,
+    .kinematicsInverseBatch = kinematicsInverseBatch,
 };
 
 static int comp_id, vtable_id;
@@ -23,7 +23,7 @@
 #include "rtapi_app.h"		/* RTAPI realtime module decls */
 #include "hal.h"
 
-#define VTVERSION VTKINEMATICS_VERSION1
+#define VTVERSION VTKINEMATICS_VERSION2
 
 #define DEFAULT_D1 490
 #define DEFAULT_D2 340
@@ -179,6 +179,75 @@ int kinematicsInverse(const EmcPose * world,
     return (0);
 }
 
+/* The batch versions follow the single point ones with the link lengths
+   read once. The elbow flag is the same for all points; the forward
+   batch reports it for the last point. */
+int kinematicsForwardBatch(int n,
+			   double * const *joint,
+			   const EmcPoseBatch * world,
+			   const KINEMATICS_FORWARD_FLAGS * fflags,
+			   KINEMATICS_INVERSE_FLAGS * iflags)
+{
+    double d2 = D2, d4 = D4, d6 = D6;
+    double z0 = D1 + D3 - D5;
+    int i;
+
+    for (i = 0; i < n; i++) {
+	double a0 = joint[0][i] * ( PM_PI / 180 );
+	double a1 = joint[1][i] * ( PM_PI / 180 ) + a0;
+	double a3 = joint[3][i] * ( PM_PI / 180 ) + a1;
+
+	world->x[i] = d2*rtapi_cos(a0) + d4*rtapi_cos(a1) + d6*rtapi_cos(a3);
+	world->y[i] = d2*rtapi_sin(a0) + d4*rtapi_sin(a1) + d6*rtapi_sin(a3);
+	world->z[i] = z0 - joint[2][i];
+	world->c[i] = a3 * 180 / PM_PI;
+	world->a[i] = joint[4][i];
+	world->b[i] = joint[5][i];
+    }
+
+    if (n > 0) {
+	*iflags = joint[1][n - 1] < 90 ? 1 : 0;
+    }
+    return n;
+}
+
+int kinematicsInverseBatch(int n,
+			   const EmcPoseBatch * world,
+			   double * const *joint,
+			   const KINEMATICS_INVERSE_FLAGS * iflags,
+			   KINEMATICS_FORWARD_FLAGS * fflags)
+{
+    double d2 = D2, d4 = D4, d6 = D6;
+    double z0 = D1 + D3 - D5;
+    double sign = *iflags ? -1.0 : 1.0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+	double a3 = world->c[i] * ( PM_PI / 180 );
+	double xt = world->x[i] - d6*rtapi_cos(a3);
+	double yt = world->y[i] - d6*rtapi_sin(a3);
+	double cc = (xt*xt + yt*yt - d2*d2 - d4*d4) / (2*d2*d4);
+	double q0, q1;
+
+	cc = rtapi_fmin(rtapi_fmax(cc, -1), 1);
+	q1 = sign * rtapi_acos(cc);
+	q0 = rtapi_atan2(yt, xt) -
+	    rtapi_atan2(d4*rtapi_sin(q1), d2 + d4*rtapi_cos(q1));
+
+	q0 = q0 * (180 / PM_PI);
+	q1 = q1 * (180 / PM_PI);
+	joint[0][i] = q0;
+	joint[1][i] = q1;
+	joint[2][i] = z0 - world->z[i];
+	joint[3][i] = world->c[i] - (q0 + q1);
+	joint[4][i] = world->a[i];
+	joint[5][i] = world->b[i];
+    }
+
+    *fflags = 0;
+    return n;
+}
+
 int kinematicsHome(EmcPose * world,
                    double * joint,
                    KINEMATICS_FORWARD_FLAGS * fflags,
@@ -198,7 +267,9 @@ static vtkins_t vtk = {
     .kinematicsForward = kinematicsForward,
     .kinematicsInverse  = kinematicsInverse,
     // .kinematicsHome = kinematicsHome,
-    .kinematicsType = kinematicsType
+    .kinematicsType = kinematicsType,
+    .kinematicsForwardBatch = kinematicsForwardBatch,
+    .kinematicsInverseBatch = kinematicsInverseBatch,
 };
 
 static int comp_id, vtable_id;
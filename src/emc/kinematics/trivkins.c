@@ -19,7 +19,7 @@
 #include "rtapi_app.h"		/* RTAPI realtime module decls */
 #include "hal.h"
 
-#define VTVERSION VTKINEMATICS_VERSION1
+#define VTVERSION VTKINEMATICS_VERSION2
 
 
 int kinematicsForward(const double *joints,
@@ -58,6 +58,53 @@ int kinematicsInverse(const EmcPose * pos,
     return 0;
 }
 
+static inline void copy_batch(double *dst, const double *src, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+	dst[i] = src[i];
+    }
+}
+
+int kinematicsForwardBatch(int n,
+			   double * const *joints,
+			   const EmcPoseBatch * pos,
+			   const KINEMATICS_FORWARD_FLAGS * fflags,
+			   KINEMATICS_INVERSE_FLAGS * iflags)
+{
+    copy_batch(pos->x, joints[0], n);
+    copy_batch(pos->y, joints[1], n);
+    copy_batch(pos->z, joints[2], n);
+    copy_batch(pos->a, joints[3], n);
+    copy_batch(pos->b, joints[4], n);
+    copy_batch(pos->c, joints[5], n);
+    copy_batch(pos->u, joints[6], n);
+    copy_batch(pos->v, joints[7], n);
+    copy_batch(pos->w, joints[8], n);
+
+    return n;
+}
+
+int kinematicsInverseBatch(int n,
+			   const EmcPoseBatch * pos,
+			   double * const *joints,
+			   const KINEMATICS_INVERSE_FLAGS * iflags,
+			   KINEMATICS_FORWARD_FLAGS * fflags)
+{
+    copy_batch(joints[0], pos->x, n);
+    copy_batch(joints[1], pos->y, n);
+    copy_batch(joints[2], pos->z, n);
+    copy_batch(joints[3], pos->a, n);
+    copy_batch(joints[4], pos->b, n);
+    copy_batch(joints[5], pos->c, n);
+    copy_batch(joints[6], pos->u, n);
+    copy_batch(joints[7], pos->v, n);
+    copy_batch(joints[8], pos->w, n);
+
+    return n;
+}
+
 /* implemented for these kinematics as giving joints preference */
 int kinematicsHome(EmcPose * world,
 		   double *joint,
@@ -81,7 +128,9 @@ static vtkins_t vtk = {
     .kinematicsForward = kinematicsForward,
     .kinematicsInverse  = kinematicsInverse,
     // .kinematicsHome = kinematicsHome,
-    .kinematicsType = kinematicsType
+    .kinematicsType = kinematicsType,
+    .kinematicsForwardBatch = kinematicsForwardBatch,
+    .kinematicsInverseBatch = kinematicsInverseBatch,
 };
 
 static int comp_id, vtable_id;
@@ -61,6 +61,7 @@
 #include <float.h>
 #include "posemath.h"
 #include "rtapi.h"
+#include "rtapi_string.h"	/* memcpy, memcmp */
 #include "hal.h"
 #include "hal_priv.h"
 #include "motion.h"
@@ -209,6 +210,113 @@ void refresh_jog_limits(emcmot_joint_t *joint)
     }
 }
 
+/* Inverse kinematics for the limit checks. Iterative kinematics (e.g.
+   genserkins) take the joint values passed in as their starting guess, so
+   each solve is seeded with the previous solution, which is close for
+   consecutive moves, and a position seen recently reuses its solution
+   outright. The controller's pause offset check and the command handler
+   share the cache, hence more than one entry.
+
+   A reused solution is only as good as the kinematics parameters it was
+   solved with, and those (genserkins.A-0 and the like) can be changed at
+   any time. It is checked with the forward kinematics before it is used,
+   and the cache is flushed if it does not map back to the position any
+   more, or if the kinematics type changed. It is also flushed when motion
+   is enabled. */
+#define IK_CACHE_SIZE 4
+#define IK_CACHE_FUZZ 1e-6
+
+static struct {
+    int valid;
+    EmcPose pos;
+    double joint_pos[EMCMOT_MAX_JOINTS];
+} ik_cache[IK_CACHE_SIZE];
+static int ik_cache_next = 0;	/* entry to replace next */
+static int ik_cache_last = -1;	/* most recent solution */
+static KINEMATICS_TYPE ik_cache_type = 0;	/* type the cache was filled with */
+
+void inRangeFlush(void)
+{
+    int n;
+
+    for (n = 0; n < IK_CACHE_SIZE; n++) {
+	ik_cache[n].valid = 0;
+    }
+    ik_cache_last = -1;
+}
+
+/* non-zero if joint_pos still solves pos */
+static int ik_cache_current(EmcPose const *pos, double const *joint_pos)
+{
+    EmcPose fwd = *pos;
+
+    if (emcmotConfig->vtk->kinematicsForward(joint_pos, &fwd,
+					     &fflags, &iflags)) {
+	return 0;
+    }
+    return rtapi_fabs(fwd.tran.x - pos->tran.x) < IK_CACHE_FUZZ &&
+	rtapi_fabs(fwd.tran.y - pos->tran.y) < IK_CACHE_FUZZ &&
+	rtapi_fabs(fwd.tran.z - pos->tran.z) < IK_CACHE_FUZZ &&
+	rtapi_fabs(fwd.a - pos->a) < IK_CACHE_FUZZ &&
+	rtapi_fabs(fwd.b - pos->b) < IK_CACHE_FUZZ &&
+	rtapi_fabs(fwd.c - pos->c) < IK_CACHE_FUZZ &&
+	rtapi_fabs(fwd.u - pos->u) < IK_CACHE_FUZZ &&
+	rtapi_fabs(fwd.v - pos->v) < IK_CACHE_FUZZ &&
+	rtapi_fabs(fwd.w - pos->w) < IK_CACHE_FUZZ;
+}
+
+static void cachedInverse(EmcPose const *pos, double *joint_pos)
+{
+    KINEMATICS_TYPE type = emcmotConfig->vtk->kinematicsType();
+    int n, joint_num;
+
+    if (type != ik_cache_type) {
+	inRangeFlush();
+	ik_cache_type = type;
+    }
+
+    for (n = 0; n < IK_CACHE_SIZE && type != KINEMATICS_INVERSE_ONLY; n++) {
+	if (ik_cache[n].valid &&
+	    !memcmp(&ik_cache[n].pos, pos, sizeof(EmcPose))) {
+	    if (!ik_cache_current(pos, ik_cache[n].joint_pos)) {
+		/* the kinematics parameters changed */
+		inRangeFlush();
+		break;
+	    }
+	    memcpy(joint_pos, ik_cache[n].joint_pos,
+		   num_joints * sizeof(double));
+	    ik_cache_last = n;
+	    return;
+	}
+    }
+
+    /* warm start from the last solution, if any */
+    for (joint_num = 0; joint_num < num_joints; joint_num++) {
+	joint_pos[joint_num] = ik_cache_last < 0 ? 0.0 :
+	    ik_cache[ik_cache_last].joint_pos[joint_num];
+    }
+    if (emcmotConfig->vtk->kinematicsInverse(pos, joint_pos, &iflags, &fflags)) {
+	if (ik_cache_last < 0) {
+	    return;
+	}
+	/* did not converge from there, retry from zero as before */
+	for (joint_num = 0; joint_num < num_joints; joint_num++) {
+	    joint_pos[joint_num] = 0.0;
+	}
+	if (emcmotConfig->vtk->kinematicsInverse(pos, joint_pos,
+						  &iflags, &fflags)) {
+	    return;
+	}
+    }
+
+    n = ik_cache_next;
+    ik_cache_next = (ik_cache_next + 1) % IK_CACHE_SIZE;
+    ik_cache[n].pos = *pos;
+    memcpy(ik_cache[n].joint_pos, joint_pos, num_joints * sizeof(double));
+    ik_cache[n].valid = 1;
+    ik_cache_last = n;
+}
+
 /* inRange() returns non-zero if the position lies within the joint
    limits, or 0 if not.  It also reports an error for each joint limit
    violation.  It's possible to get more than one violation per move.
@@ -221,13 +329,7 @@ int inRange(EmcPose pos, int id, char *move_type)
     emcmot_joint_t *joint;
     int in_range = 1;
 
-    /* fill in all joints with 0 */
-    for (joint_num = 0; joint_num < num_joints; joint_num++) {
-	joint_pos[joint_num] = 0.0;
-    }
-
-    /* now fill in with real values, for joints that are used */
-    emcmotConfig->vtk->kinematicsInverse(&pos, joint_pos, &iflags, &fflags);
+    cachedInverse(&pos, joint_pos);
 
     for (joint_num = 0; joint_num < num_joints; joint_num++) {
 	/* point to joint data */
@@ -295,6 +397,81 @@ hal_bit_t emcmotGetRotaryIsUnlocked(int axis) {
     return *(emcmot_hal_data->joint[axis].is_unlocked);
 }
 
+/* upcalls for the TP when it limits segments by joint velocity and
+   acceleration; joint_pos holds the starting guess on entry */
+int emcmotKinsInverse(EmcPose const * const pos, double * const joint_pos)
+{
+    return emcmotConfig->vtk->kinematicsInverse(pos, joint_pos, &iflags, &fflags);
+}
+
+/* The same for an auxiliary planner. Its poses only hold the axes it
+   drives, the others are taken from the commanded position, so the
+   joint limits it plans by are those of a pose the machine can be in. */
+static int emcmotAuxKinsInverse(int n, EmcPose const * const pos,
+				double * const joint_pos)
+{
+    EmcPose merged = emcmotStatus->carte_pos_cmd;
+
+    emcmotAuxMergePose(emcmotStatus->aux[n].axis_mask, pos, &merged);
+    return emcmotKinsInverse(&merged, joint_pos);
+}
+
+#if EMCMOT_MAX_AUX_PLANNERS != 4
+#error "one emcmotAuxKinsInverse upcall per auxiliary planner"
+#endif
+static int emcmotAux1KinsInverse(EmcPose const * const pos, double * const joint_pos)
+{
+    return emcmotAuxKinsInverse(0, pos, joint_pos);
+}
+static int emcmotAux2KinsInverse(EmcPose const * const pos, double * const joint_pos)
+{
+    return emcmotAuxKinsInverse(1, pos, joint_pos);
+}
+static int emcmotAux3KinsInverse(EmcPose const * const pos, double * const joint_pos)
+{
+    return emcmotAuxKinsInverse(2, pos, joint_pos);
+}
+static int emcmotAux4KinsInverse(EmcPose const * const pos, double * const joint_pos)
+{
+    return emcmotAuxKinsInverse(3, pos, joint_pos);
+}
+
+int (*emcmotAuxKinsInverses[EMCMOT_MAX_AUX_PLANNERS])(EmcPose const * const pos,
+						   double * const joint_pos) = {
+    emcmotAux1KinsInverse, emcmotAux2KinsInverse,
+    emcmotAux3KinsInverse, emcmotAux4KinsInverse
+};
+
+/* Inverse kinematics of n points in structure of arrays layout, see
+   kinematics.h; only handed to the TP when the kinematics module has the
+   batch entry. Returns the number of leading points solved. */
+int emcmotKinsInverseBatch(int n, EmcPoseBatch const * const pos,
+			   double * const * const joint_pos)
+{
+    return emcmotConfig->vtk->kinematicsInverseBatch(n, pos, joint_pos,
+						     &iflags, &fflags);
+}
+
+int emcmotGetJointLimits(double * const vel_limit, double * const acc_limit,
+			 double * const pos_cmd)
+{
+    int joint_num;
+    emcmot_joint_t *joint;
+
+    for (joint_num = 0; joint_num < num_joints; joint_num++) {
+	joint = &joints[joint_num];
+	pos_cmd[joint_num] = joint->pos_cmd;
+	if (!GET_JOINT_ACTIVE_FLAG(joint)) {
+	    vel_limit[joint_num] = 0.0;
+	    acc_limit[joint_num] = 0.0;
+	    continue;
+	}
+	vel_limit[joint_num] = joint->vel_limit;
+	acc_limit[joint_num] = joint->acc_limit;
+    }
+    return num_joints;
+}
+
 /*! \function emcmotDioWrite()
 
   sets or clears a HAL DIO pin, 
@@ -375,6 +552,93 @@ int abort_and_switchback(void)
     return emcmotConfig->vtp->tpAbort(emcmotQueue);
 }
 
+/* Copy the axes in mask, bit 0 = X .. bit 8 = W, from one pose to
+   another. */
+void emcmotAuxMergePose(int mask, EmcPose const *from, EmcPose *to)
+{
+    if (mask & 0x001) to->tran.x = from->tran.x;
+    if (mask & 0x002) to->tran.y = from->tran.y;
+    if (mask & 0x004) to->tran.z = from->tran.z;
+    if (mask & 0x008) to->a = from->a;
+    if (mask & 0x010) to->b = from->b;
+    if (mask & 0x020) to->c = from->c;
+    if (mask & 0x040) to->u = from->u;
+    if (mask & 0x080) to->v = from->v;
+    if (mask & 0x100) to->w = from->w;
+}
+
+#define AUX_AXIS_FUZZ 1e-6
+
+/* auxAxesKept() returns non-zero if a move of the main planner to pos
+   leaves the axes driven by auxiliary planners where the main planner
+   last had them, or 0 if not, reporting an error. Their position is the
+   auxiliary planners' to command, so the main program may not move them. */
+static int auxAxesKept(EmcPose const *pos, int id, char *move_type)
+{
+    EmcPose goal = emcmotDebug->tp.goalPos, moved = goal;
+    int mask = 0, n;
+
+    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+	mask |= emcmotStatus->aux[n].axis_mask;
+    }
+    if (mask == 0) {
+	return 1;
+    }
+    emcmotAuxMergePose(mask, pos, &moved);
+    if (rtapi_fabs(moved.tran.x - goal.tran.x) < AUX_AXIS_FUZZ &&
+	rtapi_fabs(moved.tran.y - goal.tran.y) < AUX_AXIS_FUZZ &&
+	rtapi_fabs(moved.tran.z - goal.tran.z) < AUX_AXIS_FUZZ &&
+	rtapi_fabs(moved.a - goal.a) < AUX_AXIS_FUZZ &&
+	rtapi_fabs(moved.b - goal.b) < AUX_AXIS_FUZZ &&
+	rtapi_fabs(moved.c - goal.c) < AUX_AXIS_FUZZ &&
+	rtapi_fabs(moved.u - goal.u) < AUX_AXIS_FUZZ &&
+	rtapi_fabs(moved.v - goal.v) < AUX_AXIS_FUZZ &&
+	rtapi_fabs(moved.w - goal.w) < AUX_AXIS_FUZZ) {
+	return 1;
+    }
+    reportError(_("%s move on line %d would move axes 0x%x, which auxiliary planners drive"),
+		move_type, id, mask);
+    return 0;
+}
+
+/* Preset the auxiliary planners to the commanded position, as is done
+   for the main planner whenever coordinated motion starts. An auxiliary
+   planner keeps the axes it does not drive at zero. */
+void emcmotAuxSetPos(EmcPose const *pos)
+{
+    emcmot_aux_status_t *aux;
+    int n;
+
+    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+	aux = &emcmotStatus->aux[n];
+	ZERO_EMC_POSE(aux->pos);
+	emcmotAuxMergePose(aux->axis_mask, pos, &aux->pos);
+	emcmotConfig->vtp->tpClear(&emcmotDebug->auxqueue[n]);
+	emcmotConfig->vtp->tpSetPos(&emcmotDebug->auxqueue[n], &aux->pos);
+    }
+}
+
+void emcmotAuxAbortAll(void)
+{
+    int n;
+
+    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+	emcmotConfig->vtp->tpAbort(&emcmotDebug->auxqueue[n]);
+    }
+}
+
+int emcmotAuxDone(void)
+{
+    int n;
+
+    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+	if (!emcmotStatus->aux[n].done) {
+	    return 0;
+	}
+    }
+    return 1;
+}
+
 /*
   emcmotCommandHandler() is called each main cycle to read the
   shared memory buffer
@@ -385,6 +649,10 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
     int joint_num;
     int n;
     emcmot_joint_t *joint;
+    emcmot_aux_status_t *aux;
+    TP_STRUCT *aux_tp;
+    EmcPose aux_pos;
+    int aux_axes;
     double tmp1;
     emcmot_comp_entry_t *comp_entry;
     char issue_atspeed = 0;
@@ -393,8 +661,7 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
     check_stuff ( "before command_handler()" );
 
     if (once) {
-	setServoCycleTime(period * 1e-9);
-	setTrajCycleTime((traj_period_nsec == 0) ? period * 1e-9 : traj_period_nsec);
+	emcmotSetCycleTime(period);
 	once = 0;
     }
 
@@ -430,6 +697,16 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 	    /* bad joint number */
 	    joint = 0;
 	}
+	/* likewise "command->planner" for the auxiliary planner commands,
+	   which count from 1 */
+	n = emcmotCommand->planner - 1;
+	if (n >= 0 && n < emcmotStatus->num_aux_planners) {
+	    aux = &emcmotStatus->aux[n];
+	    aux_tp = &emcmotDebug->auxqueue[n];
+	} else {
+	    aux = 0;
+	    aux_tp = 0;
+	}
 
 /* printing of commands for troubleshooting */
 	rtapi_print_msg(RTAPI_MSG_DBG, "%d: CMD %d, code %3d ", emcmotStatus->heartbeat,
@@ -452,6 +729,7 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
                 ZERO_EMC_POSE(emcmotDebug->teleop_data.desiredVel);
 	    } else if (GET_MOTION_COORD_FLAG()) {
 		abort_and_switchback();
+		emcmotAuxAbortAll();
 	    } else {
 		for (joint_num = 0; joint_num < num_joints; joint_num++) {
 		    /* point to joint struct */
@@ -588,6 +866,13 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 	    if (joint == 0) {
 		break;
 	    }
+	    if (emcmotCommand->home_group < 0 ||
+		emcmotCommand->home_group >= EMCMOT_MAX_JOINTS) {
+		reportError(_("joint %d: home group must be 0 to %d"),
+		    joint_num, EMCMOT_MAX_JOINTS - 1);
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		break;
+	    }
 	    *(joint->home_offset) = emcmotCommand->offset;
 	    *(joint->home) = emcmotCommand->home;
 	    joint->home_final_vel = emcmotCommand->home_final_vel;
@@ -595,6 +880,8 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 	    joint->home_latch_vel = emcmotCommand->latch_vel;
 	    joint->home_flags = emcmotCommand->flags;
 	    joint->home_sequence = emcmotCommand->home_sequence;
+	    joint->home_group = emcmotCommand->home_group;
+	    joint->home_search_jerk = emcmotCommand->search_jerk;
 	    joint->volatile_home = emcmotCommand->volatile_home;
 	    break;
 
@@ -924,6 +1211,11 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 		abort_and_switchback(); // tpAbort(emcmotQueue);
 		SET_MOTION_ERROR_FLAG(1);
 		break;
+	    } else if (!auxAxesKept(&emcmotCommand->pos, emcmotCommand->id, "Linear")) {
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		abort_and_switchback(); // tpAbort(emcmotQueue);
+		SET_MOTION_ERROR_FLAG(1);
+		break;
 	    } else if (!limits_ok()) {
 		reportError(_("can't do linear move with limits exceeded"));
 		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
@@ -940,6 +1232,7 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
             }
 	    /* append it to the emcmotDebug->tp */
 	    emcmotConfig->vtp->tpSetId(&emcmotDebug->tp, emcmotCommand->id);
+	    emcmotConfig->vtp->tpSetPlannedVel(&emcmotDebug->tp, emcmotCommand->planned_vel);
 	    int res_addline = emcmotConfig->vtp->tpAddLine(&emcmotDebug->tp,
 							   emcmotCommand->pos,
 							   emcmotCommand->motion_type,
@@ -987,6 +1280,11 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
 		abort_and_switchback(); // tpAbort(emcmotQueue);
 
+		SET_MOTION_ERROR_FLAG(1);
+		break;
+	    } else if (!auxAxesKept(&emcmotCommand->pos, emcmotCommand->id, "Circular")) {
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		abort_and_switchback(); // tpAbort(emcmotQueue);
 		SET_MOTION_ERROR_FLAG(1);
 		break;
 	    } else if (!limits_ok()) {
@@ -1003,6 +1301,7 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
             }
 	    /* append it to the emcmotDebug->queue */
 	    emcmotConfig->vtp->tpSetId(emcmotQueue, emcmotCommand->id);
+	    emcmotConfig->vtp->tpSetPlannedVel(emcmotQueue, emcmotCommand->planned_vel);
 
 	    int res_addcircle = 
 		emcmotConfig->vtp->tpAddCircle(emcmotQueue, emcmotCommand->pos,
@@ -1043,6 +1342,11 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 	    emcmotStatus->vel = emcmotCommand->vel;
 	    emcmotConfig->vtp->tpSetVmax(emcmotPrimQueue, emcmotStatus->vel,
 					 emcmotCommand->ini_maxvel);
+	    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+		emcmotConfig->vtp->tpSetVmax(&emcmotDebug->auxqueue[n],
+					     emcmotStatus->vel,
+					     emcmotCommand->ini_maxvel);
+	    }
 	    break;
 
 	case EMCMOT_SET_VEL_LIMIT:
@@ -1052,6 +1356,10 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 	    /* can do it at any time */
 	    emcmotConfig->limitVel = emcmotCommand->vel;
 	    emcmotConfig->vtp->tpSetVlimit(emcmotPrimQueue, emcmotConfig->limitVel);
+	    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+		emcmotConfig->vtp->tpSetVlimit(&emcmotDebug->auxqueue[n],
+					       emcmotConfig->limitVel);
+	    }
 	    break;
 
 	case EMCMOT_SET_JOINT_VEL_LIMIT:
@@ -1083,6 +1391,10 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 	    rtapi_print_msg(RTAPI_MSG_DBG, "SET_ACCEL");
 	    emcmotStatus->acc = emcmotCommand->acc;
 	    emcmotConfig->vtp->tpSetAmax(emcmotPrimQueue, emcmotStatus->acc);
+	    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+		emcmotConfig->vtp->tpSetAmax(&emcmotDebug->auxqueue[n],
+					     emcmotStatus->acc);
+	    }
 	    break;
 
 	case EMCMOT_PAUSE:
@@ -1229,6 +1541,7 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 		reportError(_("can't enable motion, enable input is false"));
 	    } else {
 		emcmotDebug->enabling = 1;
+		inRangeFlush();
 		if (kinType == KINEMATICS_INVERSE_ONLY) {
 		    emcmotDebug->teleoperating = 0;
 		    emcmotDebug->coordinating = 0;
@@ -1433,6 +1746,11 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 		abort_and_switchback(); // tpAbort(emcmotQueue);
 		SET_MOTION_ERROR_FLAG(1);
 		break;
+	    } else if (!auxAxesKept(&emcmotCommand->pos, emcmotCommand->id, "Probe")) {
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		abort_and_switchback(); // tpAbort(emcmotQueue);
+		SET_MOTION_ERROR_FLAG(1);
+		break;
 	    } else if (!limits_ok()) {
 		reportError(_("can't do probe move with limits exceeded"));
 		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
@@ -1503,6 +1821,11 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
 		abort_and_switchback(); // tpAbort(emcmotQueue);
 
+		SET_MOTION_ERROR_FLAG(1);
+		break;
+	    } else if (!auxAxesKept(&emcmotCommand->pos, emcmotCommand->id, "Rigid tap")) {
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		abort_and_switchback(); // tpAbort(emcmotQueue);
 		SET_MOTION_ERROR_FLAG(1);
 		break;
 	    } else if (!limits_ok()) {
@@ -1706,7 +2029,7 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 	    if (joint == 0) {
 		break;
 	    }
-	    if (joint->comp.entries >= EMCMOT_COMP_SIZE) {
+	    if (joint->comp.entries >= joint->comp.size) {
 		reportError(_("joint %d: too many compensation entries"), joint_num);
 		break;
 	    }
@@ -1736,9 +2059,166 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
 	    joint->comp.entries++;
 	    break;
 
-        case EMCMOT_SET_OFFSET:
-            emcmotStatus->tool_offset = emcmotCommand->tool_offset;
-            break;
+	case EMCMOT_SET_OFFSET:
+	    emcmotStatus->tool_offset = emcmotCommand->tool_offset;
+	    break;
+
+	case EMCMOT_SET_VOL_COMP_GRID:
+	    rtapi_print_msg(RTAPI_MSG_DBG, "SET_VOL_COMP_GRID");
+	    /* starts a new grid, the points follow */
+	    emcmotVolComp.enabled = 0;
+	    emcmotVolComp.loaded = 0;
+	    emcmotVolComp.points = 0;
+	    for (n = 0; n < 3; n++) {
+		if (emcmotCommand->vol_count[n] < 1) {
+		    break;
+		}
+	    }
+	    if (n < 3 || emcmotCommand->vol_step.x <= 0.0 ||
+		emcmotCommand->vol_step.y <= 0.0 || emcmotCommand->vol_step.z <= 0.0) {
+		reportError(_("volumetric compensation: bad grid"));
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		break;
+	    }
+	    if ((long) emcmotCommand->vol_count[0] * emcmotCommand->vol_count[1] *
+		emcmotCommand->vol_count[2] > emcmotVolComp.size) {
+		reportError(_("volumetric compensation: grid has more than %d points, raise motmod vol_comp_size"),
+			    emcmotVolComp.size);
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		break;
+	    }
+	    emcmotVolComp.origin[0] = emcmotCommand->vol_origin.x;
+	    emcmotVolComp.origin[1] = emcmotCommand->vol_origin.y;
+	    emcmotVolComp.origin[2] = emcmotCommand->vol_origin.z;
+	    emcmotVolComp.step[0] = emcmotCommand->vol_step.x;
+	    emcmotVolComp.step[1] = emcmotCommand->vol_step.y;
+	    emcmotVolComp.step[2] = emcmotCommand->vol_step.z;
+	    for (n = 0; n < 3; n++) {
+		emcmotVolComp.count[n] = emcmotCommand->vol_count[n];
+		emcmotVolComp.inv_step[n] = 1.0 / emcmotVolComp.step[n];
+	    }
+	    emcmotVolComp.points = emcmotVolComp.count[0] *
+		emcmotVolComp.count[1] * emcmotVolComp.count[2];
+	    break;
+
+	case EMCMOT_SET_VOL_COMP_POINTS:
+	    /* points must be sent in order, the grid is enabled by the last one */
+	    if (emcmotVolComp.points == 0 ||
+		emcmotCommand->vol_index != emcmotVolComp.loaded ||
+		emcmotCommand->vol_points < 1 ||
+		emcmotCommand->vol_points > EMCMOT_VOL_COMP_BATCH ||
+		emcmotCommand->vol_points > emcmotVolComp.points - emcmotVolComp.loaded) {
+		reportError(_("volumetric compensation: unexpected points %d..%d"),
+			    emcmotCommand->vol_index,
+			    emcmotCommand->vol_index + emcmotCommand->vol_points - 1);
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		break;
+	    }
+	    for (n = 0; n < emcmotCommand->vol_points; n++) {
+		emcmotVolComp.trim[emcmotVolComp.loaded++] = emcmotCommand->vol_trim[n];
+	    }
+	    if (emcmotVolComp.loaded == emcmotVolComp.points) {
+		emcmotVolComp.enabled = 1;
+	    }
+	    break;
+
+	case EMCMOT_SET_AUX_PLANNER:
+	    /* assign axes to an auxiliary planner */
+	    /* only while it and the main planner are idle, since the
+	       axes change hands */
+	    rtapi_print_msg(RTAPI_MSG_DBG, "SET_AUX_PLANNER");
+	    rtapi_print_msg(RTAPI_MSG_DBG, " %d 0x%x", emcmotCommand->planner,
+			    emcmotCommand->axis_mask);
+	    if (aux == 0) {
+		reportError(_("no auxiliary planner %d"), emcmotCommand->planner);
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		break;
+	    }
+	    if (!aux->done || emcmotStatus->depth ||
+		!emcmotConfig->vtp->tpIsDone(emcmotQueue)) {
+		reportError(_("can't assign axes to auxiliary planner %d while moving"),
+			    emcmotCommand->planner);
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_COMMAND;
+		break;
+	    }
+	    aux_axes = 0;
+	    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+		if (&emcmotStatus->aux[n] != aux) {
+		    aux_axes |= emcmotStatus->aux[n].axis_mask;
+		}
+	    }
+	    if ((emcmotCommand->axis_mask & ~0x1ff) ||
+		(emcmotCommand->axis_mask & aux_axes)) {
+		reportError(_("axes 0x%x are invalid or driven by another auxiliary planner"),
+			    emcmotCommand->axis_mask);
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		break;
+	    }
+	    aux->axis_mask = emcmotCommand->axis_mask;
+	    /* the main planner takes back any axes released */
+	    emcmotConfig->vtp->tpSetPos(emcmotQueue, &emcmotStatus->carte_pos_cmd);
+	    ZERO_EMC_POSE(aux->pos);
+	    emcmotAuxMergePose(aux->axis_mask, &emcmotStatus->carte_pos_cmd,
+			       &aux->pos);
+	    emcmotConfig->vtp->tpClear(aux_tp);
+	    emcmotConfig->vtp->tpSetPos(aux_tp, &aux->pos);
+	    break;
+
+	case EMCMOT_AUX_LINE:
+	    /* queue a linear move on an auxiliary planner, which only
+	       takes the axes it drives from pos */
+	    /* requires coordinated mode, enable on */
+	    rtapi_print_msg(RTAPI_MSG_DBG, "AUX_LINE");
+	    rtapi_print_msg(RTAPI_MSG_DBG, " %d", emcmotCommand->planner);
+	    if (aux == 0 || aux->axis_mask == 0) {
+		reportError(_("no auxiliary planner %d, or it drives no axes"),
+			    emcmotCommand->planner);
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		break;
+	    }
+	    if (!GET_MOTION_COORD_FLAG() || !GET_MOTION_ENABLE_FLAG()) {
+		reportError
+		    (_("need to be enabled, in coord mode for auxiliary move"));
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_COMMAND;
+		break;
+	    }
+	    aux_pos = emcmotStatus->carte_pos_cmd;
+	    emcmotAuxMergePose(aux->axis_mask, &emcmotCommand->pos, &aux_pos);
+	    if (!inRange(aux_pos, emcmotCommand->id, "Auxiliary linear")) {
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		emcmotConfig->vtp->tpAbort(aux_tp);
+		break;
+	    }
+	    ZERO_EMC_POSE(aux_pos);
+	    emcmotAuxMergePose(aux->axis_mask, &emcmotCommand->pos, &aux_pos);
+	    emcmotConfig->vtp->tpSetId(aux_tp, emcmotCommand->id);
+	    if (emcmotConfig->vtp->tpAddLine(aux_tp, aux_pos,
+					     emcmotCommand->motion_type,
+					     emcmotCommand->vel,
+					     emcmotCommand->ini_maxvel,
+					     emcmotCommand->acc,
+					     emcmotStatus->enables_new, 0, -1,
+					     emcmotCommand->tag)) {
+		reportError(_("can't add auxiliary linear move %d"),
+			    emcmotCommand->id);
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_BAD_EXEC;
+		emcmotConfig->vtp->tpAbort(aux_tp);
+		break;
+	    }
+	    rehomeAll = 1;
+	    break;
+
+	case EMCMOT_AUX_ABORT:
+	    /* abort an auxiliary planner, leaving the main one running */
+	    /* can happen at any time */
+	    rtapi_print_msg(RTAPI_MSG_DBG, "AUX_ABORT");
+	    rtapi_print_msg(RTAPI_MSG_DBG, " %d", emcmotCommand->planner);
+	    if (aux_tp == 0) {
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		break;
+	    }
+	    emcmotConfig->vtp->tpAbort(aux_tp);
+	    break;
 
 	default:
 	    rtapi_print_msg(RTAPI_MSG_DBG, "UNKNOWN");
@@ -1755,6 +2235,8 @@ int emcmotCommandHandler(void *arg, const hal_funct_args_t *fa)
             emcmotConfig->arcBlendGapCycles = emcmotCommand->arcBlendGapCycles;
             emcmotConfig->arcBlendRampFreq = emcmotCommand->arcBlendRampFreq;
             emcmotConfig->arcBlendTangentKinkRatio = emcmotCommand->arcBlendTangentKinkRatio;
+            emcmotConfig->segmentMergeEnable = emcmotCommand->segmentMergeEnable;
+            emcmotConfig->jointLimitSamples = emcmotCommand->jointLimitSamples;
             break;
 
 	}			/* end of: command switch */
@@ -210,6 +210,18 @@ static void output_to_hal(void);
 */
 static void update_status(void);
 
+/* 'stage_done()' records how long a stage of the servo cycle took,
+   if motion.servo.stage-timing is set.  It returns the timestamp to
+   pass as 'start' for the next stage (0 when timing is disabled).
+*/
+static long long int stage_done(enum servo_stage stage, long long int start);
+
+/* 'stage_hist_update()' clears the stage histograms when timing is
+   switched on, and recomputes the 99th percentile param of one stage
+   per cycle from its histogram.
+*/
+static void stage_hist_update(void);
+
 
 /***********************************************************************
 *                        PUBLIC FUNCTION CODE                          *
@@ -248,6 +260,7 @@ extern int emcmotController(void *arg,  const hal_funct_args_t *fa)
     static int priming = 1;
 
     long long int now = fa_start_time(fa);
+    long long int stage_start;
     long int this_run = (long int)(now - last);
     emcmot_hal_data->last_period = this_run;
 #ifdef HAVE_CPU_KHZ
@@ -314,30 +327,41 @@ extern int emcmotController(void *arg,  const hal_funct_args_t *fa)
     emcmotStatus->head++;
     /* here begins the core of the controller */
 
+    stage_start = emcmot_hal_data->stage_timing ? rtapi_get_clocks() : 0;
 check_stuff ( "before process_inputs()" );
     process_inputs();
+    stage_start = stage_done(SS_INPUTS, stage_start);
 check_stuff ( "after process_inputs()" );
     do_forward_kins();
+    stage_start = stage_done(SS_FWD_KINS, stage_start);
 check_stuff ( "after do_forward_kins()" );
     process_probe_inputs();
 check_stuff ( "after process_probe_inputs()" );
     check_for_faults();
 check_stuff ( "after check_for_faults()" );
     set_operating_mode();
+    stage_start = stage_done(SS_FAULTS, stage_start);
 check_stuff ( "after set_operating_mode()" );
     handle_jogwheels();
+    stage_start = stage_done(SS_JOGWHEELS, stage_start);
 check_stuff ( "after handle_jogwheels()" );
     do_homing_sequence();
 check_stuff ( "after do_homing_sequence()" );
     do_homing();
+    stage_start = stage_done(SS_HOMING, stage_start);
 check_stuff ( "after do_homing()" );
     get_pos_cmds(period);
+    stage_start = stage_done(SS_POS_CMDS, stage_start);
 check_stuff ( "after get_pos_cmds()" );
     compute_screw_comp();
+    stage_start = stage_done(SS_SCREW_COMP, stage_start);
 check_stuff ( "after compute_screw_comp()" );
     output_to_hal();
+    stage_start = stage_done(SS_OUTPUT, stage_start);
 check_stuff ( "after output_to_hal()" );
     update_status();
+    stage_done(SS_STATUS, stage_start);
+    stage_hist_update();
 check_stuff ( "after update_status()" );
     /* here ends the core of the controller */
     emcmotStatus->heartbeat++;
@@ -359,6 +383,71 @@ check_stuff ( "after update_status()" );
    prototypes"
 */
 
+static long long int stage_done(enum servo_stage stage, long long int start)
+{
+    long long int now;
+    hal_u32_t t;
+    int bin;
+
+    if (!emcmot_hal_data->stage_timing) {
+	return 0;
+    }
+    now = rtapi_get_clocks();
+    /* timing may have been enabled part way through this cycle */
+    if (start == 0) {
+	return now;
+    }
+    t = (hal_u32_t)(now - start);
+    emcmot_hal_data->stage_time[stage] = t;
+    if (t > emcmot_hal_data->stage_tmax[stage]) {
+	emcmot_hal_data->stage_tmax[stage] = t;
+    }
+    /* bin n counts times of 2^n up to 2^(n+1)-1 clocks */
+    for (bin = 0; (t >>= 1) && bin < EMCMOT_STAGE_HIST_BINS - 1; bin++);
+    emcmotDebug->stageHist[stage][bin]++;
+    return now;
+}
+
+static void stage_hist_update(void)
+{
+    static int timing = 0;
+    static int stage = 0;
+    unsigned int *hist;
+    unsigned int total, sum;
+    int n, bin;
+
+    if (!emcmot_hal_data->stage_timing) {
+	timing = 0;
+	return;
+    }
+    if (!timing) {
+	for (n = 0; n < EMCMOT_NUM_STAGES; n++) {
+	    for (bin = 0; bin < EMCMOT_STAGE_HIST_BINS; bin++) {
+		emcmotDebug->stageHist[n][bin] = 0;
+	    }
+	    emcmot_hal_data->stage_p99[n] = 0;
+	}
+	timing = 1;
+	return;
+    }
+
+    hist = emcmotDebug->stageHist[stage];
+    total = 0;
+    for (bin = 0; bin < EMCMOT_STAGE_HIST_BINS; bin++) {
+	total += hist[bin];
+    }
+    sum = 0;
+    for (bin = 0; bin < EMCMOT_STAGE_HIST_BINS - 1; bin++) {
+	sum += hist[bin];
+	if (sum >= total - total / 100) {
+	    break;
+	}
+    }
+    /* the top of the bin, see stage_done() */
+    emcmot_hal_data->stage_p99[stage] = total ? (2u << bin) - 1 : 0;
+    stage = (stage + 1) % EMCMOT_NUM_STAGES;
+}
+
 static void process_probe_inputs(void) {
     static int old_probeVal = 0;
     unsigned char probe_type = emcmotStatus->probe_type;
@@ -1017,6 +1106,7 @@ static void set_operating_mode(void)
     if (!emcmotDebug->enabling && GET_MOTION_ENABLE_FLAG()) {
 	/* clear out the motion emcmotDebug->queue and interpolators */
 	emcmotConfig->vtp->tpClear(emcmotQueue);
+	emcmotAuxSetPos(&emcmotStatus->carte_pos_cmd);
 	for (joint_num = 0; joint_num < num_joints; joint_num++) {
 	    /* point to joint data */
 	    joint = &joints[joint_num];
@@ -1049,6 +1139,7 @@ static void set_operating_mode(void)
     /* check for emcmotDebug->enabling */
     if (emcmotDebug->enabling && !GET_MOTION_ENABLE_FLAG()) {
 	emcmotConfig->vtp->tpSetPos(emcmotQueue, &emcmotStatus->carte_pos_cmd);
+	emcmotAuxSetPos(&emcmotStatus->carte_pos_cmd);
 	for (joint_num = 0; joint_num < num_joints; joint_num++) {
 	    /* point to joint data */
 	    joint = &joints[joint_num];
@@ -1070,7 +1161,9 @@ static void set_operating_mode(void)
 
     /* check for entering teleop mode */
     if (emcmotDebug->teleoperating && !GET_MOTION_TELEOP_FLAG()) {
-	if (GET_MOTION_INPOS_FLAG()) {
+	/* auxiliary planners only run in coordinated mode, so let them
+	   finish first */
+	if (GET_MOTION_INPOS_FLAG() && emcmotAuxDone()) {
 
 	    /* update coordinated emcmotDebug->queue position */
 	    emcmotConfig->vtp->tpSetPos(emcmotQueue, &emcmotStatus->carte_pos_cmd);
@@ -1113,6 +1206,7 @@ static void set_operating_mode(void)
 	    if (GET_MOTION_INPOS_FLAG()) {
 		/* preset traj planner to current position */
 		emcmotConfig->vtp->tpSetPos(emcmotQueue, &emcmotStatus->carte_pos_cmd);
+		emcmotAuxSetPos(&emcmotStatus->carte_pos_cmd);
 
 		/* drain the cubics so they'll synch up */
 		for (joint_num = 0; joint_num < num_joints; joint_num++) {
@@ -1134,7 +1228,7 @@ static void set_operating_mode(void)
 
 	/* check entering free space mode */
 	if (!emcmotDebug->coordinating && GET_MOTION_COORD_FLAG()) {
-	    if (GET_MOTION_INPOS_FLAG()) {
+	    if (GET_MOTION_INPOS_FLAG() && emcmotAuxDone()) {
 		for (joint_num = 0; joint_num < num_joints; joint_num++) {
 		    /* point to joint data */
 		    joint = &joints[joint_num];
@@ -1273,6 +1367,25 @@ static void handle_jogwheels(void)
     }
 }
 
+/* Run one cycle of each auxiliary planner and let it override the axes
+   it drives in the commanded position of the main planner. */
+static void run_aux_planners(long period)
+{
+    emcmot_aux_status_t *aux;
+    int n;
+
+    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+	aux = &emcmotStatus->aux[n];
+	if (aux->axis_mask == 0) {
+	    continue;
+	}
+	emcmotConfig->vtp->tpRunCycle(&emcmotDebug->auxqueue[n], period);
+	emcmotConfig->vtp->tpGetPos(&emcmotDebug->auxqueue[n], &aux->pos);
+	emcmotAuxMergePose(aux->axis_mask, &aux->pos,
+			   &emcmotStatus->carte_pos_cmd);
+    }
+}
+
 static void get_pos_cmds(long period)
 {
     int joint_num, result;
@@ -1284,6 +1397,7 @@ static void get_pos_cmds(long period)
 #endif
     double old_pos_cmd;
     double max_dv, tiny_dp, pos_err, vel_req, vel_lim;
+    double dv, acc_req, max_da, old_vel_cmd;
 
     /* used in teleop mode to compute the max accell requested */
     double accell_mag;
@@ -1381,14 +1495,47 @@ static void get_pos_cmds(long period)
 		} else if (vel_req < -vel_lim) {
 		    vel_req = -vel_lim;
 		}
-		/* ramp velocity toward request at joint accel limit */
-		if (vel_req > joint->vel_cmd + max_dv) {
-		    joint->vel_cmd += max_dv;
-		} else if (vel_req < joint->vel_cmd - max_dv) {
-		    joint->vel_cmd -= max_dv;
+		old_vel_cmd = joint->vel_cmd;
+		if (joint->free_jerk_lim > 0.0) {
+		    /* jerk limited ramp, used by homing to stop a fast
+		       search.  The accel is reduced as the velocity error
+		       shrinks, so that it reaches zero together with it */
+		    dv = vel_req - joint->vel_cmd;
+		    max_da = joint->free_jerk_lim * servo_period;
+		    acc_req = -max_da + rtapi_sqrt(2.0 * joint->free_jerk_lim *
+			rtapi_fabs(dv) + max_da * max_da);
+		    if (acc_req > joint->acc_limit) {
+			acc_req = joint->acc_limit;
+		    }
+		    if (dv < 0.0) {
+			acc_req = -acc_req;
+		    }
+		    if (acc_req > joint->acc_cmd + max_da) {
+			joint->acc_cmd += max_da;
+		    } else if (acc_req < joint->acc_cmd - max_da) {
+			joint->acc_cmd -= max_da;
+		    } else {
+			joint->acc_cmd = acc_req;
+		    }
+		    if (rtapi_fabs(dv) <= max_da * servo_period ||
+			(joint->acc_cmd * dv > 0.0 &&
+			 rtapi_fabs(joint->acc_cmd * servo_period) >= rtapi_fabs(dv))) {
+			/* close enough, land on the requested velocity */
+			joint->vel_cmd = vel_req;
+		    } else {
+			joint->vel_cmd += joint->acc_cmd * servo_period;
+		    }
 		} else {
-		    joint->vel_cmd = vel_req;
+		    /* ramp velocity toward request at joint accel limit */
+		    if (vel_req > joint->vel_cmd + max_dv) {
+			joint->vel_cmd += max_dv;
+		    } else if (vel_req < joint->vel_cmd - max_dv) {
+			joint->vel_cmd -= max_dv;
+		    } else {
+			joint->vel_cmd = vel_req;
+		    }
 		}
+		joint->acc_cmd = (joint->vel_cmd - old_vel_cmd) / servo_period;
 		/* check for still moving */
 		if (joint->vel_cmd != 0.0) {
 		    /* yes, mark joint active */
@@ -1475,6 +1622,7 @@ static void get_pos_cmds(long period)
 
 	    /* gt new commanded traj pos */
 	    emcmotConfig->vtp->tpGetPos(emcmotQueue, &emcmotStatus->carte_pos_cmd);
+	    run_aux_planners(period);
 
 	    /* OUTPUT KINEMATICS - convert to joints in local array */
 	    emcmotConfig->vtk->kinematicsInverse(&emcmotStatus->carte_pos_cmd, positions,
@@ -1793,6 +1941,94 @@ Their exact contents and meaning are as follows:
 
 */
 
+/* find the entry of a joint comp table whose segment contains 'pos'.
+   The commanded position moves very little from one servo cycle to
+   the next, so the entry used last time and its neighbours are tried
+   first; after a jump (homing, a new table) the table is bisected. */
+static emcmot_comp_entry_t *find_comp_entry(emcmot_comp_t *comp, double pos)
+{
+    emcmot_comp_entry_t *e = comp->entry;
+    int lo, hi, mid;
+
+    if (pos >= e->nominal) {
+	if (pos < e[1].nominal) {
+	    return e;
+	}
+	if (e < comp->array + comp->entries && pos < e[2].nominal) {
+	    return e + 1;
+	}
+    } else if (e > comp->array && pos >= e[-1].nominal) {
+	return e - 1;
+    }
+    /* array[0] is at -DBL_MAX and array[entries+1] at +DBL_MAX */
+    lo = 0;
+    hi = comp->entries + 1;
+    while (hi - lo > 1) {
+	mid = (lo + hi) / 2;
+	if (pos < comp->array[mid].nominal) {
+	    hi = mid;
+	} else {
+	    lo = mid;
+	}
+    }
+    return &comp->array[lo];
+}
+
+static void cart_lerp(PmCartesian const *a, PmCartesian const *b, double f,
+		      PmCartesian *out)
+{
+    out->x = a->x + f * (b->x - a->x);
+    out->y = a->y + f * (b->y - a->y);
+    out->z = a->z + f * (b->z - a->z);
+}
+
+/* trilinear interpolation of the volumetric comp grid at the commanded
+   positions of joints 0..2.  Positions outside the grid use the value
+   at the nearest edge.  Returns 0 if there is no correction to apply. */
+static int compute_vol_comp(PmCartesian *corr)
+{
+    emcmot_vol_comp_t *vc = &emcmotVolComp;
+    int n, i[3], sx, sy, sz;
+    double f[3], u;
+    PmCartesian const *t;
+    PmCartesian c00, c10, c01, c11, c0, c1;
+
+    if (!vc->enabled || num_joints < 3) {
+	return 0;
+    }
+    for (n = 0; n < 3; n++) {
+	/* positions are meaningless until the joints are homed */
+	if (!GET_JOINT_HOMED_FLAG(&joints[n])) {
+	    return 0;
+	}
+	u = (joints[n].pos_cmd - vc->origin[n]) * vc->inv_step[n];
+	if (vc->count[n] < 2 || u <= 0.0) {
+	    i[n] = 0;
+	    f[n] = 0.0;
+	} else if (u >= vc->count[n] - 1) {
+	    i[n] = vc->count[n] - 2;
+	    f[n] = 1.0;
+	} else {
+	    i[n] = (int) u;
+	    f[n] = u - i[n];
+	}
+    }
+    /* offsets to the neighbouring grid points, 0 along a flat axis */
+    sx = vc->count[0] > 1 ? 1 : 0;
+    sy = vc->count[1] > 1 ? vc->count[0] : 0;
+    sz = vc->count[2] > 1 ? vc->count[0] * vc->count[1] : 0;
+    t = vc->trim + i[0] + vc->count[0] * (i[1] + vc->count[1] * i[2]);
+
+    cart_lerp(&t[0], &t[sx], f[0], &c00);
+    cart_lerp(&t[sy], &t[sy + sx], f[0], &c10);
+    cart_lerp(&t[sz], &t[sz + sx], f[0], &c01);
+    cart_lerp(&t[sz + sy], &t[sz + sy + sx], f[0], &c11);
+    cart_lerp(&c00, &c10, f[1], &c0);
+    cart_lerp(&c01, &c11, f[1], &c1);
+    cart_lerp(&c0, &c1, f[2], corr);
+    return 1;
+}
+
 static void compute_screw_comp(void)
 {
     int joint_num;
@@ -1800,6 +2036,14 @@ static void compute_screw_comp(void)
     emcmot_comp_t *comp;
     double dpos;
     double a_max, v_max, v, s_to_go, ds_stop, ds_vel, ds_acc, dv_acc;
+    PmCartesian vol_corr;
+    double vol[3];
+    int vol_active;
+
+    vol_active = compute_vol_comp(&vol_corr);
+    vol[0] = vol_corr.x;
+    vol[1] = vol_corr.y;
+    vol[2] = vol_corr.z;
 
 
     /* compute the correction */
@@ -1810,17 +2054,15 @@ static void compute_screw_comp(void)
 	    /* if joint is not active, skip it */
 	    continue;
 	}
+	/* backlash_corr holds last cycle's volumetric correction as
+	   well, take it out so the screw comp below sees its own value */
+	joint->backlash_corr -= joint->vol_corr;
 	/* point to compensation data */
 	comp = &(joint->comp);
 	if ( comp->entries > 0 ) {
 	    /* there is data in the comp table, use it */
 	    /* first make sure we're in the right spot in the table */
-	    while ( joint->pos_cmd < comp->entry->nominal ) {
-		comp->entry--;
-	    }
-	    while ( joint->pos_cmd >= (comp->entry+1)->nominal ) {
-		comp->entry++;
-	    }
+	    comp->entry = find_comp_entry(comp, joint->pos_cmd);
 	    /* now interpolate */
 	    dpos = joint->pos_cmd - comp->entry->nominal;
 	    if (joint->vel_cmd > 0.0) {
@@ -1852,6 +2094,10 @@ static void compute_screw_comp(void)
 		/* not moving, use whatever was there before */
 	    }
 	}
+	/* add the volumetric correction; it goes through the same
+	   ramp as backlash, so enabling it or homing causes no step */
+	joint->vol_corr = (vol_active && joint_num < 3) ? vol[joint_num] : 0.0;
+	joint->backlash_corr += joint->vol_corr;
 	/* at this point, the correction has been computed, but
 	   the value may make abrupt jumps on direction reversal */
     /*
@@ -2135,7 +2381,7 @@ static void output_to_hal(void)
 
 static void update_status(void)
 {
-    int joint_num, dio, aio;
+    int joint_num, dio, aio, n;
     emcmot_joint_t *joint;
     emcmot_joint_status_t *joint_status;
 #ifdef WATCH_FLAGS
@@ -2205,6 +2451,17 @@ static void update_status(void)
     emcmotStatus->motionType = emcmotConfig->vtp->tpGetMotionType(emcmotQueue);
     emcmotStatus->queueFull = emcmotConfig->vtp->tcqFull(&emcmotQueue->queue);
 
+    /* auxiliary planner queue status */
+    for (n = 0; n < emcmotStatus->num_aux_planners; n++) {
+	TP_STRUCT *aux_tp = &emcmotDebug->auxqueue[n];
+	emcmot_aux_status_t *aux = &emcmotStatus->aux[n];
+
+	aux->depth = emcmotConfig->vtp->tpQueueDepth(aux_tp);
+	aux->id = emcmotConfig->vtp->tpGetExecId(aux_tp);
+	aux->queueFull = emcmotConfig->vtp->tcqFull(&aux_tp->queue);
+	aux->done = emcmotConfig->vtp->tpIsDone(aux_tp) && aux->depth == 0;
+    }
+
     /* check to see if we should pause in order to implement
        single emcmotDebug->stepping */
     if (emcmotDebug->stepping &&
@@ -57,6 +57,15 @@
 #define DEFAULT_TC_QUEUE_SIZE 2000
 #define DEFAULT_ALT_TC_QUEUE_SIZE 100   // size of secondary motion queue
 
+/* auxiliary coordinated planners, each driving its own subset of axes
+   alongside the main planner, and the size of their queues */
+#define EMCMOT_MAX_AUX_PLANNERS 4
+#define DEFAULT_AUX_TC_QUEUE_SIZE 100
+
+/* per-stage servo cycle timing, see emcmotController() */
+#define EMCMOT_NUM_STAGES 9
+#define EMCMOT_STAGE_HIST_BINS 32	/* one bin per power of two clocks */
+
 /* max following error */
 #define DEFAULT_MAX_FERROR 100
 
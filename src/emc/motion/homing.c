@@ -61,6 +61,8 @@ static void home_start_move(emcmot_joint_t * joint, double vel)
 	joint->free_pos_cmd = joint->pos_cmd - 2.0 * joint_range;
     }
     joint->free_vel_lim = rtapi_fabs(vel);
+    /* only the end of a search is jerk limited */
+    joint->free_jerk_lim = 0.0;
     /* start the move */
     joint->free_tp_enable = 1;
 }
@@ -94,21 +96,43 @@ static void home_do_moving_checks(emcmot_joint_t * joint)
     }
 }
 
+/* 'home_start_joints()' starts homing all joints of 'group' whose
+   sequence number is 'sequence', and returns how many it started. */
+static int home_start_joints(int group, int sequence)
+{
+    int i;
+    int seen = 0;
+    emcmot_joint_t *joint;
+
+    for(i=0; i < num_joints; i++) {
+	joint = &joints[i];
+	if(joint->home_group == group && joint->home_sequence == sequence) {
+	    /* start this joint */
+	    joint->free_tp_enable = 0;
+	    joint->home_state = HOME_START;
+	    seen++;
+	}
+    }
+    return seen;
+}
+
 /***********************************************************************
 *                      PUBLIC FUNCTIONS                                *
 ************************************************************************/
 
 void do_homing_sequence(void)
 {
-    static int home_sequence = -1;
-    int i;
+    /* current step of each home group, -1 once a group is finished */
+    static int home_sequence[EMCMOT_MAX_JOINTS];
+    static int first = 1;
+    int i, g;
     int seen = 0;
     emcmot_joint_t *joint;
 
     /* first pass init */
-    if(home_sequence == -1) {
+    if(first) {
         emcmotStatus->homingSequenceState = HOME_SEQUENCE_IDLE;
-	home_sequence = 0;
+	first = 0;
     }
 
     switch(emcmotStatus->homingSequenceState) {
@@ -126,28 +150,29 @@ void do_homing_sequence(void)
 		return;
 	    }
 	}
-	/* ok to start the sequence, start at zero */
-	home_sequence = 0;
+	/* ok to start the sequence, start every group at zero */
+	for(g=0; g < EMCMOT_MAX_JOINTS; g++) {
+	    home_sequence[g] = 0;
+	}
 	/* tell the world we're on the job */
 	emcmotStatus->homing_active = 1;
 	/* and drop into next state */
 
     case HOME_SEQUENCE_START_JOINTS:
-	/* start all joints whose sequence number matches home_sequence */
-	for(i=0; i < num_joints; i++) {
-	    joint = &joints[i];
-	    if(joint->home_sequence == home_sequence) {
-		/* start this joint */
-	        joint->free_tp_enable = 0;
-		joint->home_state = HOME_START;
+	/* start the first step of each group */
+	for(g=0; g < EMCMOT_MAX_JOINTS; g++) {
+	    if(home_start_joints(g, home_sequence[g])) {
 		seen++;
+	    } else {
+		/* no joints have this sequence number, group is done */
+		home_sequence[g] = -1;
 	    }
 	}
 	if(seen) {
 	    /* at least one joint is homing, wait for it */
 	    emcmotStatus->homingSequenceState = HOME_SEQUENCE_WAIT_JOINTS;
 	} else {
-	    /* no joints have this sequence number, we're done */
+	    /* no joints to home, we're done */
 	    emcmotStatus->homingSequenceState = HOME_SEQUENCE_IDLE;
 	    /* tell the world */
 	    emcmotStatus->homing_active = 0;
@@ -155,29 +180,51 @@ void do_homing_sequence(void)
 	break;
 
     case HOME_SEQUENCE_WAIT_JOINTS:
-	for(i=0; i < num_joints; i++) {
-	    joint = &joints[i];
-	    if(joint->home_sequence != home_sequence) {
-		/* this joint is not at the current sequence number, ignore it */
+	/* groups are independent: each moves on to its next step as
+	   soon as its own joints are done, without waiting for the
+	   slowest joint of the whole machine */
+	for(g=0; g < EMCMOT_MAX_JOINTS; g++) {
+	    int busy = 0;
+	    if(home_sequence[g] < 0) {
+		/* this group has finished */
 		continue;
 	    }
-	    if(joint->home_state != HOME_IDLE) {
-		/* still busy homing, keep waiting */
-		seen = 1;
-		continue;
+	    for(i=0; i < num_joints; i++) {
+		joint = &joints[i];
+		if(joint->home_group != g ||
+		   joint->home_sequence != home_sequence[g]) {
+		    /* this joint is not at the current step, ignore it */
+		    continue;
+		}
+		if(joint->home_state != HOME_IDLE) {
+		    /* still busy homing, keep waiting */
+		    busy = 1;
+		    continue;
+		}
+		if(!GET_JOINT_AT_HOME_FLAG(joint)) {
+		    /* joint should have been homed at this step, it is no
+		       longer homing, but its not at home - must have failed.
+		       bail out */
+		    emcmotStatus->homingSequenceState = HOME_SEQUENCE_IDLE;
+		    emcmotStatus->homing_active = 0;
+		    return;
+		}
 	    }
-	    if(!GET_JOINT_AT_HOME_FLAG(joint)) {
-		/* joint should have been homed at this step, it is no longer
-		   homing, but its not at home - must have failed.  bail out */
-		emcmotStatus->homingSequenceState = HOME_SEQUENCE_IDLE;
-		emcmotStatus->homing_active = 0;
-		return;
+	    if(!busy) {
+		/* all joints at this step have finished homing, move on
+		   to the next step of this group */
+		home_sequence[g]++;
+		if(!home_start_joints(g, home_sequence[g])) {
+		    home_sequence[g] = -1;
+		    continue;
+		}
 	    }
+	    seen = 1;
 	}
 	if(!seen) {
-	    /* all joints at this step have finished homing, move on to next step */
-	    home_sequence ++;
-	    emcmotStatus->homingSequenceState = HOME_SEQUENCE_START_JOINTS;
+	    /* all groups have finished */
+	    emcmotStatus->homingSequenceState = HOME_SEQUENCE_IDLE;
+	    emcmotStatus->homing_active = 0;
 	}
 	break;
     default:
@@ -253,6 +300,7 @@ void do_homing(void)
 		SET_JOINT_AT_HOME_FLAG(joint, 0);
 		/* stop any existing motion */
 		joint->free_tp_enable = 0;
+		joint->free_jerk_lim = 0.0;
 		/* reset delay counter */
 		joint->home_pause_timer = 0;
 		/* figure out exactly what homing sequence is needed */
@@ -380,7 +428,22 @@ void do_homing(void)
 		   the home is aborted. */
 		/* have we hit home switch yet? */
 		if (home_sw_active) {
-		    /* yes, stop motion */
+		    /* slow down smoothly if a jerk limit is set, this is
+		       what allows a high search_vel */
+		    joint->free_jerk_lim = joint->home_search_jerk;
+		    if ((joint->home_flags & HOME_USE_INDEX) &&
+			(joint->home_flags & HOME_INDEX_DIRECT) &&
+			joint->home_search_vel * joint->home_latch_vel > 0.0) {
+			/* the encoder captures the index in hardware, at
+			   any speed, so there is no need to find the switch
+			   edge again.  Arm the index now and keep going,
+			   slowing down to latch_vel */
+			joint->free_vel_lim = rtapi_fabs(joint->home_latch_vel);
+			joint->home_state = HOME_INDEX_SEARCH_START;
+			immediate_state = 1;
+			break;
+		    }
+		    /* stop motion */
 		    joint->free_tp_enable = 0;
 		    /* go to next step */
 		    joint->home_state = HOME_SET_COARSE_POSITION;
@@ -712,6 +775,7 @@ void do_homing(void)
 		joint->home_pause_timer = 0;
 		/* plan a move to home position */
 		joint->free_pos_cmd = *(joint->home);
+		joint->free_jerk_lim = 0.0;
 		/* do the move at max speed */
 		/* if home_vel is set (>0) then we use that, otherwise we rapid there */
 		if (joint->home_final_vel > 0) {
@@ -787,6 +851,7 @@ void do_homing(void)
 		SET_JOINT_HOMED_FLAG(joint, 0);
 		SET_JOINT_AT_HOME_FLAG(joint, 0);
 		joint->free_tp_enable = 0;
+		joint->free_jerk_lim = 0.0;
 		joint->home_state = HOME_IDLE;
 		joint->index_enable = 0;
 		immediate_state = 1;
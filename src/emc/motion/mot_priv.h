@@ -173,6 +173,12 @@ typedef struct {
     hal_float_t last_period_ns;	/* param: last period in nanoseconds */
     hal_u32_t overruns;		/* param: count of RT overruns */
 
+    // per-stage timing of the servo cycle
+    hal_bit_t stage_timing;	/* param: enable per-stage timing */
+    hal_u32_t stage_time[EMCMOT_NUM_STAGES];	/* param: last time in clocks */
+    hal_u32_t stage_tmax[EMCMOT_NUM_STAGES];	/* param: max time in clocks */
+    hal_u32_t stage_p99[EMCMOT_NUM_STAGES];	/* param: 99th percentile, clocks */
+
     hal_float_t *tooloffset_x;
     hal_float_t *tooloffset_y;
     hal_float_t *tooloffset_z;
@@ -240,6 +246,35 @@ enum pause_state { PS_RUNNING=0,  // aka 'not paused'
 		   PS_PAUSING_FOR_STEP=6,
 };
 
+/* volumetric compensation: a regular grid over the positions of
+   joints 0, 1 and 2, with a correction for each of them at every grid
+   point.  Corrections are interpolated trilinearly and clamped to the
+   edges of the grid.  Storage is allocated once at load time. */
+typedef struct {
+    int size;                   /* max grid points, motmod vol_comp_size */
+    int count[3];               /* grid points along each joint */
+    double origin[3];           /* position of the first grid point */
+    double step[3];             /* grid spacing */
+    double inv_step[3];
+    int points;                 /* count[0] * count[1] * count[2] */
+    int loaded;                 /* points received so far */
+    int enabled;                /* all points received */
+    PmCartesian *trim;          /* corrections, first index fastest */
+} emcmot_vol_comp_t;
+
+/* stages of the servo cycle, timed individually when
+   motion.servo.stage-timing is set (see emcmotController()) */
+enum servo_stage { SS_INPUTS=0,     // process_inputs
+		   SS_FWD_KINS=1,   // do_forward_kins
+		   SS_FAULTS=2,     // probe inputs, faults, operating mode
+		   SS_JOGWHEELS=3,  // handle_jogwheels
+		   SS_HOMING=4,     // homing sequence and homing state machine
+		   SS_POS_CMDS=5,   // get_pos_cmds: tp, interpolation, inverse kins
+		   SS_SCREW_COMP=6, // compute_screw_comp
+		   SS_OUTPUT=7,     // output_to_hal
+		   SS_STATUS=8,     // update_status; keep EMCMOT_NUM_STAGES in sync
+};
+
 
 /***********************************************************************
 *                   GLOBAL VARIABLE DECLARATIONS                       *
@@ -293,6 +328,7 @@ extern struct emcmot_command_t *emcmotCommand;
 extern struct emcmot_status_t *emcmotStatus;
 extern struct emcmot_config_t *emcmotConfig;
 extern struct emcmot_debug_t *emcmotDebug;
+extern emcmot_vol_comp_t emcmotVolComp;
 extern struct emcmot_internal_t *emcmotInternal;
 extern struct emcmot_error_t *emcmotError;
 
@@ -317,6 +353,24 @@ extern void emcmotAioWrite(unsigned int index, hal_float_t value);
 extern void emcmotSetRotaryUnlock(int axis,  hal_bit_t unlock);
 extern hal_bit_t emcmotGetRotaryIsUnlocked(int axis);
 
+/* auxiliary planners, see emcmot_aux_status_t */
+extern void emcmotAuxMergePose(int mask, EmcPose const *from, EmcPose *to);
+extern void emcmotAuxSetPos(EmcPose const *pos);
+extern void emcmotAuxAbortAll(void);
+extern int emcmotAuxDone(void);
+
+/* flushes the inverse kinematics cache of the limit checks, see command.c */
+extern void inRangeFlush(void);
+
+extern int emcmotKinsInverse(EmcPose const * const pos, double * const joint_pos);
+extern int emcmotKinsInverseBatch(int n, EmcPoseBatch const * const pos,
+				  double * const * const joint_pos);
+/* emcmotKinsInverse() for each auxiliary planner */
+extern int (*emcmotAuxKinsInverses[EMCMOT_MAX_AUX_PLANNERS])(EmcPose const * const pos,
+							  double * const joint_pos);
+extern int emcmotGetJointLimits(double * const vel_limit, double * const acc_limit,
+				double * const pos_cmd);
+
 /* homing is no longer in control.c, make functions public */
 extern void do_homing_sequence(void);
 extern void do_homing(void);
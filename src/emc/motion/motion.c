@@ -14,6 +14,7 @@
 #include "rtapi_app.h"		/* RTAPI realtime module decls */
 #include "rtapi_string.h"       /* memset */
 #include "hal.h"		/* decls for HAL implementation */
+#include "hal_ring.h"		/* TP event trace ring */
 #include "emcmotglb.h"
 #include "motion.h"
 #include "motion_debug.h"
@@ -22,8 +23,8 @@
 #include "rtapi_math.h"
 
 // vtable signatures
-#define VTKINS_VERSION VTKINEMATICS_VERSION1
-#define VTP_VERSION    VTTP_VERSION1
+#define VTKINS_VERSION VTKINEMATICS_VERSION2
+#define VTP_VERSION    VTTP_VERSION2
 
 // Mark strings for translation, but defer translation to userspace
 #define _(s) (s)
@@ -60,12 +61,22 @@ static int servo_cpu = -1;		/* explicitly bind to CPU */
 RTAPI_MP_INT(servo_cpu, "CPU of servo thread");
 long traj_period_nsec = 0;	/* trajectory planner period */
 RTAPI_MP_LONG(traj_period_nsec, "trajectory planner period (nsecs)");
+int traj_interp_order = 3;	/* order of traj to servo rate interpolation */
+RTAPI_MP_INT(traj_interp_order, "interpolation from traj to servo rate, 3 = cubic, 5 = quintic");
 int num_joints = EMCMOT_MAX_JOINTS;	/* default number of joints present */
 RTAPI_MP_INT(num_joints, "number of joints");
 int num_dio = 4;			/* default number of motion synched DIO */
 RTAPI_MP_INT(num_dio, "number of digital inputs/outputs");
 int num_aio = 4;			/* default number of motion synched AIO */
 RTAPI_MP_INT(num_aio, "number of analog inputs/outputs");
+int screw_comp_size = EMCMOT_COMP_SIZE;	/* per joint comp table entries */
+RTAPI_MP_INT(screw_comp_size, "max entries in each joint compensation table");
+int vol_comp_size = EMCMOT_VOL_COMP_SIZE;	/* volumetric comp grid points */
+RTAPI_MP_INT(vol_comp_size, "max points in the volumetric compensation grid");
+int tp_trace_size = 0;		/* bytes in the TP event trace ring */
+RTAPI_MP_INT(tp_trace_size, "size of the TP event trace ring in bytes, 0 = no trace");
+int num_aux_planners = 0;	/* auxiliary coordinated planners */
+RTAPI_MP_INT(num_aux_planners, "number of auxiliary coordinated planners");
 static char *kins = "trivkins";
 RTAPI_MP_STRING(kins, "kinematics vtable name");
 static char *tp = "tp";
@@ -110,6 +121,7 @@ struct emcmot_command_t *emcmotCommand = 0;
 struct emcmot_status_t *emcmotStatus = 0;
 struct emcmot_config_t *emcmotConfig = 0;
 struct emcmot_debug_t *emcmotDebug = 0;
+emcmot_vol_comp_t emcmotVolComp;	/* volumetric compensation grid */
 TP_STRUCT *emcmotPrimQueue = 0; // primary planner + queues
 TP_STRUCT *emcmotAltQueue = 0; // alternate planner + queues
 
@@ -130,6 +142,12 @@ static int emc_shmem_id;	/* the shared memory ID */
 *                   LOCAL FUNCTION PROTOTYPES                          *
 ************************************************************************/
 
+/* HAL names of the servo cycle stages, indexed by enum servo_stage */
+static const char *servo_stage_names[EMCMOT_NUM_STAGES] = {
+    "inputs", "fwd-kins", "faults", "jogwheels", "homing",
+    "pos-cmds", "screw-comp", "output", "status"
+};
+
 /* init_hal_io() exports HAL pins and parameters making data from
    the realtime control module visible and usable by the world
 */
@@ -162,6 +180,7 @@ static int init_shared(tp_shared_t *tps,
 		       emcmot_debug_t *dbg,
 		       emcmot_joint_t *joint,
 		       emcmot_hal_data_t *hal);
+static int init_aux_planner(int n);
 /***********************************************************************
 *                     PUBLIC FUNCTION CODE                             *
 ************************************************************************/
@@ -233,6 +252,33 @@ int rtapi_app_main(void)
 	return -1;
     }
 
+    if (( screw_comp_size < 1 ) || ( vol_comp_size < 0 )) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    _("MOTION: screw_comp_size must be positive and vol_comp_size non-negative\n"));
+	return -1;
+    }
+
+    if (( num_aux_planners < 0 ) || ( num_aux_planners > EMCMOT_MAX_AUX_PLANNERS )) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    _("MOTION: num_aux_planners is %d, must be between 0 and %d\n"),
+	    num_aux_planners, EMCMOT_MAX_AUX_PLANNERS);
+	return -1;
+    }
+
+    if ( tp_trace_size < 0 ) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    _("MOTION: tp_trace_size is %d, must not be negative\n"),
+	    tp_trace_size);
+	return -1;
+    }
+
+    if (( traj_interp_order != 3 ) && ( traj_interp_order != 5 )) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    _("MOTION: traj_interp_order is %d, must be 3 or 5\n"),
+	    traj_interp_order);
+	return -1;
+    }
+
     /* initialize/export HAL pins and parameters */
     retval = init_hal_io();
     if (retval != 0) {
@@ -281,6 +327,13 @@ void rtapi_app_exit(void)
 	    _("MOTION: hal_stop_threads() failed, returned %d\n"), retval);
     }
 
+    // release the TP event trace ring
+    if (emcmotDebug->tps && emcmotDebug->tps->trace) {
+	hal_ring_detach(emcmotDebug->tps->trace);
+	hal_ring_deletef("%s", TP_TRACE_RING_NAME);
+	emcmotDebug->tps->trace = NULL;
+    }
+
     // release the kinematics vtable
     hal_unreference_vtable(emcmotConfig->kins_vid);
 
@@ -568,6 +621,30 @@ static int init_hal_io(void)
 	return retval;
     }
 
+    // per-stage timing of the servo cycle, in clocks like last-period
+    retval =
+	hal_param_bit_new("motion.servo.stage-timing", HAL_RW, &(emcmot_hal_data->stage_timing), mot_comp_id);
+    if (retval != 0) {
+	return retval;
+    }
+    for (n = 0; n < EMCMOT_NUM_STAGES; n++) {
+	retval = hal_param_u32_newf(HAL_RO, &(emcmot_hal_data->stage_time[n]), mot_comp_id,
+				    "motion.servo.stage.%s.time", servo_stage_names[n]);
+	if (retval != 0) {
+	    return retval;
+	}
+	retval = hal_param_u32_newf(HAL_RW, &(emcmot_hal_data->stage_tmax[n]), mot_comp_id,
+				    "motion.servo.stage.%s.tmax", servo_stage_names[n]);
+	if (retval != 0) {
+	    return retval;
+	}
+	retval = hal_param_u32_newf(HAL_RO, &(emcmot_hal_data->stage_p99[n]), mot_comp_id,
+				    "motion.servo.stage.%s.p99", servo_stage_names[n]);
+	if (retval != 0) {
+	    return retval;
+	}
+    }
+
     retval = hal_pin_float_new("motion.tooloffset.x", HAL_OUT, &(emcmot_hal_data->tooloffset_x), mot_comp_id);
     if (retval != 0) {
         return retval;
@@ -683,6 +760,12 @@ static int init_hal_io(void)
 
     emcmot_hal_data->overruns = 0;
     emcmot_hal_data->last_period = 0;
+    emcmot_hal_data->stage_timing = 0;
+    for (n = 0; n < EMCMOT_NUM_STAGES; n++) {
+	emcmot_hal_data->stage_time[n] = 0;
+	emcmot_hal_data->stage_tmax[n] = 0;
+	emcmot_hal_data->stage_p99[n] = 0;
+    }
 
     /* export joint pins and parameters */
     for (n = 0; n < num_joints; n++) {
@@ -947,13 +1030,20 @@ static int init_comm_buffers(void)
     emcmotStatus = &emcmotStruct->status;
     emcmotConfig = &emcmotStruct->config;
 
-    // bind kinematics vtable
+    // bind kinematics vtable; modules built against older headers export
+    // the layout without the batch entries
+    emcmotConfig->kins_version = VTKINS_VERSION;
     emcmotConfig->kins_vid = hal_reference_vtable(kins, VTKINS_VERSION,
 						  (void **)&emcmotConfig->vtk);
+    if (emcmotConfig->kins_vid < 0) {
+	emcmotConfig->kins_version = VTKINEMATICS_VERSION1;
+	emcmotConfig->kins_vid = hal_reference_vtable(kins, VTKINEMATICS_VERSION1,
+						      (void **)&emcmotConfig->vtk);
+    }
     if (emcmotConfig->kins_vid < 0) {
 	rtapi_print_msg(RTAPI_MSG_ERR,
 			"MOTION: hal_reference_vtable(%s,%d) failed: %d\n",
-			kins, VTKINS_VERSION, emcmotConfig->kins_vid);
+			kins, emcmotConfig->kins_version, emcmotConfig->kins_vid);
 	return -1;
     }
 
@@ -1083,8 +1173,17 @@ static int init_comm_buffers(void)
 	*(joint->home) = 0.0;
 	joint->home_flags = 0;
 	joint->home_sequence = -1;
+	joint->home_group = 0;
+	joint->home_search_jerk = 0.0;
 	joint->backlash = 0.0;
 
+	joint->comp.size = screw_comp_size;
+	joint->comp.array = hal_malloc(sizeof(emcmot_comp_entry_t) * (screw_comp_size + 2));
+	if (joint->comp.array == 0) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		_("MOTION: joint %d compensation table malloc failed\n"), joint_num);
+	    return -1;
+	}
 	joint->comp.entries = 0;
 	joint->comp.entry = &(joint->comp.array[0]);
 	/* the compensation code has -DBL_MAX at one end of the table
@@ -1095,7 +1194,7 @@ static int init_comm_buffers(void)
 	joint->comp.array[0].rev_trim = 0.0;
 	joint->comp.array[0].fwd_slope = 0.0;
 	joint->comp.array[0].rev_slope = 0.0;
-	for ( n = 1 ; n < EMCMOT_COMP_SIZE+2 ; n++ ) {
+	for ( n = 1 ; n < screw_comp_size+2 ; n++ ) {
 	    joint->comp.array[n].nominal = DBL_MAX;
 	    joint->comp.array[n].fwd_trim = 0.0;
 	    joint->comp.array[n].rev_trim = 0.0;
@@ -1108,9 +1207,12 @@ static int init_comm_buffers(void)
 	joint->coarse_pos = 0.0;
 	joint->pos_cmd = 0.0;
 	joint->vel_cmd = 0.0;
+	joint->acc_cmd = 0.0;
+	joint->free_jerk_lim = 0.0;
 	joint->backlash_corr = 0.0;
 	joint->backlash_filt = 0.0;
 	joint->backlash_vel = 0.0;
+	joint->vol_corr = 0.0;
 	joint->motor_pos_cmd = 0.0;
 	joint->motor_pos_fb = 0.0;
 	joint->pos_fb = 0.0;
@@ -1120,6 +1222,7 @@ static int init_comm_buffers(void)
 
 	/* init internal info */
 	cubicInit(&(joint->cubic));
+	cubicSetOrder(&(joint->cubic), traj_interp_order);
 
 	/* init misc other stuff in joint structure */
 	joint->big_vel = 10.0 * joint->vel_limit;
@@ -1140,6 +1243,21 @@ static int init_comm_buffers(void)
 
     }
 
+    /* volumetric compensation grid, empty until loaded */
+    emcmotVolComp.size = vol_comp_size;
+    emcmotVolComp.points = 0;
+    emcmotVolComp.loaded = 0;
+    emcmotVolComp.enabled = 0;
+    emcmotVolComp.trim = 0;
+    if (vol_comp_size > 0) {
+	emcmotVolComp.trim = hal_malloc(sizeof(PmCartesian) * vol_comp_size);
+	if (emcmotVolComp.trim == 0) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		_("MOTION: volumetric compensation grid malloc failed\n"));
+	    return -1;
+	}
+    }
+
     /*! \todo FIXME-- add emcmotError */
 
     emcmotDebug->tMin = 0.0;
@@ -1183,6 +1301,30 @@ static int init_comm_buffers(void)
 		joints, // internal joint data
 		emcmot_hal_data); // HAL exorted part of joint data
 
+    /* optional TP event trace, see tp_trace.h */
+    emcmotDebug->tps->trace = NULL;
+    if (tp_trace_size > 0) {
+	if (hal_ring_newf(tp_trace_size, sizeof(tp_trace_header_t),
+			  ALLOC_HALMEM, "%s", TP_TRACE_RING_NAME) < 0) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+			    "MOTION: failed to create ring '%s'\n",
+			    TP_TRACE_RING_NAME);
+	    return -1;
+	}
+	emcmotDebug->tps->trace = hal_malloc(sizeof(ringbuffer_t));
+	if (!emcmotDebug->tps->trace ||
+	    hal_ring_attachf(emcmotDebug->tps->trace, NULL, "%s",
+			     TP_TRACE_RING_NAME)) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+			    "MOTION: failed to attach to ring '%s'\n",
+			    TP_TRACE_RING_NAME);
+	    emcmotDebug->tps->trace = NULL;
+	    return -1;
+	}
+	((tp_trace_header_t *) emcmotDebug->tps->trace->scratchpad)->magic =
+	    TP_TRACE_MAGIC;
+    }
+
     /* init motion emcmotDebug->queue */
     if (-1 == emcmotConfig->vtp->tpCreate(emcmotPrimQueue, DEFAULT_TC_QUEUE_SIZE,
 					  emcmotDebug->queueTcSpace,
@@ -1211,6 +1353,13 @@ static int init_comm_buffers(void)
     // the emcmotAltQueue parameters as per above are cloned
     // by tpSnapshot() during switching queues
 
+    emcmotStatus->num_aux_planners = num_aux_planners;
+    for (n = 0; n < num_aux_planners; n++) {
+	if (init_aux_planner(n)) {
+	    return -1;
+	}
+    }
+
     emcmotStatus->tail = 0;
 
     rtapi_print_msg(RTAPI_MSG_INFO, "MOTION: init_comm_buffers() complete\n");
@@ -1320,19 +1469,20 @@ static int init_threads(void)
 	// if we don't set cycle times based on these guesses, emc doesn't
 	// start up right
 	// if no threads, postponed until first invocation of emcmotCommandHandler
-	setServoCycleTime(servo_period_nsec * 1e-9);
-	setTrajCycleTime(traj_period_nsec * 1e-9);
+	emcmotSetCycleTime(servo_period_nsec);
     }
     rtapi_print_msg(RTAPI_MSG_INFO, "MOTION: init_threads() complete\n");
     return 0;
 }
 
+/* call this with the servo thread period; the traj period is rounded
+   to the nearest whole multiple of it */
 void emcmotSetCycleTime(unsigned long nsec ) {
     int servo_mult;
-    servo_mult = traj_period_nsec / nsec;
-    if(servo_mult < 0) servo_mult = 1;
-    setTrajCycleTime(nsec * 1e-9);
-    setServoCycleTime(nsec * servo_mult * 1e-9);
+    servo_mult = (traj_period_nsec + nsec / 2) / nsec;
+    if(servo_mult < 1) servo_mult = 1;
+    setServoCycleTime(nsec * 1e-9);
+    setTrajCycleTime(nsec * servo_mult * 1e-9);
 }
 /* call this when setting the trajectory cycle time */
 int setTrajCycleTime(double secs)
@@ -1359,11 +1509,16 @@ int setTrajCycleTime(double secs)
 
     /* set traj planner */
     emcmotConfig->vtp->tpSetCycleTime(emcmotPrimQueue, secs);
+    for (t = 0; t < num_aux_planners; t++) {
+	emcmotConfig->vtp->tpSetCycleTime(&emcmotDebug->auxqueue[t], secs);
+    }
 
-    /* set the free planners, cubic interpolation rate and segment time */
+    /* set the free planners, cubic interpolation rate and segment time;
+       the interpolators get one point per traj cycle */
     for (t = 0; t < num_joints; t++) {
 	cubicSetInterpolationRate(&(joints[t].cubic),
 	    emcmotConfig->interpolationRate);
+	cubicSetSegmentTime(&(joints[t].cubic), secs);
     }
 
     /* copy into status out */
@@ -1391,11 +1546,11 @@ int setServoCycleTime(double secs)
     emcmotConfig->interpolationRate =
 	(int) (emcmotConfig->trajCycleTime / secs + 0.5);
 
-    /* set the cubic interpolation rate and PID cycle time */
+    /* set the cubic interpolation rate; the segment time is the traj
+       cycle time, set by setTrajCycleTime() */
     for (t = 0; t < num_joints; t++) {
 	cubicSetInterpolationRate(&(joints[t].cubic),
 	    emcmotConfig->interpolationRate);
-	cubicSetSegmentTime(&(joints[t].cubic), secs);
     }
 
     /* copy into status out */
@@ -1404,6 +1559,19 @@ int setServoCycleTime(double secs)
     return 0;
 }
 
+static void init_shared_dtg(tp_shared_t *tps, EmcPose *dtg)
+{
+    tps->dtg[0] = &dtg->tran.x;
+    tps->dtg[1] = &dtg->tran.y;
+    tps->dtg[2] = &dtg->tran.z;
+    tps->dtg[3] = &dtg->a;
+    tps->dtg[4] = &dtg->b;
+    tps->dtg[5] = &dtg->c;
+    tps->dtg[6] = &dtg->u;
+    tps->dtg[7] = &dtg->v;
+    tps->dtg[8] = &dtg->w;
+}
+
 static int init_shared(tp_shared_t *tps,
 		       struct emcmot_config_t *cfg,
 		       struct emcmot_status_t *status,
@@ -1422,6 +1590,8 @@ static int init_shared(tp_shared_t *tps,
     tps->arcBlendRampFreq = &cfg->arcBlendRampFreq;
     tps->arcBlendTangentKinkRatio = &cfg->arcBlendTangentKinkRatio;
     tps->arcBlendFallbackEnable = &cfg->arcBlendFallbackEnable;
+    tps->segmentMergeEnable = &cfg->segmentMergeEnable;
+    tps->jointLimitSamples = &cfg->jointLimitSamples;
     tps->maxFeedScale = &cfg->maxFeedScale;
 
     // from emcmotStatus
@@ -1440,15 +1610,7 @@ static int init_shared(tp_shared_t *tps,
     tps->enables_queued = &status->enables_queued;
     tps->tcqlen = &status->tcqlen;
 
-    tps->dtg[0] = &status->dtg.tran.x;
-    tps->dtg[1] = &status->dtg.tran.y;
-    tps->dtg[2] = &status->dtg.tran.z;
-    tps->dtg[3] = &status->dtg.a;
-    tps->dtg[4] = &status->dtg.b;
-    tps->dtg[5] = &status->dtg.c;
-    tps->dtg[6] = &status->dtg.u;
-    tps->dtg[7] = &status->dtg.v;
-    tps->dtg[8] = &status->dtg.w;
+    init_shared_dtg(tps, &status->dtg);
 
     // from joints array
     tps->acc_limit[0] = &joint[0].acc_limit;
@@ -1469,5 +1631,69 @@ static int init_shared(tp_shared_t *tps,
     // rotary setter/getters
     tps->SetRotaryUnlock = emcmotSetRotaryUnlock;
     tps->GetRotaryIsUnlocked = emcmotGetRotaryIsUnlocked;
+
+    // kinematics and joint limits for joint limited planning
+    tps->KinsInverse = emcmotKinsInverse;
+    // without the batch entry the tp solves point by point; a
+    // VTKINEMATICS_VERSION1 vtable has no such entry at all
+    tps->KinsInverseBatch =
+	emcmotConfig->kins_version >= VTKINEMATICS_VERSION2 &&
+	emcmotConfig->vtk->kinematicsInverseBatch ?
+	emcmotKinsInverseBatch : NULL;
+    tps->GetJointLimits = emcmotGetJointLimits;
+    return 0;
+}
+
+/* An auxiliary planner shares the configuration of the main planner, but
+   reports its velocity, distance to go and queue state to its own status
+   so it does not overwrite that of the main program. It starts out with
+   no axes assigned, see EMCMOT_SET_AUX_PLANNER. */
+static int init_aux_planner(int n)
+{
+    emcmot_aux_status_t *aux = &emcmotStatus->aux[n];
+    tp_shared_t *tps;
+
+    tps = hal_malloc(sizeof(tp_shared_t));
+    if (!tps) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+			"MOTION: failed to create tp_shared for aux planner %d\n",
+			n + 1);
+	return -1;
+    }
+    init_shared(tps, emcmotConfig, emcmotStatus, emcmotDebug, joints,
+		emcmot_hal_data);
+    tps->spindle_speed = &aux->spindle_speed;
+    tps->spindle_index_enable = &aux->spindle_index_enable;
+    tps->spindleSync = &aux->spindleSync;
+    tps->current_vel = &aux->current_vel;
+    tps->requested_vel = &aux->requested_vel;
+    tps->distance_to_go = &aux->distance_to_go;
+    tps->enables_queued = &aux->enables_queued;
+    tps->tcqlen = &aux->tcqlen;
+    init_shared_dtg(tps, &aux->dtg);
+    tps->trace = NULL;
+    // it plans with poses of its own axes only, solved point by point
+    tps->KinsInverse = emcmotAuxKinsInverses[n];
+    tps->KinsInverseBatch = NULL;
+    emcmotDebug->auxtps[n] = tps;
+
+    if (-1 == emcmotConfig->vtp->tpCreate(&emcmotDebug->auxqueue[n],
+					  DEFAULT_AUX_TC_QUEUE_SIZE,
+					  emcmotDebug->auxqueueTcSpace[n],
+					  tps)) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "MOTION: failed to create aux planner %d\n", n + 1);
+	return -1;
+    }
+    emcmotConfig->vtp->tpSetCycleTime(&emcmotDebug->auxqueue[n],
+				      emcmotConfig->trajCycleTime);
+    emcmotConfig->vtp->tpSetVmax(&emcmotDebug->auxqueue[n], emcmotStatus->vel,
+				 emcmotStatus->vel);
+    emcmotConfig->vtp->tpSetAmax(&emcmotDebug->auxqueue[n], emcmotStatus->acc);
+
+    aux->axis_mask = 0;
+    aux->done = 1;
+    ZERO_EMC_POSE(aux->pos);
+    emcmotConfig->vtp->tpSetPos(&emcmotDebug->auxqueue[n], &aux->pos);
     return 0;
 }
@@ -179,6 +179,11 @@ extern "C" {
     EMCMOT_SET_MAX_FEED_OVERRIDE = 62,
     EMCMOT_SETUP_ARC_BLENDS = 63,
     EMCMOT_RAPID_SCALE = 64,	          /* set scale factor for rapids */
+    EMCMOT_SET_VOL_COMP_GRID = 65,        /* set up the volumetric compensation grid */
+    EMCMOT_SET_VOL_COMP_POINTS = 66,      /* set the corrections at a run of grid points */
+    EMCMOT_SET_AUX_PLANNER = 67,          /* assign axes to an auxiliary planner */
+    EMCMOT_AUX_LINE = 68,                 /* queue a linear move on an auxiliary planner */
+    EMCMOT_AUX_ABORT = 69,                /* abort an auxiliary planner */
     } cmd_code_t;
 
 /* this enum lists the possible results of a command */
@@ -200,6 +205,11 @@ extern "C" {
        COMMAND STRUCTURE
 *********************************/
 
+/* default number of volumetric comp grid points (11 x 11 x 11), see motmod
+   vol_comp_size, and grid points sent per command while loading */
+#define EMCMOT_VOL_COMP_SIZE 1331
+#define EMCMOT_VOL_COMP_BATCH 32
+
 /* This is the command structure.  There is one of these in shared
    memory, and all commands from higher level code come thru it.
 */
@@ -217,11 +227,15 @@ extern "C" {
 	double vel;		/* max velocity */
         double ini_maxvel;      /* max velocity allowed by machine
                                    constraints (the ini file) */
+        double planned_vel;     /* corner speed cap at the start of the
+                                   move, planned in userspace, < 0 if none */
         int motion_type;        /* this move is because of traverse, feed, arc, or toolchange */
         double spindlesync;     /* user units per spindle revolution, 0 = no sync */
 	double acc;		/* max acceleration */
 	double backlash;	/* amount of backlash */
 	int id;			/* id for motion */
+	int planner;		/* auxiliary planner, 1..num_aux_planners */
+	int axis_mask;		/* axes driven by it, bit 0 = X .. bit 8 = W */
 	int termCond;		/* termination condition */
 	double tolerance;	/* tolerance for path deviation in CONTINUOUS mode */
 	int axis;		/* which index to use for below */ //FIXME-AJ: replace with joint
@@ -233,6 +247,9 @@ extern "C" {
 	double latch_vel;	/* home latch velocity */
 	int flags;		/* homing config flags, other boolean args */
 	int home_sequence;      /* order in homing sequence */
+	int home_group;		/* joints in different groups home
+				   independently of each other */
+	double search_jerk;	/* jerk limit stopping the home search */
         int volatile_home;      /* joint should get unhomed when we get unhome -2 
                                    (generated by task upon estop, etc) */
 	double minFerror;	/* min following error */
@@ -243,6 +260,11 @@ extern "C" {
 	unsigned char now, start, end;	/* now=wether now or synched, start=start value, end=end value */
 	unsigned char mode;	/* used for turning overrides etc. on/off */
 	double comp_nominal, comp_forward, comp_reverse; /* compensation triplet, nominal, forward, reverse */
+	PmCartesian vol_origin, vol_step; /* volumetric comp grid origin and spacing */
+	int vol_count[3];       /* volumetric comp grid points along x, y, z */
+	int vol_index;          /* volumetric comp grid point of vol_trim[0], x varies fastest */
+	int vol_points;         /* volumetric comp corrections in vol_trim */
+	PmCartesian vol_trim[EMCMOT_VOL_COMP_BATCH]; /* from vol_index on */
         unsigned char probe_type; /* ~1 = error if probe operation is unsuccessful (ngc default)
                                      |1 = suppress error, report in # instead
                                      ~2 = move until probe trips (ngc default)
@@ -258,6 +280,8 @@ extern "C" {
         hal_s32_t arcBlendGapCycles;
         double arcBlendRampFreq;
         double arcBlendTangentKinkRatio;
+        hal_bit_t segmentMergeEnable;
+        hal_s32_t jointLimitSamples;
         double maxFeedScale;
     struct state_tag_t tag;
     } emcmot_command_t;
@@ -396,11 +420,13 @@ Suggestion: Split this in to an Error and a Status flag register..
     } emcmot_comp_entry_t; 
 
 
+/* default size of the per joint tables, see motmod screw_comp_size */
 #define EMCMOT_COMP_SIZE 256
     typedef struct {
-	int entries;		/* number of entries in the array */
+	int entries;            /* number of entries in the array */
+	int size;               /* max number of entries */
 	emcmot_comp_entry_t *entry;  /* current entry in array */
-	emcmot_comp_entry_t array[EMCMOT_COMP_SIZE+2];
+	emcmot_comp_entry_t *array;  /* size+2 entries, in HAL shmem */
 	/* +2 because array has -HUGE_VAL and +HUGE_VAL entries at the ends */
     } emcmot_comp_t;
 
@@ -462,6 +488,8 @@ Suggestion: Split this in to an Error and a Status flag register..
 #define HOME_USE_INDEX		2
 #define HOME_IS_SHARED		4
 #define HOME_UNLOCK_FIRST       8
+#define HOME_INDEX_DIRECT	16	/* arm index during the search, no
+					   latch pass (hardware capture) */
 
 /* flags for enabling spindle scaling, feed scaling,
    adaptive feed, and feed hold */
@@ -502,6 +530,10 @@ Suggestion: Split this in to an Error and a Status flag register..
                                    (generated by task upon estop, etc) */
 	double backlash;	/* amount of backlash */
 	int home_sequence;      /* Order in homing sequence */
+	int home_group;		/* sequences of different groups run
+				   concurrently */
+	double home_search_jerk;	/* 0, or jerk limit when the search
+					   finds the switch */
 	emcmot_comp_t comp;	/* leadscrew correction data */
 
 	/* status info - changes regularly */
@@ -514,7 +546,8 @@ Suggestion: Split this in to an Error and a Status flag register..
 	double vel_cmd;		/* comanded joint velocity */
 	double backlash_corr;	/* correction for backlash */
 	double backlash_filt;	/* filtered backlash correction */
-	double backlash_vel;	/* backlash velocity variable */
+	double backlash_vel;    /* backlash velocity variable */
+	double vol_corr;        /* volumetric comp part of backlash_corr */
 	double motor_pos_cmd;	/* commanded position, with comp */
 	double motor_pos_fb;	/* position feedback, with comp */
 	double pos_fb;		/* position feedback, comp removed */
@@ -523,6 +556,9 @@ Suggestion: Split this in to an Error and a Status flag register..
 	double ferror_high_mark;	/* max following error */
 	double free_pos_cmd;	/* position command for free mode TP */
 	double free_vel_lim;	/* velocity limit for free mode TP */
+	double free_jerk_lim;	/* if non-zero, free mode TP ramps are
+				   jerk limited */
+	double acc_cmd;		/* commanded joint acceleration */
 	int free_tp_enable;	/* if zero, joint stops ASAP */
 	int free_tp_active;	/* if non-zero, move in progress */
 	int kb_jog_active;	/* non-zero during a keyboard jog */
@@ -612,6 +648,31 @@ Suggestion: Split this in to an Error and a Status flag register..
    evaluated - either they move up, or they go away.
 */
 
+/* status of an auxiliary coordinated planner. It runs in the same servo
+   cycle as the main planner, from its own queue, and its commanded
+   position replaces that of the main planner for the axes in axis_mask.
+   The fields below pos are written by the planner itself, through its
+   own tp_shared_t, and mirror those of the main planner in
+   emcmot_status_t. */
+    typedef struct {
+	int axis_mask;		/* axes it drives, 0 = unused */
+	int id;			/* id of the executing move */
+	int depth;		/* motion queue depth */
+	int queueFull;		/* no room for another move */
+	int done;		/* queue empty and motion complete */
+	EmcPose pos;		/* commanded position of its axes */
+
+	double distance_to_go;
+	EmcPose dtg;
+	double current_vel;
+	double requested_vel;
+	hal_u32_t tcqlen;
+	hal_u32_t enables_queued;
+	hal_bit_t spindleSync;
+	hal_bit_t spindle_index_enable;
+	double spindle_speed;
+    } emcmot_aux_status_t;
+
     typedef struct emcmot_status_t {
 	unsigned char head;	/* flag count for mutex detect */
 	/* these three are updated only when a new command is handled */
@@ -703,6 +764,9 @@ Suggestion: Split this in to an Error and a Status flag register..
 	EmcPose pause_offset_carte_pos;	// ipp + current offset values, set by update_offset_pose()
 	int current_request;    // one of enum pause_request
 
+	int num_aux_planners;	/* from the num_aux_planners module param */
+	emcmot_aux_status_t aux[EMCMOT_MAX_AUX_PLANNERS];
+
 	unsigned char tail;	/* flag count for mutex detect */
 
     } emcmot_status_t;
@@ -763,6 +827,7 @@ Suggestion: Split this in to an Error and a Status flag register..
 	vtkins_t *vtk;          // pointer to kinematics vtable
 	vtp_t    *vtp;          // pointer to tp vtable
 	int kins_vid;           // HAL id of kins vtable
+	int kins_version;       // VTKINEMATICS_VERSION of the kins vtable
 	int tp_vid;             // HAL id of tp vtable
 	int debug;		/* copy of DEBUG, from .ini file */
 	unsigned char tail;	/* flag count for mutex detect */
@@ -772,6 +837,8 @@ Suggestion: Split this in to an Error and a Status flag register..
         hal_s32_t arcBlendGapCycles;
         double arcBlendRampFreq;
         double arcBlendTangentKinkRatio;
+        hal_bit_t segmentMergeEnable;
+        hal_s32_t jointLimitSamples;
         double maxFeedScale;
     } emcmot_config_t;
 
@@ -80,6 +80,11 @@ typedef struct emcmot_debug_t {
 	TP_STRUCT altqueue;	/* coordinated mode planner */
 	TC_STRUCT altqueueTcSpace[DEFAULT_ALT_TC_QUEUE_SIZE + 10];
 
+	/* auxiliary coordinated planners, see emcmot_aux_status_t */
+	tp_shared_t *auxtps[EMCMOT_MAX_AUX_PLANNERS];
+	TP_STRUCT auxqueue[EMCMOT_MAX_AUX_PLANNERS];
+	TC_STRUCT auxqueueTcSpace[EMCMOT_MAX_AUX_PLANNERS][DEFAULT_AUX_TC_QUEUE_SIZE + 10];
+
 
 	EmcPose oldPos;		/* last position, used for vel differencing */
 	EmcPose oldVel, newVel;	/* velocities, used for acc differencing */
@@ -108,6 +113,11 @@ typedef struct emcmot_debug_t {
 	emcmot_joint_t joints[EMCMOT_MAX_JOINTS];	/* joint data */
 #endif
 
+	/* log2 histograms of per-stage servo cycle times, in clocks
+	   (only updated while motion.servo.stage-timing is set, cleared
+	   when it is set; read out as motion.servo.stage.<name>.p99) */
+	unsigned int stageHist[EMCMOT_NUM_STAGES][EMCMOT_STAGE_HIST_BINS];
+
 	double start_time;
 	double running_time;
 	double cur_time;
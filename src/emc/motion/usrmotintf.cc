@@ -20,6 +20,7 @@
 #include <sys/stat.h>
 #include <string.h>		/* memcpy() */
 #include <float.h>		/* DBL_MIN */
+#include <math.h>		/* fabs(), floor() */
 #include "motion.h"		/* emcmot_status_t,CMD */
 #include "motion_debug.h"       /* emcmot_debug_t */
 #include "motion_struct.h"      /* emcmot_struct_t */
@@ -743,6 +744,12 @@ int usrmotExit(void)
 	(where forward_trim = nominal - forward
 	       reverse_trim = nominal - reverse)
 */
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return x < y ? -1 : x > y;
+}
+
 int usrmotLoadComp(int joint, const char *file, int type)
 {
     FILE *fp;
@@ -796,6 +803,150 @@ int usrmotLoadComp(int joint, const char *file, int type)
 }
 
 
+/* sorted distinct values of one coordinate of the grid points */
+static int vol_grid_axis(double *v, int n, double *origin, double *step)
+{
+    int i, count = 1;
+    qsort(v, n, sizeof(double), cmp_double);
+    for (i = 1; i < n; i++) {
+	if (v[i] - v[count - 1] > 1e-9) {
+	    v[count++] = v[i];
+	}
+    }
+    *origin = v[0];
+    *step = count > 1 ? (v[count - 1] - v[0]) / (count - 1) : 1.0;
+    /* the spacing must be regular */
+    for (i = 1; i < count; i++) {
+	if (fabs(v[i] - (v[0] + i * *step)) > 1e-6 * *step) {
+	    return -1;
+	}
+    }
+    return count;
+}
+
+/*
+  usrmotLoadVolComp(const char *file)
+
+  The file has one line per grid point, "x y z dx dy dz": the nominal
+  position of joints 0, 1 and 2 and the correction to add to each.
+  Blank lines and lines starting with '#' are ignored.  The points
+  may be in any order but must make up a complete regular grid.
+*/
+int usrmotLoadVolComp(const char *file)
+{
+    FILE *fp;
+    char buffer[LINELEN];
+    double p[6];
+    double *pts = 0, *axis = 0;
+    PmCartesian *trim = 0;
+    char *seen = 0;
+    int n = 0, alloc = 0, i, k, idx[3], count[3];
+    double origin[3], step[3];
+    int ret = -1;
+    emcmot_command_t emcmotCommand;
+
+    if (NULL == (fp = fopen(file, "r"))) {
+	fprintf(stderr, "can't open volumetric compensation file %s\n", file);
+	return -1;
+    }
+    while (NULL != fgets(buffer, LINELEN, fp)) {
+	char *c = buffer + strspn(buffer, " \t");
+	if (*c == '#' || *c == '\n' || *c == '\r' || *c == 0) {
+	    continue;
+	}
+	if (6 != sscanf(c, "%lf %lf %lf %lf %lf %lf",
+			&p[0], &p[1], &p[2], &p[3], &p[4], &p[5])) {
+	    fprintf(stderr, "%s: bad line: %s", file, buffer);
+	    goto out;
+	}
+	if (n == alloc) {
+	    alloc = alloc ? 2 * alloc : 1024;
+	    double *tmp = (double *) realloc(pts, alloc * 6 * sizeof(double));
+	    if (!tmp) {
+		goto out;
+	    }
+	    pts = tmp;
+	}
+	memcpy(&pts[6 * n++], p, sizeof(p));
+    }
+    if (n == 0) {
+	fprintf(stderr, "%s: no compensation points\n", file);
+	goto out;
+    }
+
+    /* work out the grid from the distinct coordinates along each axis */
+    axis = (double *) malloc(n * sizeof(double));
+    if (!axis) {
+	goto out;
+    }
+    for (k = 0; k < 3; k++) {
+	for (i = 0; i < n; i++) {
+	    axis[i] = pts[6 * i + k];
+	}
+	count[k] = vol_grid_axis(axis, n, &origin[k], &step[k]);
+	if (count[k] < 0) {
+	    fprintf(stderr, "%s: points are not on a regular grid\n", file);
+	    goto out;
+	}
+    }
+    if (count[0] * count[1] * count[2] != n) {
+	fprintf(stderr, "%s: %d points do not make a complete %d x %d x %d grid\n",
+		file, n, count[0], count[1], count[2]);
+	goto out;
+    }
+
+    /* put the corrections in grid order, x varying fastest */
+    trim = (PmCartesian *) malloc(n * sizeof(PmCartesian));
+    seen = (char *) calloc(n, 1);
+    if (!trim || !seen) {
+	goto out;
+    }
+    for (i = 0; i < n; i++) {
+	for (k = 0; k < 3; k++) {
+	    idx[k] = (int) floor((pts[6 * i + k] - origin[k]) / step[k] + 0.5);
+	}
+	k = idx[0] + count[0] * (idx[1] + count[1] * idx[2]);
+	if (seen[k]) {
+	    fprintf(stderr, "%s: duplicate point %g %g %g\n", file,
+		    pts[6 * i], pts[6 * i + 1], pts[6 * i + 2]);
+	    goto out;
+	}
+	seen[k] = 1;
+	trim[k].x = pts[6 * i + 3];
+	trim[k].y = pts[6 * i + 4];
+	trim[k].z = pts[6 * i + 5];
+    }
+
+    emcmotCommand.command = EMCMOT_SET_VOL_COMP_GRID;
+    emcmotCommand.vol_origin.x = origin[0];
+    emcmotCommand.vol_origin.y = origin[1];
+    emcmotCommand.vol_origin.z = origin[2];
+    emcmotCommand.vol_step.x = step[0];
+    emcmotCommand.vol_step.y = step[1];
+    emcmotCommand.vol_step.z = step[2];
+    for (k = 0; k < 3; k++) {
+	emcmotCommand.vol_count[k] = count[k];
+    }
+    ret = usrmotWriteEmcmotCommand(&emcmotCommand);
+    for (i = 0; i < n && ret == 0; i += emcmotCommand.vol_points) {
+	emcmotCommand.command = EMCMOT_SET_VOL_COMP_POINTS;
+	emcmotCommand.vol_index = i;
+	emcmotCommand.vol_points = n - i < EMCMOT_VOL_COMP_BATCH ?
+	    n - i : EMCMOT_VOL_COMP_BATCH;
+	memcpy(emcmotCommand.vol_trim, &trim[i],
+	       emcmotCommand.vol_points * sizeof(PmCartesian));
+	ret = usrmotWriteEmcmotCommand(&emcmotCommand);
+    }
+
+out:
+    fclose(fp);
+    free(pts);
+    free(axis);
+    free(trim);
+    free(seen);
+    return ret;
+}
+
 int usrmotPrintComp(int joint)
 {
 /* FIXME-AJ: comp isn't in shmem atm
@@ -378,6 +378,12 @@ int emcFormat(NMLTYPE type, void *buffer, CMS * cms)
     case EMC_TRAJ_RIGID_TAP_TYPE:
 	((EMC_TRAJ_RIGID_TAP *) buffer)->update(cms);
         break;
+    case EMC_TRAJ_AUX_LINEAR_MOVE_TYPE:
+	((EMC_TRAJ_AUX_LINEAR_MOVE *) buffer)->update(cms);
+	break;
+    case EMC_TRAJ_AUX_ABORT_TYPE:
+	((EMC_TRAJ_AUX_ABORT *) buffer)->update(cms);
+	break;
     case EMC_TRAJ_PAUSE_TYPE:
 	((EMC_TRAJ_PAUSE *) buffer)->update(cms);
 	break;
@@ -707,6 +713,10 @@ const char *emc_symbol_lookup(long type)
 	return "EMC_AUX_INPUT_WAIT";
     case EMC_TRAJ_RIGID_TAP_TYPE:
 	return "EMC_TRAJ_RIGID_TAP";
+    case EMC_TRAJ_AUX_LINEAR_MOVE_TYPE:
+	return "EMC_TRAJ_AUX_LINEAR_MOVE";
+    case EMC_TRAJ_AUX_ABORT_TYPE:
+	return "EMC_TRAJ_AUX_ABORT";
     case EMC_TRAJ_RESUME_TYPE:
 	return "EMC_TRAJ_RESUME";
     case EMC_TRAJ_SET_ACCELERATION_TYPE:
@@ -1515,6 +1525,7 @@ void EMC_TRAJ_LINEAR_MOVE::update(CMS * cms)
     cms->update(acc);
     cms->update(feed_mode);
     cms->update(indexrotary);
+    cms->update(planned_vel);
 }
 
 /*
@@ -1537,6 +1548,7 @@ void EMC_TRAJ_CIRCULAR_MOVE::update(CMS * cms)
     cms->update(ini_maxvel);
     cms->update(acc);
     cms->update(feed_mode);
+    cms->update(planned_vel);
 
 }
 
@@ -1937,6 +1949,12 @@ void EMC_TASK_STAT::update(CMS * cms)
     cms->update(interpreter_errcode);
     cms->update(input_timeout);
     cms->update(rotation_xy);
+    cms->update((int *) &prescanState, 1);
+    cms->update(prescanErrorLine);
+    cms->update(prescanTime);
+    EmcPose_update(cms, &prescanMin);
+    EmcPose_update(cms, &prescanMax);
+    cms->update(prescanFile, 256);
 
 }
 
@@ -2631,6 +2649,9 @@ void EMC_AXIS_SET_HOMING_PARAMS::update(CMS * cms)
     cms->update(ignore_limits);
     cms->update(volatile_home);
     cms->update(locking_indexer);
+    cms->update(home_group);
+    cms->update(search_jerk);
+    cms->update(index_direct);
 
 }
 
@@ -2853,6 +2874,27 @@ void EMC_TRAJ_RIGID_TAP::update(CMS * cms)
 
 }
 
+void EMC_TRAJ_AUX_LINEAR_MOVE::update(CMS * cms)
+{
+
+    EMC_TRAJ_CMD_MSG::update(cms);
+    cms->update(planner);
+    cms->update(id);
+    EmcPose_update(cms, &end);
+    cms->update(vel);
+    cms->update(ini_maxvel);
+    cms->update(acc);
+
+}
+
+void EMC_TRAJ_AUX_ABORT::update(CMS * cms)
+{
+
+    EMC_TRAJ_CMD_MSG::update(cms);
+    cms->update(planner);
+
+}
+
 
 /*
 *	NML/CMS Update function for EMC_LUBE_OFF
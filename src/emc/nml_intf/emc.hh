@@ -144,6 +144,8 @@ struct PM_CARTESIAN;
 #define EMC_TRAJ_SET_SO_ENABLE_TYPE                  ((NMLTYPE) 235)
 #define EMC_TRAJ_SET_FH_ENABLE_TYPE                  ((NMLTYPE) 236)
 #define EMC_TRAJ_RIGID_TAP_TYPE                      ((NMLTYPE) 237)
+#define EMC_TRAJ_AUX_LINEAR_MOVE_TYPE                ((NMLTYPE) 239)
+#define EMC_TRAJ_AUX_ABORT_TYPE                      ((NMLTYPE) 240)
 
 #define EMC_TRAJ_STAT_TYPE                           ((NMLTYPE) 299)
 
@@ -322,6 +324,14 @@ enum EMC_TASK_INTERP_ENUM {
     EMC_TASK_INTERP_WAITING = 4
 };
 
+// state of the background pre-scan of the open program
+enum EMC_TASK_PRESCAN_ENUM {
+    EMC_TASK_PRESCAN_NONE = 1,
+    EMC_TASK_PRESCAN_RUNNING = 2,
+    EMC_TASK_PRESCAN_DONE = 3,
+    EMC_TASK_PRESCAN_ERROR = 4
+};
+
 // types for motion control
 enum EMC_TRAJ_MODE_ENUM {
     EMC_TRAJ_MODE_FREE = 1,	// independent-axis motion,
@@ -388,7 +398,8 @@ extern int emcAxisSetMinFerror(int axis, double ferror);
 extern int emcAxisSetHomingParams(int axis, double home, double offset, double home_final_vel,
 				  double search_vel, double latch_vel,
 				  int use_index, int ignore_limits,
-				  int is_shared, int home_sequence, int volatile_home, int locking_indexer);
+				  int is_shared, int home_sequence, int volatile_home, int locking_indexer,
+				  int home_group, double search_jerk, int index_direct);
 extern int emcAxisSetMaxVelocity(int axis, double vel);
 extern int emcAxisSetMaxAcceleration(int axis, double acc);
 
@@ -443,20 +454,27 @@ extern int emcTrajStep();
 extern int emcTrajResume();
 extern int emcTrajDelay(double delay);
 extern int emcTrajLinearMove(EmcPose end, int type, double vel,
-                             double ini_maxvel, double acc, int indexrotary);
+                             double ini_maxvel, double acc, int indexrotary,
+                             double planned_vel);
 extern int emcTrajCircularMove(EmcPose end, PM_CARTESIAN center, PM_CARTESIAN
-        normal, int turn, int type, double vel, double ini_maxvel, double acc);
+        normal, int turn, int type, double vel, double ini_maxvel, double acc,
+        double planned_vel);
 extern int emcTrajSetTermCond(int cond, double tolerance);
 extern int emcTrajSetSpindleSync(double feed_per_revolution, bool wait_for_index);
 extern int emcTrajSetOffset(EmcPose tool_offset);
 extern int emcTrajSetOrigin(EmcPose origin);
 extern int emcTrajSetRotation(double rotation);
 extern int emcTrajSetHome(EmcPose home);
+extern int emcTrajLoadVolComp(const char *file);
 extern int emcTrajClearProbeTrippedFlag();
 extern int emcTrajProbe(EmcPose pos, int type, double vel, 
                         double ini_maxvel, double acc, unsigned char probe_type);
 extern int emcAuxInputWait(int index, int input_type, int wait_type, int timeout);
 extern int emcTrajRigidTap(EmcPose pos, double vel, double ini_maxvel, double acc);
+extern int emcTrajSetAuxPlanner(int planner, int axis_mask);
+extern int emcTrajAuxLinearMove(int planner, int id, EmcPose end, double vel,
+                                double ini_maxvel, double acc);
+extern int emcTrajAuxAbort(int planner);
 
 extern int emcTrajUpdate(EMC_TRAJ_STAT * stat);
 
@@ -556,7 +574,9 @@ int emcSetupArcBlends(int arcBlendEnable,
         int arcBlendOptDepth,
         int arcBlendGapCycles,
         double arcBlendRampFreq,
-        double arcBlendTangentKinkRatio);
+        double arcBlendTangentKinkRatio,
+        int segmentMergeEnable,
+        int jointLimitSamples);
 
 extern int emcUpdate(EMC_STAT * stat);
 // full EMC status
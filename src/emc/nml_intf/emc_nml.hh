@@ -269,6 +269,9 @@ class EMC_AXIS_SET_HOMING_PARAMS:public EMC_AXIS_CMD_MSG {
     int home_sequence;
     int volatile_home;
     int locking_indexer;
+    int home_group;
+    double search_jerk;
+    int index_direct;
 };
 
 class EMC_AXIS_SET_MAX_VELOCITY:public EMC_AXIS_CMD_MSG {
@@ -781,7 +784,8 @@ class EMC_TRAJ_DELAY:public EMC_TRAJ_CMD_MSG {
 class EMC_TRAJ_LINEAR_MOVE:public EMC_TRAJ_CMD_MSG {
   public:
     EMC_TRAJ_LINEAR_MOVE():EMC_TRAJ_CMD_MSG(EMC_TRAJ_LINEAR_MOVE_TYPE,
-					    sizeof(EMC_TRAJ_LINEAR_MOVE)) {
+					    sizeof(EMC_TRAJ_LINEAR_MOVE)),
+	planned_vel(-1.0) {
     };
 
     // For internal NML/CMS use only.
@@ -792,13 +796,15 @@ class EMC_TRAJ_LINEAR_MOVE:public EMC_TRAJ_CMD_MSG {
     double vel, ini_maxvel, acc;
     int feed_mode;
     int indexrotary;
+    double planned_vel;		// corner speed cap at the start, < 0 if none
 };
 
 class EMC_TRAJ_CIRCULAR_MOVE:public EMC_TRAJ_CMD_MSG {
   public:
     EMC_TRAJ_CIRCULAR_MOVE():EMC_TRAJ_CMD_MSG(EMC_TRAJ_CIRCULAR_MOVE_TYPE,
 					      sizeof
-					      (EMC_TRAJ_CIRCULAR_MOVE)) {
+					      (EMC_TRAJ_CIRCULAR_MOVE)),
+	planned_vel(-1.0) {
     };
 
     // For internal NML/CMS use only.
@@ -811,6 +817,7 @@ class EMC_TRAJ_CIRCULAR_MOVE:public EMC_TRAJ_CMD_MSG {
     int type;
     double vel, ini_maxvel, acc;
     int feed_mode;
+    double planned_vel;		// corner speed cap at the start, < 0 if none
 };
 
 class EMC_TRAJ_SET_TERM_COND:public EMC_TRAJ_CMD_MSG {
@@ -964,6 +971,38 @@ class EMC_TRAJ_RIGID_TAP:public EMC_TRAJ_CMD_MSG {
     double vel, ini_maxvel, acc;
 };
 
+/* A linear move on an auxiliary planner. These bypass the interpreter
+   and run alongside the program, each planner driving only the axes
+   assigned to it in the ini file, which are the only ones taken from
+   end. */
+class EMC_TRAJ_AUX_LINEAR_MOVE:public EMC_TRAJ_CMD_MSG {
+  public:
+    EMC_TRAJ_AUX_LINEAR_MOVE():EMC_TRAJ_CMD_MSG(EMC_TRAJ_AUX_LINEAR_MOVE_TYPE,
+					    sizeof(EMC_TRAJ_AUX_LINEAR_MOVE)),
+	planner(1), id(0) {
+    };
+
+    // For internal NML/CMS use only.
+    void update(CMS * cms);
+
+    int planner;		// 1 .. number of auxiliary planners
+    int id;			// reported back in EMC_TRAJ_STAT auxId
+    EmcPose end;
+    double vel, ini_maxvel, acc;
+};
+
+class EMC_TRAJ_AUX_ABORT:public EMC_TRAJ_CMD_MSG {
+  public:
+    EMC_TRAJ_AUX_ABORT():EMC_TRAJ_CMD_MSG(EMC_TRAJ_AUX_ABORT_TYPE,
+				      sizeof(EMC_TRAJ_AUX_ABORT)), planner(1) {
+    };
+
+    // For internal NML/CMS use only.
+    void update(CMS * cms);
+
+    int planner;
+};
+
 // EMC_TRAJ status base class
 class EMC_TRAJ_STAT_MSG:public RCS_STAT_MSG {
   public:
@@ -1024,6 +1063,9 @@ class EMC_TRAJ_STAT:public EMC_TRAJ_STAT_MSG {
     bool spindle_override_enabled;
     bool adaptive_feed_enabled;
     bool feed_hold_enabled;
+    int auxPlanners;		// number of auxiliary planners
+    int auxQueue[EMCMOT_MAX_AUX_PLANNERS];	// pending motions on each
+    int auxId[EMCMOT_MAX_AUX_PLANNERS];	// executing motion on each
     StateTag tag;
 };
 
@@ -1438,6 +1480,14 @@ class EMC_TASK_STAT:public EMC_TASK_STAT_MSG {
     int task_paused;		// non-zero means task is paused
     double delayLeft;           // delay time left of G4, M66..
     int queuedMDIcommands;      // current length of MDI input queue
+
+    // summary of the open program, from the background pre-scan
+    enum EMC_TASK_PRESCAN_ENUM prescanState;
+    int prescanErrorLine;	// line of the first error found, 0 if none
+    double prescanTime;		// estimated run time, in seconds
+    EmcPose prescanMin;		// extents of the moves, machine coordinates
+    EmcPose prescanMax;
+    char prescanFile[LINELEN];	// the full summary (see emc/task/prescan.cc)
 };
 
 // declarations for EMC_TOOL classes
@@ -37,6 +37,7 @@ char tool_table_file[LINELEN] = DEFAULT_TOOL_TABLE_FILE;
 
 double traj_default_velocity = DEFAULT_TRAJ_DEFAULT_VELOCITY;
 double traj_max_velocity = DEFAULT_TRAJ_MAX_VELOCITY;
+double traj_preplan_max_jerk = 0.0;
 
 double axis_max_velocity[EMC_AXIS_MAX] = { 1.0 };	/*! \todo FIXME - I think
 							   these should be
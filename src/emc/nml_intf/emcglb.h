@@ -57,6 +57,8 @@ extern "C" {
 
     extern double traj_default_velocity;
     extern double traj_max_velocity;
+/* jerk limit for the corner and arc speed caps set by canon, 0 = none */
+    extern double traj_preplan_max_jerk;
 
     extern double axis_max_velocity[EMC_AXIS_MAX];
     extern double axis_max_acceleration[EMC_AXIS_MAX];
@@ -88,6 +88,11 @@ EMC_TRAJ_STAT_MSG(EMC_TRAJ_STAT_TYPE, sizeof(EMC_TRAJ_STAT)),
     spindle_override_enabled = OFF;
     adaptive_feed_enabled = OFF;
     feed_hold_enabled = OFF;
+    auxPlanners = 0;
+    for (int t = 0; t < EMCMOT_MAX_AUX_PLANNERS; t++) {
+	auxQueue[t] = 0;
+	auxId[t] = 0;
+    }
 }
 
 EMC_MOTION_STAT::EMC_MOTION_STAT():
@@ -145,6 +150,13 @@ EMC_TASK_STAT_MSG(EMC_TASK_STAT_TYPE, sizeof(EMC_TASK_STAT))
     task_paused = 0;
     delayLeft = 0.0;
     queuedMDIcommands = 0;
+
+    prescanState = EMC_TASK_PRESCAN_NONE;
+    prescanErrorLine = 0;
+    prescanTime = 0.0;
+    ZERO_EMC_POSE(prescanMin);
+    ZERO_EMC_POSE(prescanMax);
+    prescanFile[0] = 0;
 }
 
 EMC_TOOL_STAT::EMC_TOOL_STAT():
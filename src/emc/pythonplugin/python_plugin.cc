@@ -77,6 +77,45 @@ int PythonPlugin::call_method(bp::object method, bp::object &retval)
 
 }
 
+// Find [module.]callable the way main_namespace[module].__dict__[callable]
+// does, with the names interned once instead of converted on every call,
+// and without raising KeyError for a name that is not there, which
+// is_callable() gets asked about on every o-word call read. The callable
+// itself is looked up every time since the modules may rebind it.
+bool PythonPlugin::lookup(const char *module, const char *callable,
+			  bp::object &function)
+{
+    std::string key = module ? std::string(module) + "." + callable : callable;
+    std::map<std::string, std::pair<bp::object, bp::object> >::iterator it;
+    PyObject *ns, *mod, *found;
+    bp::object dict;
+
+    it = callable_names.find(key);
+    if (it == callable_names.end()) {
+	bp::object m;
+	if (module)
+	    m = bp::object(bp::handle<>(PyString_InternFromString(module)));
+	bp::object c(bp::handle<>(PyString_InternFromString(callable)));
+	it = callable_names.insert(std::make_pair(key, std::make_pair(m, c))).first;
+    }
+    ns = main_namespace.ptr();
+    if (module) {
+	if ((mod = PyDict_GetItem(ns, it->second.first.ptr())) == NULL)
+	    return false;
+	if (PyModule_Check(mod)) {
+	    ns = PyModule_GetDict(mod);
+	} else {
+	    dict = bp::object(bp::borrowed(mod)).attr("__dict__");
+	    ns = dict.ptr();
+	}
+    }
+    if (!PyDict_Check(ns) ||
+	(found = PyDict_GetItem(ns, it->second.second.ptr())) == NULL)
+	return false;
+    function = bp::object(bp::borrowed(found));
+    return true;
+}
+
 int PythonPlugin::call(const char *module, const char *callable,
 		       bp::object tupleargs, bp::object kwargs, bp::object &retval)
 {
@@ -91,12 +130,9 @@ int PythonPlugin::call(const char *module, const char *callable,
 	return status;
 
     try {
-	if (module == NULL) {  // default to function in toplevel module
-	    function = main_namespace[callable];
-	} else {
-	    bp::object submod =  main_namespace[module];
-	    bp::object submod_namespace = submod.attr("__dict__");
-	    function = submod_namespace[callable];
+	if (!lookup(module, callable, function)) {
+	    PyErr_SetString(PyExc_KeyError, callable);
+	    bp::throw_error_already_set();
 	}
 	// this wont work with boost-python1.34 - needs 1.40
 	//retval = function(*tupleargs, **kwargs);
@@ -142,22 +178,13 @@ bool PythonPlugin::is_callable(const char *module,
 	return false;
     }
     try {
-	if (module == NULL) {  // default to function in toplevel module
-	   function = main_namespace[funcname];
-	} else {
-	    bp::object submod =  main_namespace[module];
-	    bp::object submod_namespace = submod.attr("__dict__");
-	    function = submod_namespace[funcname];
-	}
-	result = PyCallable_Check(function.ptr());
+	result = lookup(module, funcname, function) &&
+	    PyCallable_Check(function.ptr());
     }
     catch (bp::error_already_set) {
-	// KeyError expected if not callable
-	if (!PyErr_ExceptionMatches(PyExc_KeyError)) {
-	    // something else, strange
-	    exception_msg = handle_pyerror();
-	    unexpected = true;
-	}
+	// a module whose __dict__ can't be had, strange
+	exception_msg = handle_pyerror();
+	unexpected = true;
 	result = false;
 	PyErr_Clear();
     }
@@ -6,6 +6,7 @@ namespace bp = boost::python;
 
 #include <vector>
 #include <string>
+#include <map>
 #include <sys/types.h>
 
 
@@ -61,7 +62,10 @@ private:
     ~PythonPlugin() {};
 
     int reload();
+    bool lookup(const char *module, const char *callable, bp::object &function);
     std::vector<std::string> inittab_entries;
+    // module.callable -> interned module and callable names, see lookup()
+    std::map<std::string, std::pair<bp::object, bp::object> > callable_names;
     int status;
     time_t module_mtime;                  // toplevel module - last modification time
     bool reload_on_change;                // auto-reload if toplevel module was changed
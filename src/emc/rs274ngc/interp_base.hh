@@ -16,6 +16,7 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 #include <stdlib.h>
+#include <string>
 #include <emcpos.h>
 #include <modal_state.hh>
 
@@ -44,6 +45,7 @@ public:
     virtual int read() = 0;
     virtual int read(const char *line) = 0;
     virtual int close() = 0;
+    virtual int forked() = 0;
     virtual int reset() = 0;
     virtual int line() = 0;
     virtual int call_level() = 0;
@@ -58,6 +60,8 @@ public:
             double settings[ACTIVE_SETTINGS],
             StateTag const &tag) = 0;
     virtual int restore_from_tag(StateTag const &tag) = 0;
+    virtual int save_checkpoint(std::string &state) = 0;
+    virtual int restore_checkpoint(const char *state) = 0;
     virtual void set_loglevel(int level) = 0;
 };
 
@@ -0,0 +1,509 @@
+/********************************************************************
+* Description: interp_checkpoint.cc
+*
+*   Checkpoints of the interpreter state, for run from line.
+*
+* Author:
+* License: GPL Version 2
+* System: Linux
+*
+* Copyright (c) 2026 All rights reserved.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+********************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <boost/python.hpp>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <algorithm>
+#include "rs274ngc.hh"
+#include "rs274ngc_return.hh"
+#include "interp_internal.hh"
+#include "rs274ngc_interp.hh"
+#include "inifile.hh"		// strstore()
+
+/*
+
+To run a program from line N, task reads and executes every line before
+N and throws away what they queue, which takes long on large programs.
+A checkpoint is the state of the interpreter at the end of a line of the
+top level, as text which task keeps:
+
+  checkpoint <line> <file offset> <origin>
+  g <active G codes>
+  m <active M codes>
+  s <active settings>
+  c <motion mode> <cycle r p q l i j k cc>
+  t <tool offset x y z a b c u v w>
+  v <_value> <_value_returned>
+  p <number> <value>                     numbered parameters not zero
+  n <value> <attr> <name>                named parameters of level 0
+  o <type> <offset> <line> <repeat count> <label> <file>
+  end
+
+Restoring one seeks the file to the offset, so reading goes on with
+line + 1.
+
+The origin is a hash of the records from g to n as they were when the
+program started. A checkpoint is only restored into an interpreter
+which has not read anything yet and whose state hashes the same, so
+one taken before the operator touched off or set a parameter is not
+used.
+
+Parameters which the machine supplies (the tool, the position, the
+tool changer status) are neither saved nor restored, synch() sets
+them. Checkpoints are only taken at call level 0 with no remap, sub
+definition, skip or Python handler in progress and with cutter
+compensation off and not just turned off; the o-word labels seen so
+far are saved, which is all a loop or a sub call of the top level
+needs to continue.
+
+Modal state is restored the way restore_settings() does it, by executing
+the difference as G and M codes so canon sees the changes. The
+coordinate system and the G92 offsets are always executed, since the
+parameters they come from may have changed. Motion mode and canned
+cycle values only exist in the interpreter and are set directly.
+
+*/
+
+// the tool, position and tool changer parameters synch() refreshes
+static bool checkpoint_param(int index)
+{
+    return !((index >= 5400 && index <= 5413) ||
+	     (index >= 5420 && index <= 5428) ||
+	     index == 5600 || index == 5601);
+}
+
+// FNV-1a
+static uint64_t checkpoint_hash(const std::string &text)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < text.size(); i++) {
+	hash ^= (unsigned char) text[i];
+	hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/****************************************************************************/
+
+/*! checkpoint_state
+
+Returned Value: none
+
+Side effects:
+   The g to n records of the current state are appended to state.
+
+Called by: save_checkpoint, restore_checkpoint, read
+
+*/
+
+void Interp::checkpoint_state(std::string &state)
+{
+  char buf[LINELEN + 64];
+  int n, i;
+
+  // the state is sprinkled all over _setup
+  write_g_codes((block_pointer) NULL, &_setup);
+  write_m_codes((block_pointer) NULL, &_setup);
+  write_settings(&_setup);
+
+  n = snprintf(buf, sizeof(buf), "g");
+  for (i = 1; i < ACTIVE_G_CODES; i++)
+    n += snprintf(buf + n, sizeof(buf) - n, " %d", _setup.active_g_codes[i]);
+  state += buf;
+  n = snprintf(buf, sizeof(buf), "\nm");
+  for (i = 1; i < ACTIVE_M_CODES; i++)
+    n += snprintf(buf + n, sizeof(buf) - n, " %d", _setup.active_m_codes[i]);
+  state += buf;
+  snprintf(buf, sizeof(buf), "\ns %.17g %.17g\n",
+	   _setup.active_settings[1], _setup.active_settings[2]);
+  state += buf;
+  snprintf(buf, sizeof(buf), "c %d %.17g %.17g %.17g %d %.17g %.17g %.17g %.17g\n",
+	   _setup.motion_mode, _setup.cycle_r, _setup.cycle_p, _setup.cycle_q,
+	   _setup.cycle_l, _setup.cycle_i, _setup.cycle_j, _setup.cycle_k,
+	   _setup.cycle_cc);
+  state += buf;
+  snprintf(buf, sizeof(buf), "t %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g\n",
+	   _setup.tool_offset.tran.x, _setup.tool_offset.tran.y,
+	   _setup.tool_offset.tran.z, _setup.tool_offset.a,
+	   _setup.tool_offset.b, _setup.tool_offset.c,
+	   _setup.tool_offset.u, _setup.tool_offset.v, _setup.tool_offset.w);
+  state += buf;
+  snprintf(buf, sizeof(buf), "v %.17g %d\n",
+	   _setup.return_value, _setup.value_returned);
+  state += buf;
+
+  for (i = 1; i < RS274NGC_MAX_PARAMETERS; i++) {
+    if (_setup.parameters[i] != 0.0 && checkpoint_param(i)) {
+      snprintf(buf, sizeof(buf), "p %d %.17g\n", i, _setup.parameters[i]);
+      state += buf;
+    }
+  }
+
+  parameter_map &named = _setup.sub_context[0].named_params;
+  for (parameter_map_iterator pi = named.begin(); pi != named.end(); pi++) {
+    // computed ones come back by themselves
+    if (pi->second.attr & (PA_READONLY | PA_USE_LOOKUP | PA_FROM_INI | PA_PYTHON))
+      continue;
+    snprintf(buf, sizeof(buf), "n %.17g %u %s\n",
+	     pi->second.value, pi->second.attr, pi->first);
+    state += buf;
+  }
+}
+
+/****************************************************************************/
+
+/*! save_checkpoint
+
+Returned Value: int
+   If the file is not open, this returns NCE_FILE_NOT_OPEN.
+   If the state at this point is not one a checkpoint is taken of (see
+   above), this returns INTERP_ERROR.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The checkpoint replaces what state held.
+
+Called by: external programs
+
+*/
+
+int Interp::save_checkpoint(std::string &state)
+{
+  char buf[2 * LINELEN + PATH_MAX];
+  offset_map_iterator it;
+
+  CHKS((_setup.file_pointer == NULL), NCE_FILE_NOT_OPEN);
+  CHKS((!_setup.checkpoint_origin_valid || (_setup.call_level != 0) ||
+	(_setup.remap_level != 0) || _setup.defining_sub ||
+	_setup.skipping_o || _setup.skipping_to_sub ||
+	(_setup.call_state != CS_NORMAL) || _setup.cutter_comp_side ||
+	_setup.arc_not_allowed),
+       _("No checkpoint at line %d"), _setup.sequence_number);
+
+  snprintf(buf, sizeof(buf), "checkpoint %d %ld %016" PRIx64 "\n",
+	   _setup.sequence_number, file_tell(&_setup),
+	   _setup.checkpoint_origin);
+  state = buf;
+  checkpoint_state(state);
+  for (it = _setup.offset_map.begin(); it != _setup.offset_map.end(); it++) {
+    snprintf(buf, sizeof(buf), "o %d %ld %d %d %s %s\n",
+	     it->second.type, it->second.offset, it->second.sequence_number,
+	     it->second.repeat_count, it->first,
+	     it->second.filename ? it->second.filename : "");
+    state += buf;
+  }
+  state += "end\n";
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! checkpoint_modes
+
+Returned Value: int
+   If a modal code fails to execute, this returns INTERP_ERROR.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The G codes, M codes, settings and tool length offset are g, m, s and
+   tool_offset, changed by executing codes so canon follows. The
+   coordinate system is always selected again, its offsets may have
+   changed.
+
+Called by: restore_checkpoint
+
+*/
+
+int Interp::checkpoint_modes(int *g, int *m, double *s,
+			     const EmcPose &tool_offset)
+{
+  int current[ACTIVE_G_CODES], i;
+  char buf[LINELEN + 64];
+  std::string cmd;
+
+  // G20/G21 first, so the rest is read in the right units
+  if (_setup.active_g_codes[5] != g[5]) {
+    snprintf(buf, sizeof(buf), "G%d", g[5] / 10);
+    CHKS(execute(buf) != INTERP_OK, _("Checkpoint: restoring G20/G21 failed"));
+  }
+  memcpy(current, _setup.active_g_codes, sizeof(current));
+  current[8] = -1;	// always, the offsets may have changed
+  if (g[9] != G_49)
+    current[9] = g[9];	// see below
+  gen_settings((double *) _setup.active_settings, s, cmd);
+  gen_g_codes(current, g, cmd);
+  cmd += "\n";
+  gen_m_codes((int *) _setup.active_m_codes, m, cmd);
+  if (g[9] != G_49) {
+    // G43 H, G43.1 and G43.2 all come back as the offset they added
+    // up to, the tool table may not be the same
+    const char *letters = "XYZABCUVW";
+    double values[9] = { tool_offset.tran.x, tool_offset.tran.y,
+			 tool_offset.tran.z, tool_offset.a, tool_offset.b,
+			 tool_offset.c, tool_offset.u, tool_offset.v,
+			 tool_offset.w };
+    long axis_mask = GET_EXTERNAL_AXIS_MASK();
+    // every axis, G43.1 keeps the old offset of those not given; fixed
+    // notation, the reader does not take exponents
+    cmd += "G43.1";
+    for (i = 0; i < 9; i++) {
+      if (axis_mask & (1 << i)) {
+	snprintf(buf, sizeof(buf), " %c%.10f", letters[i], values[i]);
+	cmd += buf;
+      }
+    }
+    cmd += "\n";
+  }
+  cmd += (_setup.parameters[5210] != 0.0) ? "G92.3\n" : "G92.2\n";
+
+  // the sequence is multiline, separated by nl
+  char lines[cmd.size() + 1];
+  strncpy(lines, cmd.c_str(), sizeof(lines));
+  char *last = lines;
+  char *s_line;
+  while ((s_line = strtok_r(last, "\n", &last)) != NULL) {
+    if (strspn(s_line, " ") == strlen(s_line))
+      continue;
+    int status = execute(s_line);
+    if (status != INTERP_OK) {
+      char currentError[LINELEN+1];
+      strcpy(currentError, getSavedError());
+      CHKS(status, _("Checkpoint: restoring failed executing: '%s': %s"),
+	   s_line, currentError);
+    }
+  }
+
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! restore_checkpoint
+
+Returned Value: int
+   If the file is not open, this returns NCE_FILE_NOT_OPEN.
+   If lines have been read since the file was opened, the checkpoint is
+   not one of this program or not of a program started in the current
+   state, or a modal code of it fails to execute, this returns
+   INTERP_ERROR.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The state is that of the checkpoint, the next line read is the one
+   after its line. Restoring modal codes makes canon calls. If restoring
+   fails once the state has been changed, the parameters, labels and
+   modal codes are put back as they were.
+
+Called by: external programs
+
+*/
+
+int Interp::restore_checkpoint(const char *state)
+{
+  int line, g[ACTIVE_G_CODES], m[ACTIVE_M_CODES];
+  double s[ACTIVE_SETTINGS];
+  int motion_mode, cycle_l, value_returned, index, consumed, i, status;
+  double cycle[7], return_value;
+  EmcPose tool_offset;
+  long position;
+  uint64_t origin;
+  std::vector<std::pair<int, double> > params;
+  std::vector<std::pair<std::string, parameter_value> > named;
+  std::vector<std::pair<std::string, offset> > labels;
+  std::vector<std::string> label_files;
+  std::string text(state), current_state;
+  bool ended = false;
+
+  CHKS((_setup.file_pointer == NULL), NCE_FILE_NOT_OPEN);
+  CHKS((_setup.checkpoint_origin_valid || (_setup.call_level != 0)),
+       _("Cannot restore a checkpoint once the program has started"));
+
+  // parse it all before changing anything
+  CHKS((sscanf(text.c_str(), "checkpoint %d %ld %" SCNx64, &line, &position,
+	       &origin) != 3), _("Bad checkpoint"));
+  g[0] = m[0] = 0;
+  s[0] = 0.0;
+  motion_mode = value_returned = -1;
+  ZERO_EMC_POSE(tool_offset);
+  char *next = strchr(&text[0], '\n');
+  while (!ended && next) {
+    char *record = next + 1;
+    if ((next = strchr(record, '\n')) != NULL)
+      *next = 0;
+    switch (record[0]) {
+    case 'g':
+      for (i = 1, record++; i < ACTIVE_G_CODES; i++, record += consumed)
+	CHKS((sscanf(record, "%d%n", &g[i], &consumed) != 1), _("Bad checkpoint"));
+      break;
+    case 'm':
+      for (i = 1, record++; i < ACTIVE_M_CODES; i++, record += consumed)
+	CHKS((sscanf(record, "%d%n", &m[i], &consumed) != 1), _("Bad checkpoint"));
+      break;
+    case 's':
+      CHKS((sscanf(record, "s %lf %lf", &s[1], &s[2]) != 2), _("Bad checkpoint"));
+      break;
+    case 'c':
+      CHKS((sscanf(record, "c %d %lf %lf %lf %d %lf %lf %lf %lf", &motion_mode,
+		   &cycle[0], &cycle[1], &cycle[2], &cycle_l, &cycle[3],
+		   &cycle[4], &cycle[5], &cycle[6]) != 9), _("Bad checkpoint"));
+      break;
+    case 't':
+      CHKS((sscanf(record, "t %lf %lf %lf %lf %lf %lf %lf %lf %lf",
+		   &tool_offset.tran.x, &tool_offset.tran.y, &tool_offset.tran.z,
+		   &tool_offset.a, &tool_offset.b, &tool_offset.c,
+		   &tool_offset.u, &tool_offset.v, &tool_offset.w) != 9),
+	   _("Bad checkpoint"));
+      break;
+    case 'v':
+      CHKS((sscanf(record, "v %lf %d", &return_value, &value_returned) != 2),
+	   _("Bad checkpoint"));
+      break;
+    case 'p': {
+      double value;
+      CHKS(((sscanf(record, "p %d %lf", &index, &value) != 2) ||
+	    (index < 1) || (index >= RS274NGC_MAX_PARAMETERS)), _("Bad checkpoint"));
+      params.push_back(std::make_pair(index, value));
+      break;
+    }
+    case 'n': {
+      parameter_value value;
+      CHKS((sscanf(record, "n %lf %u %n", &value.value, &value.attr,
+		   &consumed) != 2), _("Bad checkpoint"));
+      named.push_back(std::make_pair(std::string(record + consumed), value));
+      break;
+    }
+    case 'o': {
+      offset o;
+      int label_end = -1, file = -1;
+      CHKS(((sscanf(record, "o %d %ld %d %d %n%*s%n %n", &o.type, &o.offset,
+		    &o.sequence_number, &o.repeat_count, &consumed, &label_end,
+		    &file) != 4) || (label_end < 0)), _("Bad checkpoint"));
+      if (file < 0)
+	file = label_end;
+      o.filename = NULL;
+      labels.push_back(std::make_pair(std::string(record + consumed,
+						  label_end - consumed), o));
+      label_files.push_back(std::string(record + file));
+      break;
+    }
+    case 'e':
+      ended = true;
+      break;
+    }
+  }
+  CHKS((!ended || (motion_mode == -1) || (value_returned == -1)),
+       _("Bad checkpoint"));
+
+  checkpoint_state(current_state);
+  CHKS((checkpoint_hash(current_state) != origin),
+       _("The checkpoint at line %d is of a program started in another state"),
+       line);
+
+  // from here on a failure undoes what was changed
+  std::vector<double> saved_params(_setup.parameters,
+				   _setup.parameters + RS274NGC_MAX_PARAMETERS);
+  parameter_map saved_named(_setup.sub_context[0].named_params);
+  offset_map_type saved_labels(_setup.offset_map);
+  int saved_g[ACTIVE_G_CODES], saved_m[ACTIVE_M_CODES];
+  double saved_s[ACTIVE_SETTINGS];
+  memcpy(saved_g, _setup.active_g_codes, sizeof(saved_g));
+  memcpy(saved_m, _setup.active_m_codes, sizeof(saved_m));
+  memcpy(saved_s, _setup.active_settings, sizeof(saved_s));
+  EmcPose saved_tool_offset = _setup.tool_offset;
+
+  for (i = 1; i < RS274NGC_MAX_PARAMETERS; i++)
+    if (checkpoint_param(i))
+      _setup.parameters[i] = 0.0;
+  for (i = 0; i < (int) params.size(); i++)
+    if (checkpoint_param(params[i].first))
+      _setup.parameters[params[i].first] = params[i].second;
+  for (i = 0; i < (int) named.size(); i++)
+    _setup.sub_context[0].named_params[strstore(named[i].first.c_str())] =
+      named[i].second;
+  _setup.offset_map.clear();
+  for (i = 0; i < (int) labels.size(); i++) {
+    labels[i].second.filename = strstore(label_files[i].c_str());
+    _setup.offset_map[strstore(labels[i].first.c_str())] = labels[i].second;
+  }
+
+  g[4] = G_40;
+  status = checkpoint_modes(g, m, s, tool_offset);
+  if ((status == INTERP_OK) && (file_seek(&_setup, position) != 0)) {
+    setError(_("Checkpoint: cannot seek to line %d"), line);
+    status = INTERP_ERROR;
+  }
+  if (status != INTERP_OK) {
+    // put everything back, or a replay from the top starts from a mix
+    // of the checkpoint and the state the program was opened in
+    std::string error(getSavedError());
+    std::copy(saved_params.begin(), saved_params.end(), _setup.parameters);
+    _setup.sub_context[0].named_params = saved_named;
+    _setup.offset_map = saved_labels;
+    checkpoint_modes(saved_g, saved_m, saved_s, saved_tool_offset);
+    ERS("%s", error.c_str());
+  }
+
+  _setup.motion_mode = motion_mode;
+  _setup.cycle_r = cycle[0];
+  _setup.cycle_p = cycle[1];
+  _setup.cycle_q = cycle[2];
+  _setup.cycle_l = cycle_l;
+  _setup.cycle_i = cycle[3];
+  _setup.cycle_j = cycle[4];
+  _setup.cycle_k = cycle[5];
+  _setup.cycle_cc = cycle[6];
+  _setup.cycle_il_flag = false;
+  _setup.return_value = return_value;
+  _setup.value_returned = value_returned;
+  write_g_codes((block_pointer) NULL, &_setup);
+  write_m_codes((block_pointer) NULL, &_setup);
+  write_settings(&_setup);
+
+  _setup.sequence_number = line;
+  _setup.checkpoint_origin = origin;
+  _setup.checkpoint_origin_valid = true;
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! checkpoint_start
+
+Returned Value: none
+
+Side effects:
+   The first time a line of the program is read, the state it starts
+   in is hashed into the origin of the checkpoints taken of it.
+
+Called by: read
+
+*/
+
+void Interp::checkpoint_start()
+{
+  std::string state;
+
+  checkpoint_state(state);
+  _setup.checkpoint_origin = checkpoint_hash(state);
+  _setup.checkpoint_origin_valid = true;
+}
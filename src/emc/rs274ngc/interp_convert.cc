@@ -4389,15 +4389,13 @@ int Interp::convert_stop(block_pointer block,    //!< pointer to a block of RS27
     if (_setup.percent_flag && _setup.file_pointer) {
       line = _setup.linetext;
       for (;;) {                /* check for ending percent sign and comment if missing */
-        if (fgets(line, LINELEN, _setup.file_pointer) == NULL) {
+        length = file_read_line(&_setup, line);
+        if (length == 0) {
           enqueue_COMMENT("interpreter: percent sign missing from end of file");
           break;
         }
-        length = strlen(line);
-        if (length == (LINELEN - 1)) {       // line is too long. need to finish reading the line
-          for (; fgetc(_setup.file_pointer) != '\n';);
+        if (length < 0)         // line is too long, skipped
           continue;
-        }
         for (index = (length - 1);      // index set on last char
              (index >= 0) && (isspace(line[index])); index--);
         if (line[index] == '%') // found line with % at end
@@ -0,0 +1,378 @@
+/********************************************************************
+* Description: interp_expression.cc
+*
+*   Compiling [...] expressions of cached lines.
+*
+* Author:
+* License: GPL Version 2
+* System: Linux
+*
+* Copyright (c) 2026 All rights reserved.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+********************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <boost/python.hpp>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "rtapi_math.h"
+#include <string.h>
+#include <ctype.h>
+#include "rs274ngc.hh"
+#include "rs274ngc_return.hh"
+#include "interp_internal.hh"
+#include "rs274ngc_interp.hh"
+
+/*
+
+read_real_expression() reads an expression and computes its value in
+one go, so a loop body pays for reading its expressions on every pass.
+Lines _read() takes from the line cache (see line_cache_find) and which
+are parsed again keep their expressions compiled, by position on the
+line, in _setup.expr_codes. On the first pass an expression is compiled
+into a sequence of expr_op, later passes only run execute_expression().
+
+The compile_* functions follow read_real_expression, read_real_value,
+read_parameter and read_unary and use the same readers for numbers,
+names and operations, but emit an instruction wherever those would
+compute. The instructions come out in the order the values used to be
+computed, so errors (a division by zero, an undefined named parameter)
+and the side effects of reading a parameter (Python named parameters)
+happen as before. Parameter numbers which are constants are resolved
+while compiling; named parameters are looked up by name at run time,
+since their scope depends on the call level.
+
+An expression which does not compile is marked and left to
+read_real_expression(), which reports the error.
+
+*/
+
+static void emit(expr_code *code, int *depth, int op, int arg,
+		 double value, int change)
+{
+    expr_op instruction;
+
+    instruction.op = op;
+    instruction.arg = arg;
+    instruction.value = value;
+    code->code.push_back(instruction);
+    *depth += change;
+    if (*depth > code->depth)
+	code->depth = *depth;
+}
+
+// read_integer_value() of a computed value
+static bool expr_integer(double float_value, int *integer_ptr)
+{
+    *integer_ptr = (int) rtapi_floor(float_value);
+    if ((float_value - *integer_ptr) > 0.9999)
+	*integer_ptr = (int) rtapi_ceil(float_value);
+    else if ((float_value - *integer_ptr) > 0.0001)
+	return false;
+    return true;
+}
+
+/****************************************************************************/
+
+/*! compiled_expression
+
+Returned Value: expr_code *
+   the compiled expression at line[counter], or NULL if expressions of
+   this line are not compiled
+
+Side effects:
+   The expression is compiled and stored on first use.
+
+Called by: read_real_expression
+
+*/
+
+expr_code *Interp::compiled_expression(char *line, int counter)
+{
+    expr_code_map::iterator it;
+    int depth = 0;
+
+    if (!_setup.expr_codes || (line != _setup.blocktext))
+	return NULL;
+    if ((it = _setup.expr_codes->find(counter)) != _setup.expr_codes->end())
+	return &it->second;
+
+    expr_code &code = (*_setup.expr_codes)[counter];
+    code.depth = 0;
+    code.ok = (compile_expression(line, &counter, &code, &depth) == INTERP_OK) &&
+	(code.depth <= EXPR_MAX_DEPTH);
+    code.end = counter;
+    if (!code.ok) {
+	code.code.clear();
+	code.names.clear();
+    }
+    return &code;
+}
+
+/****************************************************************************/
+
+/*! compile_expression, compile_value, compile_parameter, compile_unary
+
+Returned Value: int
+   INTERP_OK, or the error read_real_expression() and friends would
+   report reading the same text.
+
+Side effects:
+   Instructions are appended to code, depth is the number of values
+   they leave on the stack. The counter is moved past what was read.
+
+Called by: compiled_expression and each other
+
+*/
+
+int Interp::compile_expression(char *line, int *counter, expr_code *code,
+			       int *depth)
+{
+  int operators[MAX_STACK];
+  int stack_index;
+
+  CHKS((line[*counter] != '['), NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
+  *counter = (*counter + 1);
+  CHP(compile_value(line, counter, code, depth));
+  CHP(read_operation(line, counter, operators));
+  stack_index = 1;
+  for (; operators[0] != RIGHT_BRACKET;) {
+    CHP(compile_value(line, counter, code, depth));
+    CHP(read_operation(line, counter, operators + stack_index));
+    if (precedence(operators[stack_index]) >
+        precedence(operators[stack_index - 1]))
+      stack_index++;
+    else {
+      for (; precedence(operators[stack_index]) <=
+           precedence(operators[stack_index - 1]);) {
+        emit(code, depth, EXPR_BINARY, operators[stack_index - 1], 0.0, -1);
+        operators[stack_index - 1] = operators[stack_index];
+        if ((stack_index > 1) &&
+            (precedence(operators[stack_index - 1]) <=
+             precedence(operators[stack_index - 2])))
+          stack_index--;
+        else
+          break;
+      }
+    }
+  }
+  return INTERP_OK;
+}
+
+int Interp::compile_value(char *line, int *counter, expr_code *code,
+			  int *depth)
+{
+  char c, c1;
+  double value;
+
+  c = line[*counter];
+  CHKS((c == 0), NCE_NO_CHARACTERS_FOUND_IN_READING_REAL_VALUE);
+
+  c1 = line[*counter+1];
+
+  if (c == '[')
+    CHP(compile_expression(line, counter, code, depth));
+  else if (c == '#')
+    CHP(compile_parameter(line, counter, code, depth, false));
+  else if (c == '+' && c1 && !isdigit(c1) && c1 != '.') {
+    (*counter)++;
+    CHP(compile_value(line, counter, code, depth));
+  } else if (c == '-' && c1 && !isdigit(c1) && c1 != '.') {
+    (*counter)++;
+    CHP(compile_value(line, counter, code, depth));
+    if (code->code.back().op == EXPR_CONST)
+      code->code.back().value = -code->code.back().value;
+    else
+      emit(code, depth, EXPR_NEG, 0, 0.0, 0);
+  } else if ((c >= 'a') && (c <= 'z'))
+    CHP(compile_unary(line, counter, code, depth));
+  else {
+    CHP(read_real_number(line, counter, &value));
+    emit(code, depth, EXPR_CONST, 0, value, 1);
+  }
+
+  // a number read is never nan or inf
+  if (code->code.back().op != EXPR_CONST)
+    emit(code, depth, EXPR_CHECK, 0, 0.0, 0);
+  return INTERP_OK;
+}
+
+int Interp::compile_parameter(char *line, int *counter, expr_code *code,
+			      int *depth, bool check_exists)
+{
+  char paramNameBuf[LINELEN+1];
+  int index;
+
+  CHKS((line[*counter] != '#'), NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
+  *counter = (*counter + 1);
+  if (line[*counter] == '<') {
+    CHP(read_name(line, counter, paramNameBuf));
+    code->names.push_back(paramNameBuf);
+    emit(code, depth, check_exists ? EXPR_EXISTS_NAMED : EXPR_NAMED,
+	 code->names.size() - 1, 0.0, 1);
+    return INTERP_OK;
+  }
+
+  CHP(compile_value(line, counter, code, depth));
+  expr_op &number = code->code.back();
+  if ((number.op == EXPR_CONST) && expr_integer(number.value, &index)) {
+    if (check_exists) {
+      number.value = (index >= 1) && (index < RS274NGC_MAX_PARAMETERS);
+      return INTERP_OK;
+    }
+    if ((index >= 1) && (index < RS274NGC_MAX_PARAMETERS)) {
+      number.op = EXPR_PARAM;
+      number.arg = index;
+      return INTERP_OK;
+    }
+  }
+  // computed, or an error to report when it is reached
+  emit(code, depth, check_exists ? EXPR_EXISTS_INDEX : EXPR_PARAM_INDIRECT,
+       0, 0.0, 0);
+  return INTERP_OK;
+}
+
+int Interp::compile_unary(char *line, int *counter, expr_code *code,
+			  int *depth)
+{
+  int operation;
+
+  CHP(read_operation_unary(line, counter, &operation));
+  CHKS((line[*counter] != '['),
+      NCE_LEFT_BRACKET_MISSING_AFTER_UNARY_OPERATION_NAME);
+
+  if (operation == EXISTS) {
+    // read_bracketed_parameter
+    *counter = (*counter + 1);
+    CHKS((line[*counter] != '#'), _("Expected # reading parameter"));
+    CHP(compile_parameter(line, counter, code, depth, true));
+    CHKS((line[*counter] != ']'), _("Expected ] reading bracketed parameter"));
+    *counter = (*counter + 1);
+    return INTERP_OK;
+  }
+
+  CHP(compile_expression(line, counter, code, depth));
+
+  if (operation == ATAN) {
+    // read_atan
+    CHKS((line[*counter] != '/'), NCE_SLASH_MISSING_AFTER_FIRST_ATAN_ARGUMENT);
+    *counter = (*counter + 1);
+    CHKS((line[*counter] != '['),
+        NCE_LEFT_BRACKET_MISSING_AFTER_SLASH_WITH_ATAN);
+    CHP(compile_expression(line, counter, code, depth));
+    emit(code, depth, EXPR_ATAN, 0, 0.0, -1);
+  } else
+    emit(code, depth, EXPR_UNARY, operation, 0.0, 0);
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! execute_expression
+
+Returned Value: int
+   If execute_binary, execute_unary or find_named_param return an error
+   code, this returns that code.
+   The errors read_parameter, read_named_parameter, read_integer_value
+   and read_real_value report are reported the same way.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The value of the expression is put into what value points at.
+
+Called by: read_real_expression
+
+*/
+
+int Interp::execute_expression(expr_code *code, double *value,
+			       double *parameters)
+{
+  double stack[EXPR_MAX_DEPTH];
+  double *top = stack - 1;
+  std::vector<expr_op>::const_iterator op;
+  int index, exists;
+  const char *name;
+
+  for (op = code->code.begin(); op != code->code.end(); ++op) {
+    switch (op->op) {
+    case EXPR_CONST:
+      *++top = op->value;
+      break;
+    case EXPR_PARAM:
+      CHKS(((op->arg >= 5420) && (op->arg <= 5428) && (_setup.cutter_comp_side)),
+           _("Cannot read current position with cutter radius compensation on"));
+      *++top = parameters[op->arg];
+      break;
+    case EXPR_PARAM_INDIRECT:
+      CHKS(!expr_integer(*top, &index), NCE_NON_INTEGER_VALUE_FOR_INTEGER);
+      CHKS(((index < 1) || (index >= RS274NGC_MAX_PARAMETERS)),
+          NCE_PARAMETER_NUMBER_OUT_OF_RANGE);
+      CHKS(((index >= 5420) && (index <= 5428) && (_setup.cutter_comp_side)),
+           _("Cannot read current position with cutter radius compensation on"));
+      *top = parameters[index];
+      break;
+    case EXPR_EXISTS_INDEX:
+      CHKS(!expr_integer(*top, &index), NCE_NON_INTEGER_VALUE_FOR_INTEGER);
+      *top = (index >= 1) && (index < RS274NGC_MAX_PARAMETERS);
+      break;
+    case EXPR_NAMED:
+    case EXPR_EXISTS_NAMED:
+      name = code->names[op->arg].c_str();
+      *++top = 0.0;
+      CHP(find_named_param(name, &exists, top));
+      if (op->op == EXPR_EXISTS_NAMED) {
+	*top = exists ? 1.0 : 0.0;
+      } else if (!exists) {
+	*top = 0.0;
+	// do not require named parameters to be defined during a
+	// subroutine definition:
+	if (_setup.defining_sub)
+	  break;
+	logNP("execute_expression: referencing undefined named parameter '%s' level=%d",
+	      name, (name[0] == '_') ? 0 : _setup.call_level);
+	ERS(_("Named parameter #<%s> not defined"), name);
+      }
+      break;
+    case EXPR_NEG:
+      *top = -*top;
+      break;
+    case EXPR_UNARY:
+      CHP(execute_unary(top, op->arg));
+      break;
+    case EXPR_ATAN:
+      top--;
+      *top = rtapi_atan2(*top, top[1]);      /* value in radians */
+      *top = ((*top * 180.0) / M_PIl);       /* convert to degrees */
+      break;
+    case EXPR_BINARY:
+      top--;
+      CHP(execute_binary(top, op->arg, top + 1));
+      break;
+    case EXPR_CHECK:
+      CHKS(rtapi_isnan(*top),
+          _("Calculation resulted in 'not a number'"));
+      CHKS(rtapi_isinf(*top),
+          _("Calculation resulted in 'infinity'"));
+      break;
+    default:
+      ERS(NCE_BUG_UNKNOWN_OPERATION);
+    }
+  }
+  *value = stack[0];
+  return INTERP_OK;
+}
@@ -0,0 +1,471 @@
+/********************************************************************
+* Description: interp_file.cc
+*
+*   Reading NC program files through a memory mapping.
+*
+* Author:
+* License: GPL Version 2
+* System: Linux
+*
+* Copyright (c) 2026 All rights reserved.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+********************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <boost/python.hpp>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "rs274ngc.hh"
+#include "rs274ngc_return.hh"
+#include "interp_internal.hh"
+#include "rs274ngc_interp.hh"
+
+/*
+
+The open NC program is settings->file_pointer. Lines are not read from it
+with fgets; on first use the file is mapped read-only and lines are cut
+straight out of the mapping, with the read position kept in
+settings->file_map_pos. While a mapping is bound to the open file, its
+stdio position is stale, so every ftell/fseek/fgets/fclose on
+file_pointer must go through the functions below.
+
+Mappings are kept by device and inode after the file is closed, so the
+caller's file, which is opened again on every return from a sub in
+another file, is not mapped again. A kept mapping is dropped when the
+file's mtime or size changed.
+
+A file that cannot be mapped (a pipe, an empty file, mmap failing) or
+FEATURE_STDIO_READ in [RS274NGC]FEATURES falls back to plain stdio.
+Reading a mapping past the end of a file cut short while it is mapped
+raises SIGBUS, so setups where the program may be truncated or rewritten
+in place while it runs should set FEATURE_STDIO_READ.
+
+A mapped file also gets a file_index, which holds the o-word index (see
+control_index_file) and the lines read more than once (see
+line_cache_find).
+
+*/
+
+/****************************************************************************/
+
+/*! file_map
+
+Returned Value: int
+   INTERP_OK; a file which cannot be mapped is read with stdio instead.
+
+Side effects:
+   The file_map fields of the settings are bound to settings->file_pointer,
+   the file is mapped unless a kept mapping of it is still current.
+
+Called by:
+   file_read_line
+   file_tell
+   file_seek
+
+*/
+
+int Interp::file_map(setup_pointer settings)
+{
+    struct stat st;
+    void *map;
+    long pos;
+
+    file_unmap(settings);
+    settings->file_map_fp = settings->file_pointer;
+    if (settings->file_pointer == NULL || FEATURE(STDIO_READ))
+	return INTERP_OK;
+    if (fstat(fileno(settings->file_pointer), &st) != 0 ||
+	!S_ISREG(st.st_mode) || st.st_size == 0)
+	return INTERP_OK;
+    if ((pos = ftell(settings->file_pointer)) < 0 || pos > st.st_size)
+	return INTERP_OK;
+
+    std::pair<dev_t, ino_t> key(st.st_dev, st.st_ino);
+    file_mapping_map::iterator it = settings->file_mappings.find(key);
+    if ((it != settings->file_mappings.end()) &&
+	((it->second.mtime != st.st_mtime) ||
+	 (it->second.mtime_nsec != st.st_mtim.tv_nsec) ||
+	 (it->second.size != (size_t) st.st_size))) {
+	munmap((void *) it->second.data, it->second.size);
+	settings->file_mappings.erase(it);
+	it = settings->file_mappings.end();
+    }
+    if (it == settings->file_mappings.end()) {
+	if (settings->file_mappings.size() >= FILE_MAPPING_MAX)
+	    file_unmap_all(settings);
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+		   fileno(settings->file_pointer), 0);
+	if (map == MAP_FAILED) {
+	    logDebug("file_map: mmap %s failed: %s", settings->filename,
+		     strerror(errno));
+	    return INTERP_OK;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+	file_mapping added;
+	added.data = (const char *) map;
+	added.size = st.st_size;
+	added.mtime = st.st_mtime;
+	added.mtime_nsec = st.st_mtim.tv_nsec;
+	it = settings->file_mappings.insert(std::make_pair(key, added)).first;
+    }
+
+    settings->file_map = it->second.data;
+    settings->file_map_size = it->second.size;
+    settings->file_map_pos = pos;
+    settings->file_map_generation++;
+    return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! file_unmap, file_unmap_all
+
+Returned Value: none
+
+Side effects:
+   file_unmap drops the binding of the file_map fields, the stdio position
+   of the file is synchronized to the mapping's read position. The mapping
+   itself is kept.
+   file_unmap_all also unmaps all kept mappings.
+
+Called by:
+   file_close
+   file_map
+   Interp::init
+
+*/
+
+void Interp::file_unmap(setup_pointer settings)
+{
+    if (settings->file_map && settings->file_map_fp &&
+	settings->file_map_fp == settings->file_pointer)
+	fseek(settings->file_map_fp, settings->file_map_pos, SEEK_SET);
+    settings->file_map = NULL;
+    settings->file_map_size = 0;
+    settings->file_map_pos = 0;
+    settings->file_map_fp = NULL;
+}
+
+void Interp::file_unmap_all(setup_pointer settings)
+{
+    file_mapping_map::iterator it;
+
+    if (settings->file_map)
+	file_unmap(settings);
+    for (it = settings->file_mappings.begin();
+	 it != settings->file_mappings.end(); it++)
+	munmap((void *) it->second.data, it->second.size);
+    settings->file_mappings.clear();
+}
+
+/****************************************************************************/
+
+/*! file_close
+
+Returned Value: none
+
+Side effects:
+   Unmaps and closes settings->file_pointer and sets it to NULL.
+
+Called by: everything that used to fclose(settings->file_pointer)
+
+*/
+
+void Interp::file_close(setup_pointer settings)
+{
+    file_unmap(settings);
+    if (settings->file_pointer)
+	fclose(settings->file_pointer);
+    settings->file_pointer = NULL;
+}
+
+/****************************************************************************/
+
+/*! file_tell, file_seek
+
+ftell/fseek replacements for settings->file_pointer. Offsets are byte
+offsets in the file either way, so positions saved in call frames and
+the o-word offset map stay valid across both modes.
+
+*/
+
+long Interp::file_tell(setup_pointer settings)
+{
+    if (settings->file_pointer == NULL)
+	return -1;
+    if (settings->file_map_fp != settings->file_pointer)
+	file_map(settings);
+    if (settings->file_map)
+	return settings->file_map_pos;
+    return ftell(settings->file_pointer);
+}
+
+int Interp::file_seek(setup_pointer settings, long position)
+{
+    if (settings->file_pointer == NULL)
+	return -1;
+    if (settings->file_map_fp != settings->file_pointer)
+	file_map(settings);
+    if (settings->file_map) {
+	if (position < 0 || (size_t) position > settings->file_map_size)
+	    return -1;
+	settings->file_map_pos = position;
+	return 0;
+    }
+    return fseek(settings->file_pointer, position, SEEK_SET);
+}
+
+/****************************************************************************/
+
+/*! file_read_line
+
+Returned Value: int
+   the number of characters stored in line, including the newline,
+   0 at the end of the file, or
+   -1 if the line does not fit in LINELEN; the rest of it is skipped.
+
+Side effects:
+   Copies the next line of settings->file_pointer into line, NUL
+   terminated, and advances the read position past it.
+
+Called by:
+   read_text
+   Interp::open
+   convert_stop
+
+This is fgets(line, LINELEN, settings->file_pointer) plus the recovery
+from overlong lines its callers used to do. Against a mapping, the end of
+the line is found with memchr, which libc vectorizes, and the line is
+copied once.
+
+*/
+
+int Interp::file_read_line(setup_pointer settings, char *line)
+{
+    const char *start, *end;
+    size_t left, length;
+
+    if (settings->file_map_fp != settings->file_pointer)
+	file_map(settings);
+
+    if (!settings->file_map) {
+	if (fgets(line, LINELEN, settings->file_pointer) == NULL)
+	    return 0;
+	length = strlen(line);
+	if (length == (LINELEN - 1)) {
+	    int c;
+	    if (line[length - 1] != '\n')
+		while ((c = fgetc(settings->file_pointer)) != '\n' && c != EOF);
+	    return -1;
+	}
+	return length;
+    }
+
+    left = settings->file_map_size - settings->file_map_pos;
+    if (left == 0)
+	return 0;
+    start = settings->file_map + settings->file_map_pos;
+    end = (const char *) memchr(start, '\n', left);
+    length = end ? (size_t) (end - start) + 1 : left;
+    settings->file_map_pos += length;
+    if (length >= (LINELEN - 1))
+	return -1;
+    memcpy(line, start, length);
+    line[length] = 0;
+    return length;
+}
+
+/****************************************************************************/
+
+/*! file_index_bind
+
+Returned Value: int (INTERP_OK)
+
+Side effects:
+   settings->file_index_current is set to the file_index of the mapped
+   file, or to NULL if no file is mapped. An index whose file changed
+   since it was bound is emptied.
+
+Called by:
+   control_index_file
+   line_cache_find
+   line_cache_store
+
+File indexes are kept by file name across programs, for as long as the
+file's mtime and size do not change. Interp::init drops them all.
+
+*/
+
+int Interp::file_index_bind(setup_pointer settings)
+{
+    struct stat st;
+
+    settings->file_index_current = NULL;
+    settings->file_index_generation = settings->file_map_generation;
+    if (!settings->file_map ||
+	fstat(fileno(settings->file_pointer), &st) != 0 ||
+	(size_t) st.st_size != settings->file_map_size)
+	return INTERP_OK;
+
+    file_index &idx = settings->file_indexes[settings->filename];
+    settings->file_index_current = &idx;
+    if ((idx.mtime == st.st_mtime) && (idx.mtime_nsec == st.st_mtim.tv_nsec) &&
+	(idx.size == st.st_size))
+	return INTERP_OK;
+
+    idx.mtime = st.st_mtime;
+    idx.mtime_nsec = st.st_mtim.tv_nsec;
+    idx.size = st.st_size;
+    idx.read_end = 0;
+    idx.lines.clear();
+    idx.oword_indexed = false;
+    idx.usable = false;
+    return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! line_cache_find, line_cache_read, line_cache_parse, line_cache_store
+
+The lines of a loop body or of a sub are read and parsed again on every
+pass. The first time _read() comes back to a line of a mapped file, it
+is stored in the file_index: the text read_text() made of it and, if
+read_items() depends on nothing but that text, the block read_items()
+filled from it. On later passes, line_cache_read() stands in for
+read_text(), and line_cache_parse() copies the block and goes on with
+enhance_block() where parse_line() would.
+
+Lines with parameters, expressions or o-words, and ';' comments (which
+read_semicolon() acts on while reading) are only stored as text and are
+parsed every time. A block parsed in lathe diameter mode halves X, so it
+is only used in the mode it was read in. No more than LINE_CACHE_MAX
+lines are stored per file; the lines go when the file changes (see
+file_index_bind) and FEATURE_NO_LINE_CACHE turns all of this off.
+
+*/
+
+// read_items() of this line reads nothing but the line
+static bool line_cache_constant(const char *line)
+{
+    for (; *line; line++) {
+	if (*line == '(') {	// close_and_downcase() checked the ')'
+	    if ((line = strchr(line, ')')) == NULL)
+		return false;
+	    continue;
+	}
+	if ((*line == '#') || (*line == '[') || (*line == ';') ||
+	    (*line == 'o'))
+	    return false;
+    }
+    return true;
+}
+
+cached_line *Interp::line_cache_find(setup_pointer settings, long offset)
+{
+    std::map<long, cached_line>::iterator it;
+    file_index *idx;
+
+    if (FEATURE(NO_LINE_CACHE) || (offset < 0) || !settings->file_map)
+	return NULL;
+    if (settings->file_index_generation != settings->file_map_generation)
+	file_index_bind(settings);
+    if ((idx = settings->file_index_current) == NULL ||
+	(offset >= idx->read_end))
+	return NULL;
+    it = idx->lines.find(offset);
+    return (it == idx->lines.end()) ? NULL : &it->second;
+}
+
+int Interp::line_cache_read(setup_pointer settings, cached_line *cached)
+{
+    memcpy(settings->linetext, cached->linetext.c_str(),
+	   cached->linetext.size() + 1);
+    memcpy(settings->blocktext, cached->blocktext.c_str(),
+	   cached->blocktext.size() + 1);
+    file_seek(settings, cached->end);
+    settings->sequence_number++;
+    settings->parameter_occurrence = 0;
+
+    // as read_text() does it, block delete may have changed since
+    if ((settings->blocktext[0] == 0) ||
+	((settings->blocktext[0] == '/') && (GET_BLOCK_DELETE())))
+	settings->line_length = 0;
+    else
+	settings->line_length = cached->blocktext.size();
+    return INTERP_OK;
+}
+
+int Interp::line_cache_parse(setup_pointer settings, cached_line *cached,
+			     block_pointer block)
+{
+    // not set from the line
+    long offset = block->offset;
+    int saved_line_number = block->saved_line_number;
+    int phase = block->phase;
+
+    *block = cached->parsed_block;
+    block->offset = offset;
+    block->saved_line_number = saved_line_number;
+    block->phase = phase;
+
+    CHP(enhance_block(block, settings));
+    CHP(check_items(block, settings));
+    int n = find_remappings(block, settings);
+    if (n) logRemap("line_cache_parse: found %d remappings", n);
+    return INTERP_OK;
+}
+
+void Interp::line_cache_store(setup_pointer settings, long offset, long end)
+{
+    file_index *idx;
+
+    if (FEATURE(NO_LINE_CACHE) || (offset < 0) || (end <= offset) ||
+	!settings->file_map)
+	return;
+    if (settings->file_index_generation != settings->file_map_generation)
+	file_index_bind(settings);
+    if ((idx = settings->file_index_current) == NULL)
+	return;
+    if (offset >= idx->read_end) {	// first time through
+	idx->read_end = end;
+	return;
+    }
+    if (settings->skipping_o || settings->skipping_to_sub ||
+	(idx->lines.size() >= LINE_CACHE_MAX) ||
+	!strcmp(settings->blocktext, "%") ||
+	idx->lines.count(offset))
+	return;
+
+    cached_line &cached = idx->lines[offset];
+    cached.end = end;
+    cached.linetext = settings->linetext;
+    cached.blocktext = settings->blocktext;
+    cached.lathe_diameter_mode = settings->lathe_diameter_mode;
+    cached.parsed = false;
+    if ((settings->line_length != 0) &&
+	line_cache_constant(settings->blocktext)) {
+	init_block(&cached.parsed_block);
+	cached.parsed = (read_items(&cached.parsed_block, settings->blocktext,
+				    settings->parameters) == INTERP_OK);
+    }
+}
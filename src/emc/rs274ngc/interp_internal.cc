@@ -70,13 +70,33 @@ The KT and NGC manuals say nothing about case or spaces and tabs.
 */
 
 int Interp::close_and_downcase(char *line)       //!< string: one line of NC code
+{
+    return close_and_downcase(line, line);
+}
+
+/* The same, reading from src and writing the result to line, which may be
+   src. Most lines have no comment; the first comment or newline is found
+   with strcspn, which libc vectorizes, and everything before it is
+   stripped and downcased without tracking comment state. */
+int Interp::close_and_downcase(const char *src,  //!< string: one line of NC code
+                               char *line)       //!< where the result goes
 {
     int m;
     int n;
+    int span;
     int comment, semicomment;
     char item;
     comment = semicomment = 0;
-    for (n = 0, m = 0; (item = line[m]) != (char) NULL; m++) {
+    span = strcspn(src, "(;\n");
+    for (n = 0, m = 0; m < span; m++) {
+	item = src[m];
+	if ((item == ' ') || (item == '\t') || (item == '\r'))
+	    continue;
+	if ((64 < item) && (item < 91))
+	    item += 32;
+	line[n++] = item;
+    }
+    for (; (item = src[m]) != (char) NULL; m++) {
 	if ((item == ';') && !comment)
 	    semicomment = 1;
 
@@ -93,7 +113,7 @@ int Interp::close_and_downcase(char *line)       //!< string: one line of NC cod
 	} else if ((item == ' ') || (item == '\t') || (item == '\r'));
 	/* don't copy blank or tab or CR */
 	else if (item == '\n') {    /* don't copy newline            *//* but check null follows        */
-	    CHKS((line[m + 1] != 0), NCE_NULL_MISSING_AFTER_NEWLINE);
+	    CHKS((src[m + 1] != 0), NCE_NULL_MISSING_AFTER_NEWLINE);
 	} else if ((64 < item) && (item < 91)) {    /* downcase upper case letters */
 	    line[n++] = (32 + item);
 	} else if ((item == '(') && !semicomment) {   /* (comment is starting */
@@ -19,8 +19,12 @@
 #include "config.h"
 #include <limits.h>
 #include <stdio.h>
+#include <sys/types.h>
+#include <stdint.h>
 #include <set>
 #include <map>
+#include <string>
+#include <vector>
 #include <bitset>
 #include "canon.hh"
 #include "emcpos.h"
@@ -88,6 +92,9 @@ static inline bool equal(double a, double b)
 }
 
 
+/* operator stack of read_real_expression and compile_expression */
+#define MAX_STACK 7
+
 #define TINY 1e-12              /* for arc_data_r */
 
 // max number of m codes on one line
@@ -335,6 +342,10 @@ typedef struct remap_struct {
     const char *remap_py;    // Py function maybe  null, OR
     const char *remap_ngc;   // NGC file, maybe  null
     const char *epilog_func; // Py function or null
+    // time spent in the Py functions, generator resumptions included
+    unsigned long py_calls;
+    double py_seconds;
+    double py_max_seconds;   // of a single call
 } remap;
 
 
@@ -591,6 +602,98 @@ typedef struct offset_struct {
 typedef std::map<const char *, offset, nocase_cmp> offset_map_type;
 typedef std::map<const char *, offset, nocase_cmp>::iterator offset_map_iterator;
 
+// one o-word line of a file, see control_skip_indexed()
+typedef struct oword_label_struct {
+  int type;              // O_sub .. O_return as read_o() would classify it
+  long offset;           // start of the line
+  long end;              // start of the next line
+  int line;              // physical line number, 1-based
+} oword_label;
+
+// the value of a _hal[] named parameter, see fetch_hal_param()
+typedef struct hal_handle_struct {
+  void *ptr;             // hal_data_u of the pin, signal or param
+  int type;              // its hal_type_t
+} hal_handle;
+
+typedef std::map<std::string, hal_handle> hal_handle_map;
+
+// one instruction of a compiled [...] expression, see interp_expression.cc
+typedef struct expr_op_struct {
+  int op;                // EXPR_CONST .. EXPR_CHECK
+  int arg;               // operation, parameter number or index into names
+  double value;          // EXPR_CONST
+} expr_op;
+
+#define EXPR_CONST          0  // push value
+#define EXPR_PARAM          1  // push parameter arg
+#define EXPR_PARAM_INDIRECT 2  // replace top with the parameter it numbers
+#define EXPR_EXISTS_INDEX   3  // replace top with 1 if it numbers a parameter
+#define EXPR_NAMED          4  // push named parameter names[arg]
+#define EXPR_EXISTS_NAMED   5  // push 1 if names[arg] exists
+#define EXPR_NEG            6  // negate top
+#define EXPR_UNARY          7  // execute_unary() arg on top
+#define EXPR_ATAN           8  // two argument atan of the top two
+#define EXPR_BINARY         9  // execute_binary() arg on the top two
+#define EXPR_CHECK         10  // top must not be nan or inf
+
+#define EXPR_MAX_DEPTH     64  // value stack of execute_expression()
+
+typedef struct expr_code_struct {
+  bool ok;               // false: left to read_real_expression()
+  int end;               // counter after the closing ]
+  int depth;             // value stack needed
+  std::vector<expr_op> code;
+  std::vector<std::string> names;  // of named parameters
+} expr_code;
+
+typedef std::map<int, expr_code> expr_code_map;  // by counter at the [
+
+// a line read more than once, as read_text() and read_items() left it,
+// see line_cache_find()
+typedef struct cached_line_struct {
+  long end;              // start of the next line
+  std::string linetext;  // raw line without trailing white space
+  std::string blocktext; // after close_and_downcase()
+  bool parsed;           // block holds read_items() of blocktext
+  bool lathe_diameter_mode;  // read_x() halves x in diameter mode
+  block parsed_block;
+  expr_code_map exprs;   // compiled expressions of a line not parsed
+} cached_line;
+
+#define LINE_CACHE_MAX 10000   // cached lines per file
+
+// a program file mapped into memory, kept for as long as its mtime and
+// size stay the same, see file_map()
+typedef struct file_mapping_struct {
+  const char *data;
+  size_t size;
+  time_t mtime;
+  long mtime_nsec;
+} file_mapping;
+
+typedef std::map<std::pair<dev_t, ino_t>, file_mapping> file_mapping_map;
+
+#define FILE_MAPPING_MAX 32    // files kept mapped
+
+// what is known about a program file, kept by file name for as long as
+// its mtime and size stay the same, see file_index_bind()
+typedef struct file_index_struct {
+  time_t mtime;          // of the file when bound
+  long mtime_nsec;
+  off_t size;
+  long read_end;         // furthest line end read so far
+  std::map<long, cached_line> lines;  // by line start offset
+  // all o-word lines of the file, by label ("100" or "name") in file order
+  bool oword_indexed;    // the o-word index below was built
+  bool usable;           // false if a label is an expression
+  std::map<std::string, std::vector<oword_label> > labels;
+  std::map<long, int> line_ends;   // o-word line end offset -> line number
+  std::vector<oword_label> barriers;  // lines a skip must not pass, see there
+} file_index;
+
+typedef std::map<std::string, file_index> file_index_map;
+
 /*
 
 The current_x, current_y, and current_z are the location of the tool
@@ -672,6 +775,12 @@ typedef struct setup_struct
   double feed_rate;             // feed rate in current units/min
   char filename[PATH_MAX];      // name of currently open NC code file
   FILE *file_pointer;           // file pointer for open NC code file
+  FILE *file_map_fp;            // file the mapping below is bound to, see interp_file.cc
+  const char *file_map;         // mapping of file_map_fp, or NULL for stdio
+  size_t file_map_size;         // size of the mapping
+  size_t file_map_pos;          // read position in the mapping
+  int file_map_generation;      // bumped for every binding
+  file_mapping_map file_mappings;  // by device and inode, kept across opens
   bool flood;                 // whether flood coolant is on
   CANON_UNITS length_units;     // millimeters or inches
   double spiral_tolerance_inch; // modify with ini setting
@@ -737,6 +846,15 @@ typedef struct setup_struct
   context sub_context[INTERP_SUB_ROUTINE_LEVELS];
   int call_state;                  //  enum call_states - inidicate Py handler reexecution
   offset_map_type offset_map;      // store label x name, file, line
+  file_index_map file_indexes;     // by file name, kept across programs
+  file_index *file_index_current;  // index of the loaded file, or NULL
+  int file_index_generation;       // file_map_generation it was bound at
+  expr_code_map *expr_codes;       // of the cached line being parsed, or NULL
+  hal_handle_map hal_handles;      // resolved _hal[] names
+  unsigned long hal_handles_generation;  // HAL config_generation they are for
+  uint64_t checkpoint_origin;      // hash of the state the program started in
+  bool checkpoint_origin_valid;    // a line of the program has been read
+  bool forked;                     // a copy in a child process, see forked()
 
   bool adaptive_feed;              // adaptive feed is enabled
   bool feed_hold;                  // feed hold is enabled
@@ -774,8 +892,13 @@ typedef struct setup_struct
     // do not lowercase named params inside comments - for #<_hal[PinName]>
 #define FEATURE_NO_DOWNCASE_OWORD    0x00000010
 #define FEATURE_OWORD_WARNONLY       0x00000020
+    // read NC files with stdio instead of mapping them into memory
+#define FEATURE_STDIO_READ           0x00000040
+    // parse every line read, also those of loops and subs read before
+#define FEATURE_NO_LINE_CACHE        0x00000080
 
     boost::python::object pythis;  // boost::cref to 'this'
+    boost::python::object pythis_args;  // (pythis,), args of handlers taking just self
     const char *on_abort_command;
     int_remap_map  g_remapped,m_remapped;
     remap_map remaps;
@@ -158,8 +158,10 @@ int Interp::read_named_parameter(
     } else {
         // do not require named parameters to be defined during a 
         // subroutine definition:
-        if (_setup.defining_sub)
+        if (_setup.defining_sub) {
+            *double_ptr = 0.0;
             return INTERP_OK;
+        }
 
 	logNP("%s: referencing undefined named parameter '%s' level=%d",
 	      name, paramNameBuf, (paramNameBuf[0] == '_') ? 0 : _setup.call_level);
@@ -217,9 +219,21 @@ int Interp::fetch_ini_param( const char *nameBuf, int *status, double *value)
     return INTERP_OK;
 }
 
+static double hal_value(hal_data_u *ptr, int type)
+{
+    switch (type) {
+    case HAL_BIT: return (double) get_bit_value(ptr);
+    case HAL_U32: return (double) get_u32_value(ptr);
+    case HAL_S32: return (double) get_s32_value(ptr);
+    case HAL_FLOAT: return (double) get_float_value(ptr);
+    }
+    return 0.0;
+}
+
 // if the variable is of the form '_hal[hal_name]', then treat it as
 // a HAL pin, signal or param. Lookup value, convert to float, and export as global and read-only.
-// do not cache.
+// do not cache the value. where the value lives is kept in _setup.hal_handles
+// until the HAL configuration changes (hal_data->config_generation).
 // the shortest possible ini variable is '_hal[x]' or 7 chars long .
 int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
 {
@@ -228,8 +242,12 @@ int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
     int type = 0;
     hal_data_u* ptr;
     char hal_name[LINELEN];
+    hal_handle_map::iterator hi;
 
     *status = 0;
+    CHKS(_setup.forked,
+	 _("Named hal parameter #<%s> cannot be read in a forked interpreter"),
+	 nameBuf);
     if (!comp_id) {
 	char hal_comp[LINELEN];
 	sprintf(hal_comp,"interp%d",getpid());
@@ -237,6 +255,18 @@ int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
 	CHKS(comp_id < 0,_("fetch_hal_param: hal_init(%s): %d"), hal_comp,comp_id);
 	CHKS((retval = hal_ready(comp_id)), _("fetch_hal_param: hal_ready(): %d"),retval);
     }
+
+    if (_setup.hal_handles_generation != hal_data->config_generation) {
+	_setup.hal_handles.clear();
+	_setup.hal_handles_generation = hal_data->config_generation;
+    }
+    if ((hi = _setup.hal_handles.find(nameBuf)) != _setup.hal_handles.end()) {
+	*value = hal_value((hal_data_u *) hi->second.ptr, hi->second.type);
+	logOword("%s: value=%f", nameBuf, *value);
+	*status = 1;
+	return INTERP_OK;
+    }
+
     char *s;
     int n = strlen(nameBuf);
     if ((n > 6) &&
@@ -254,8 +284,8 @@ int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
 	    *status = 0;
 	    ERS("%s: trailing garbage after closing bracket", nameBuf);
 	}
-	// the result of these lookups could be cached in the parameter struct, but I'm not sure
-	// this is a good idea - a removed pin/signal will not be noticed
+	// a removed or relinked pin/signal bumps config_generation, which
+	// drops the handle stored below
 
 	// I dont think that's needed - no change in pins/sigs/params
 	// rtapi_mutex_get(&(hal_data->mutex)); 
@@ -295,12 +325,10 @@ int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
     return INTERP_OK;
 
     assign:
-    switch (type) {
-    case HAL_BIT: *value = (double) get_bit_value(ptr); break;
-    case HAL_U32: *value = (double) get_u32_value(ptr); break;
-    case HAL_S32: *value = (double) get_s32_value(ptr); break;
-    case HAL_FLOAT: *value = (double) get_float_value(ptr); break;
-    }
+    hal_handle &handle = _setup.hal_handles[nameBuf];
+    handle.ptr = ptr;
+    handle.type = type;
+    *value = hal_value(ptr, type);
     logOword("%s: value=%f", hal_name, *value);
     *status = 1;
     return INTERP_OK; 
@@ -356,14 +384,12 @@ int Interp::find_named_param(
 	  CHP(lookup_named_param(nameBuf, pv->value, value));
 	  *status = 1;
       } else if (pv->attr & PA_PYTHON) {
-	  bp::object retval, tupleargs, kwargs;
-	  bp::list plist;
+	  bp::object retval, kwargs;
 
-	  plist.append(_setup.pythis); // self
-	  tupleargs = bp::tuple(plist);
 	  kwargs = bp::dict();
 
-	  python_plugin->call(NAMEDPARAMS_MODULE, nameBuf, tupleargs, kwargs, retval);
+	  python_plugin->call(NAMEDPARAMS_MODULE, nameBuf, _setup.pythis_args,
+			      kwargs, retval);
 	  CHKS(python_plugin->plugin_status() == PLUGIN_EXCEPTION,
 	       "named param - pycall(%s):\n%s", nameBuf,
 	       python_plugin->last_exception().c_str());
@@ -130,6 +130,275 @@ int Interp::control_find_oword(block_pointer block,      // pointer to block
     }
 }
 
+/****************************************************************************/
+
+/*! control_index_file, control_skip_indexed
+
+Skipping forward to an o-word (a false if/while, a break, a sub
+definition, a call to a sub further down the file or in a file of its
+own) used to read and parse every line in between. Only o-word lines can
+end a skip, so the loaded program file gets an index of its o-word lines
+on the first skip in it. The index is part of the file's file_index (see
+file_index_bind), and _read() uses it to seek straight to the line which
+ends the skip.
+
+Lines which would stop a skip with an error (too long, a bad comment or
+line number, an o-word read_o() does not know) and '%' lines are
+barriers: a skip never jumps past one, so it still reports the error or
+the end of the program. A file whose labels are expressions is not
+indexed, and neither is one read through stdio; those skip line by line
+as before.
+
+*/
+
+static const struct {
+    const char *word;
+    int type;
+} oword_keywords[] = {		// in the order read_o() tries them
+    {"sub", O_sub}, {"endsub", O_endsub}, {"call", O_call},
+    {"do", O_do}, {"while", O_while}, {"repeat", O_repeat},
+    {"if", O_if}, {"elseif", O_elseif}, {"else", O_else},
+    {"endif", O_endif}, {"break", O_break}, {"continue", O_continue},
+    {"endwhile", O_endwhile}, {"endrepeat", O_endrepeat},
+    {"return", O_return},
+};
+
+static bool oword_global(int type)
+{
+    // read_o() names these without the enclosing sub
+    return (type == O_sub) || (type == O_endsub) ||
+	(type == O_call) || (type == O_return);
+}
+
+static bool oword_label_before(const oword_label &l, long offset)
+{
+    return l.offset < offset;
+}
+
+// first entry at or after offset
+static const oword_label *oword_next(const std::vector<oword_label> &v,
+				     long offset, bool sub_only,
+				     bool global)
+{
+    std::vector<oword_label>::const_iterator it =
+	std::lower_bound(v.begin(), v.end(), offset, oword_label_before);
+    for (; it != v.end(); ++it) {
+	if (oword_global(it->type) != global)
+	    continue;
+	if (it->type == O_call)	// a call never ends a skip
+	    continue;
+	if (sub_only && (it->type != O_sub))
+	    continue;
+	return &*it;
+    }
+    return NULL;
+}
+
+int Interp::control_index_file(setup_pointer settings)
+{
+    const char *p, *end, *next, *nl;
+    char buf[LINELEN];
+    int line, c, i;
+    long length;
+
+    if (settings->file_index_generation != settings->file_map_generation)
+	CHP(file_index_bind(settings));
+    if (!settings->file_index_current ||
+	settings->file_index_current->oword_indexed)
+	return INTERP_OK;
+
+    file_index &idx = *settings->file_index_current;
+    logOword("indexing o-words of %s", settings->filename);
+    idx.oword_indexed = true;
+    idx.usable = true;
+    idx.labels.clear();
+    idx.line_ends.clear();
+    idx.barriers.clear();
+
+    end = settings->file_map + settings->file_map_size;
+    for (p = settings->file_map, line = 1; p < end; p = next, line++) {
+	oword_label entry;
+	std::string label;
+
+	nl = (const char *) memchr(p, '\n', end - p);
+	next = nl ? nl + 1 : end;
+	length = next - p;
+	entry.offset = p - settings->file_map;
+	entry.end = next - settings->file_map;
+	entry.line = line;
+	entry.type = O_none;
+
+	if (length >= LINELEN - 1) {
+	    idx.barriers.push_back(entry);
+	    continue;
+	}
+	// most lines are neither o-words nor numbered; only their
+	// comments need checking
+	for (i = 0; (i < length) && ((p[i] == ' ') || (p[i] == '\t') ||
+				     (p[i] == '\r')); i++);
+	if (i < length && p[i] == '/')
+	    for (i++; (i < length) && ((p[i] == ' ') || (p[i] == '\t') ||
+				       (p[i] == '\r')); i++);
+	c = (i < length) ? tolower(p[i]) : 0;
+	if ((c != 'o') && (c != 'n') && (c != '%') &&
+	    !memchr(p, '(', length))
+	    continue;
+
+	memcpy(buf, p, length);
+	buf[length] = 0;
+	if (close_and_downcase(buf) != INTERP_OK) {
+	    idx.barriers.push_back(entry);
+	    continue;
+	}
+	if ((buf[0] == '%') && (buf[1] == 0)) {
+	    idx.barriers.push_back(entry);
+	    continue;
+	}
+
+	i = (buf[0] == '/') ? 1 : 0;
+	if (buf[i] == 'n') {
+	    if (!isdigit(buf[++i])) {
+		idx.barriers.push_back(entry);
+		continue;
+	    }
+	    while (isdigit(buf[i]))
+		i++;
+	    if (buf[i] == '.') {
+		if (!isdigit(buf[++i])) {
+		    idx.barriers.push_back(entry);
+		    continue;
+		}
+		while (isdigit(buf[i]))
+		    i++;
+	    }
+	}
+	if (buf[i] != 'o')
+	    continue;
+
+	i++;
+	if (buf[i] == '<') {
+	    char *close = strchr(buf + i, '>');
+	    if (!close) {
+		idx.barriers.push_back(entry);
+		continue;
+	    }
+	    label.assign(buf + i + 1, close - (buf + i + 1));
+	    i = close - buf + 1;
+	} else if (isdigit(buf[i])) {
+	    char *digits_end;
+	    char number[32];
+	    long n = strtol(buf + i, &digits_end, 10);
+	    if (*digits_end == '.' || isdigit(*digits_end)) {
+		idx.usable = false;	// o100.5, overflow
+		break;
+	    }
+	    snprintf(number, sizeof(number), "%d", (int) n);
+	    label = number;
+	    i = digits_end - buf;
+	} else {
+	    idx.usable = false;		// o#1, o[...]
+	    break;
+	}
+
+	for (c = 0; c < (int) (sizeof(oword_keywords) / sizeof(oword_keywords[0])); c++) {
+	    if (!strncmp(buf + i, oword_keywords[c].word,
+			 strlen(oword_keywords[c].word))) {
+		entry.type = oword_keywords[c].type;
+		break;
+	    }
+	}
+	if (entry.type == O_none) {
+	    idx.barriers.push_back(entry);
+	    continue;
+	}
+	idx.labels[label].push_back(entry);
+	idx.line_ends[entry.end] = line;
+    }
+    if (!idx.usable) {
+	logOword("%s: not indexed, o-word labels are expressions",
+		 settings->filename);
+	idx.labels.clear();
+	idx.line_ends.clear();
+	idx.barriers.clear();
+    }
+    return INTERP_OK;
+}
+
+int Interp::control_skip_indexed(setup_pointer settings)
+{
+    const char *target, *context_name;
+    const oword_label *found = NULL, *candidate;
+    std::map<std::string, std::vector<oword_label> >::const_iterator it;
+    std::map<long, int>::const_iterator current;
+    std::vector<oword_label>::const_iterator barrier;
+    file_index *idx;
+    long pos;
+    int line;
+    bool sub_only;
+
+    pos = file_tell(settings);	// maps the file if not done yet
+    if (!settings->file_map)
+	return INTERP_OK;
+    CHP(control_index_file(settings));
+    idx = settings->file_index_current;
+    if (!idx || !idx->usable)
+	return INTERP_OK;
+
+    // the line the skip started on gives the offset between physical
+    // lines and sequence numbers
+    if (pos == 0) {
+	line = 0;
+    } else {
+	current = idx->line_ends.find(pos);
+	if (current == idx->line_ends.end())
+	    return INTERP_OK;
+	line = current->second;
+    }
+
+    sub_only = (settings->skipping_to_sub != NULL);
+    target = sub_only ? settings->skipping_to_sub : settings->skipping_o;
+
+    it = idx->labels.find(target);
+    if (it != idx->labels.end())
+	found = oword_next(it->second, pos, sub_only, true);
+
+    // a local label is named <sub>#<label>, as read_o() does
+    if (settings->call_level)
+	context_name = settings->sub_context[settings->call_level].subName;
+    else if (settings->defining_sub)
+	context_name = settings->sub_name;
+    else
+	context_name = "";
+    if (!sub_only) {
+	size_t n;
+	if (!context_name)	// read_o() would name it "(null)#..."
+	    return INTERP_OK;
+	n = strlen(context_name);
+	if (!strncmp(target, context_name, n) && (target[n] == '#')) {
+	    it = idx->labels.find(target + n + 1);
+	    if (it != idx->labels.end()) {
+		candidate = oword_next(it->second, pos, false, false);
+		if (candidate && (!found || candidate->offset < found->offset))
+		    found = candidate;
+	    }
+	}
+    }
+
+    barrier = std::lower_bound(idx->barriers.begin(), idx->barriers.end(),
+			       pos, oword_label_before);
+    if (barrier != idx->barriers.end() &&
+	(!found || barrier->offset < found->offset))
+	found = &*barrier;
+    if (!found || found->offset == pos)
+	return INTERP_OK;
+
+    logOword("skipping to %s from line %d to %d", target, line, found->line);
+    if (file_seek(settings, found->offset) != 0)
+	return INTERP_OK;
+    settings->sequence_number += found->line - 1 - line;
+    return INTERP_OK;
+}
+
 const char *o_ops[] = {
     "O_none",
     "O_sub",
@@ -159,6 +428,19 @@ const char *call_statenames[] = {
     "CS_REEXEC_PYOSUB",
 };
 
+// the kwargs of the last Py call at this level are cleared and handed
+// out again, unless something else holds on to the dict; a called
+// function gets a copy of the items anyway
+static void reset_kwargs(context_pointer frame)
+{
+    PyObject *kwargs = frame->kwargs.ptr();
+
+    if (PyDict_Check(kwargs) && (Py_REFCNT(kwargs) == 1))
+	PyDict_Clear(kwargs);
+    else
+	frame->kwargs = bp::dict();
+}
+
 const char *call_typenames[] = {
     "CT_NGC_OWORD_SUB",   
     "CT_PYTHON_OWORD_SUB",
@@ -171,7 +453,6 @@ int Interp::execute_call(setup_pointer settings,
 {
     int status = INTERP_OK;
     int i;
-    bp::list plist;
 
     context_pointer previous_frame = &settings->sub_context[settings->call_level-1];
 
@@ -207,7 +488,7 @@ int Interp::execute_call(setup_pointer settings,
 	if (settings->file_pointer == NULL) {
 	    previous_frame->position = -1;
 	} else {
-	    previous_frame->position = ftell(settings->file_pointer);
+	    previous_frame->position = file_tell(settings);
 	}
 
 	// save return location
@@ -242,11 +523,15 @@ int Interp::execute_call(setup_pointer settings,
 	    settings->value_returned = 0;
 	    previous_frame->sequence_number = settings->sequence_number;
 	    previous_frame->filename = strstore(settings->filename);
-	    plist.append(settings->pythis); // self
+	    current_frame->tupleargs =
+		bp::object(bp::handle<>(PyTuple_New(eblock->param_cnt + 1)));
+	    Py_INCREF(settings->pythis.ptr());
+	    PyTuple_SET_ITEM(current_frame->tupleargs.ptr(), 0,
+			     settings->pythis.ptr()); // self
 	    for(int i = 0; i < eblock->param_cnt; i++)
-		plist.append(eblock->params[i]); // positonal args
-	    current_frame->tupleargs = bp::tuple(plist);
-	    current_frame->kwargs = bp::dict();
+		PyTuple_SET_ITEM(current_frame->tupleargs.ptr(), i + 1,
+				 PyFloat_FromDouble(eblock->params[i])); // positonal args
+	    reset_kwargs(current_frame);
 
 	case CS_REEXEC_PYOSUB:
 	    if (settings->call_state ==  CS_REEXEC_PYOSUB)
@@ -279,9 +564,8 @@ int Interp::execute_call(setup_pointer settings,
 	    if (remap->remap_py || remap->prolog_func || remap->epilog_func) {
 		CHKS(!PYUSABLE, "%s (remapped) uses Python functions, but the Python plugin is not available", 
 		     remap->name);
-		plist.append(settings->pythis);   //self
-		current_frame->tupleargs = bp::tuple(plist);
-		current_frame->kwargs = bp::dict();
+		current_frame->tupleargs = settings->pythis_args;   //self
+		reset_kwargs(current_frame);
 	    }
 	    if (remap->argspec && (strchr(remap->argspec, '@') == NULL)) {
 		// add_parameters will decorate kwargs as per argspec
@@ -401,7 +685,7 @@ int Interp::execute_return(setup_pointer settings, context_pointer current_frame
 
 	    // file at this level was marked as closed, so dont reopen.
 	    if (previous_frame->position == -1) {
-		settings->file_pointer = NULL;
+		file_close(settings);
 		strcpy(settings->filename, "");
 	    } else {
 		if(settings->file_pointer == NULL) {
@@ -409,7 +693,7 @@ int Interp::execute_return(setup_pointer settings, context_pointer current_frame
 		}
 		//!!!KL must open the new file, if changed
 		if (0 != strcmp(settings->filename, previous_frame->filename))  {
-		    fclose(settings->file_pointer);
+		    file_close(settings);
 		    settings->file_pointer = fopen(previous_frame->filename, "r");
 		    if (settings->file_pointer == NULL)  {
 			ERS(NCE_CANNOT_REOPEN_FILE, 
@@ -418,7 +702,7 @@ int Interp::execute_return(setup_pointer settings, context_pointer current_frame
 		    }
 		    strcpy(settings->filename, previous_frame->filename);
 		}
-		fseek(settings->file_pointer, previous_frame->position, SEEK_SET);
+		file_seek(settings, previous_frame->position);
 		settings->sequence_number = previous_frame->sequence_number;
 		logOword("endsub/return: %s:%d pos=%ld", 
 			 settings->filename,previous_frame->sequence_number,
@@ -495,7 +779,7 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 	    settings->sequence_number = 0;
             strncpy(settings->filename, op->filename, sizeof(settings->filename));
             if (settings->filename[sizeof(settings->filename)-1] != '\0') {
-                fclose(settings->file_pointer);
+                file_close(settings);
                 logOword("filename too long: %s", op->filename);
                 ERS(NCE_UNABLE_TO_OPEN_FILE, op->filename);
             }
@@ -503,7 +787,7 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 	    if (newFP) {
 		// close the old file...
 		if (settings->file_pointer) // only close if it was open
-		    fclose(settings->file_pointer);
+		    file_close(settings);
 		settings->file_pointer = newFP;
 	    } else {
 		logOword("Unable to open file: %s", settings->filename);
@@ -511,8 +795,7 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 	    }
 	}
 	if (settings->file_pointer) { // only seek if it was open
-	    fseek(settings->file_pointer,
-		  op->offset, SEEK_SET);
+	    file_seek(settings, op->offset);
 	}
 	settings->sequence_number = op->sequence_number;
 	return INTERP_OK;
@@ -525,7 +808,7 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 
 	// close the old file...
 	if (settings->file_pointer)
-	    fclose(settings->file_pointer);
+	    file_close(settings);
 	settings->file_pointer = newFP;
         strncpy(settings->filename, newFileName, sizeof(settings->filename));
         if (settings->filename[sizeof(settings->filename)-1] != '\0') {
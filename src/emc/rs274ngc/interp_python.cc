@@ -28,6 +28,7 @@ namespace bp = boost::python;
 #include <ctype.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <exception>
 
 #include "rs274ngc.hh"
@@ -92,6 +93,27 @@ bool Interp::is_pycallable(setup_pointer settings,
     return python_plugin->is_callable(module,funcname);
 }
 
+static double py_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void py_timed(remap_pointer r, double started)
+{
+    double t;
+
+    if (r == NULL)
+	return;
+    t = py_now() - started;
+    r->py_calls++;
+    r->py_seconds += t;
+    if (t > r->py_max_seconds)
+	r->py_max_seconds = t;
+}
+
 // all parameters to/results from Python calls go through the callframe, which looks a bit awkward
 // the reason is not to expose boost.python through the interpreter public interface
 int Interp::pycall(setup_pointer settings,
@@ -105,6 +127,8 @@ int Interp::pycall(setup_pointer settings,
     bool py_exception = false;
     int status = INTERP_OK;
     PyObject *res_str;
+    remap_pointer timed = NULL;
+    double started = 0.0;
 
     if (_setup.loggingLevel > 4)
 	logPy("pycall(%s.%s) \n", module ? module : "", funcname);
@@ -112,6 +136,19 @@ int Interp::pycall(setup_pointer settings,
     CHKS(!PYUSABLE, "pycall(%s): Pyhton plugin not initialized",funcname);
     frame->py_return_type = 0;
 
+    // the handlers of a remap are timed on its behalf
+    switch (calltype) {
+    case PY_PROLOG:
+    case PY_BODY:
+    case PY_EPILOG:
+    case PY_FINISH_PROLOG:
+    case PY_FINISH_BODY:
+    case PY_FINISH_EPILOG:
+	if ((timed = CONTROLLING_BLOCK(*settings).executing_remap) != NULL)
+	    started = py_now();
+	break;
+    }
+
     switch (calltype) {
     case PY_EXECUTE: // just run a string
 	python_plugin->run_string(funcname, retval);
@@ -142,6 +179,7 @@ int Interp::pycall(setup_pointer settings,
 		    bp::handle_exception();
 		    PyErr_Clear();
 		    logPy("pycall: call generator - StopIteration exception");
+		    py_timed(timed, started);
 		    return INTERP_OK;
 		} else  {
 		    msg = handle_pyerror();
@@ -261,6 +299,7 @@ int Interp::pycall(setup_pointer settings,
 	ERM("pycall: %s.%s:\n%s", module ? module:"", funcname, msg.c_str());
 	status = INTERP_ERROR;
     }
+    py_timed(timed, started);
     return status;
 }
 
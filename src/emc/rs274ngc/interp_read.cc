@@ -2514,9 +2514,10 @@ N.B.: We are now using six levels (right-bracket, logical operations,
 relational operations, plus-like operations, times-like operations, and
 power).
 
-*/
+Expressions of lines from the line cache are compiled the first time
+they are read and only executed after that, see interp_expression.cc.
 
-#define MAX_STACK 7
+*/
 
 int Interp::read_real_expression(char *line,     //!< string: line of RS274/NGC code being processed
                                 int *counter,   //!< pointer to a counter for position on the line 
@@ -2526,8 +2527,15 @@ int Interp::read_real_expression(char *line,     //!< string: line of RS274/NGC
   double values[MAX_STACK];
   int operators[MAX_STACK];
   int stack_index;
+  expr_code *code;
 
   CHKS((line[*counter] != '['), NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
+  // see interp_expression.cc
+  if ((code = compiled_expression(line, *counter)) && code->ok) {
+    CHP(execute_expression(code, value, parameters));
+    *counter = code->end;
+    return INTERP_OK;
+  }
   *counter = (*counter + 1);
   CHP(read_real_value(line, counter, values, parameters));
   CHP(read_operation(line, counter, operators));
@@ -2993,9 +3001,16 @@ int Interp::read_text(
     int *length)       //!< a pointer to an integer to be set
 {
   int index;
+  int read_length;
 
   if (command == NULL) {
-    if (fgets(raw_line, LINELEN, inport) == NULL) {
+    if (inport == _setup.file_pointer)
+      read_length = file_read_line(&_setup, raw_line);
+    else if (fgets(raw_line, LINELEN, inport) == NULL)
+      read_length = 0;
+    else
+      read_length = strlen(raw_line);
+    if (read_length == 0) {
       if(_setup.skipping_to_sub)
       {
         ERS(_("EOF in file:%s seeking o-word: o<%s> from line: %d"),
@@ -3013,18 +3028,18 @@ int Interp::read_text(
       }
     }
     _setup.sequence_number++;   /* moved from version1, was outside if */
-    if (strlen(raw_line) == (LINELEN - 1)) { // line is too long. need to finish reading the line to recover
-      for (; fgetc(inport) != '\n';) {
-      }                         // could also look for EOF
+    if ((read_length < 0) || (read_length == (LINELEN - 1))) { // line is too long
+      if (read_length > 0)
+        for (; fgetc(inport) != '\n';) {
+        }                       // could also look for EOF
       ERS(NCE_COMMAND_TOO_LONG);
     }
-    for (index = (strlen(raw_line) - 1);        // index set on last char
+    for (index = read_length - 1;       // index set on last char
          (index >= 0) && (isspace(raw_line[index]));
          index--) { // remove space at end of raw_line, especially CR & LF
       raw_line[index] = 0;
     }
-    strcpy(line, raw_line);
-    CHP(close_and_downcase(line));
+    CHP(close_and_downcase(raw_line, line));
     if ((line[0] == '%') && (line[1] == 0) && (_setup.percent_flag)) {
         FINISH();
         return INTERP_ENDFILE;
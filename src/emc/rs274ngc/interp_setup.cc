@@ -58,6 +58,11 @@ setup_struct::setup_struct() :
     feed_override(0),
     feed_rate (0.0),
     file_pointer(NULL),
+    file_map_fp(NULL),
+    file_map(NULL),
+    file_map_size(0),
+    file_map_pos(0),
+    file_map_generation(0),
     flood(0),
     length_units(0),
     spiral_tolerance_inch(0),
@@ -113,6 +118,13 @@ setup_struct::setup_struct() :
     value_returned(0),
     call_level(0),
     call_state(0),
+    file_index_current(NULL),
+    file_index_generation(0),
+    expr_codes(NULL),
+    hal_handles_generation(0),
+    checkpoint_origin(0),
+    checkpoint_origin_valid(false),
+    forked(false),
     adaptive_feed(0),
     feed_hold(0),
     loggingLevel(0),
@@ -80,6 +80,10 @@ void export_Internals()
 	.def_readwrite("remap_ngc",&remap::remap_ngc)
 	.def_readwrite("epilog_func",&remap::epilog_func)
 	.def_readwrite("motion_code",&remap::motion_code)
+	// zero these to start counting anew
+	.def_readwrite("py_calls",&remap::py_calls)
+	.def_readwrite("py_seconds",&remap::py_seconds)
+	.def_readwrite("py_max_seconds",&remap::py_max_seconds)
 	.def("__str__", &remap_str)
 
 	;
@@ -32,6 +32,9 @@ public:
 // close the currently open NC code file
  int close();
 
+// go on with a copy of the interpreter in a child process after fork()
+ int forked();
+
 // execute a line of NC code
  int execute(const char *command);
  int execute();
@@ -218,6 +221,7 @@ public:
  int check_m_codes(block_pointer block);
  int check_other_codes(block_pointer block);
  int close_and_downcase(char *line);
+ int close_and_downcase(const char *src, char *line);
  int convert_nurbs(int move, block_pointer block, setup_pointer settings);
  int convert_spline(int move, block_pointer block, setup_pointer settings);
  int comp_get_current(setup_pointer settings, double *x, double *y, double *z);
@@ -358,6 +362,13 @@ public:
  int execute_binary2(double *left, int operation, double *right);
     int execute_block(block_pointer block, setup_pointer settings);
  int execute_unary(double *double_ptr, int operation);
+ int execute_expression(expr_code *code, double *value, double *parameters);
+ expr_code *compiled_expression(char *line, int counter);
+ int compile_expression(char *line, int *counter, expr_code *code, int *depth);
+ int compile_value(char *line, int *counter, expr_code *code, int *depth);
+ int compile_parameter(char *line, int *counter, expr_code *code, int *depth,
+                       bool check_exists);
+ int compile_unary(char *line, int *counter, expr_code *code, int *depth);
  double find_arc_length(double x1, double y1, double z1,
                               double center_x, double center_y, int turn,
                               double x2, double y2, double z2);
@@ -461,6 +472,11 @@ public:
  int save_settings(setup_pointer settings);
  int restore_settings(setup_pointer settings, int from_level);
  int restore_from_tag(StateTag const &tag);
+ int save_checkpoint(std::string &state);
+ int restore_checkpoint(const char *state);
+ void checkpoint_state(std::string &state);
+ int checkpoint_modes(int *g, int *m, double *s, const EmcPose &tool_offset);
+ void checkpoint_start();
  int gen_settings(double *current, double *saved, std::string &cmd);
  int gen_g_codes(int *current, int *saved, std::string &cmd);
  int gen_m_codes(int *current, int *saved, std::string &cmd);
@@ -541,6 +557,9 @@ public:
   block_pointer block, // pointer to block
   setup_pointer settings);   /* pointer to machine settings */
 
+ int control_index_file(setup_pointer settings);
+ int control_skip_indexed(setup_pointer settings);
+
  // establish a new subroutine context
  int enter_context(setup_pointer settings, block_pointer block);
  // leave current subroutine context
@@ -642,6 +661,19 @@ int read_inputs(setup_pointer settings);
     int py_execute(const char *cmd, bool as_file = false); // for (py, ....) comments
     int py_reload();
     FILE *find_ngc_file(setup_pointer settings,const char *basename, char *foundhere = NULL);
+    int file_map(setup_pointer settings);
+    void file_unmap(setup_pointer settings);
+    void file_unmap_all(setup_pointer settings);
+    void file_close(setup_pointer settings);
+    long file_tell(setup_pointer settings);
+    int file_seek(setup_pointer settings, long position);
+    int file_read_line(setup_pointer settings, char *line);
+    int file_index_bind(setup_pointer settings);
+    cached_line *line_cache_find(setup_pointer settings, long offset);
+    int line_cache_read(setup_pointer settings, cached_line *cached);
+    int line_cache_parse(setup_pointer settings, cached_line *cached,
+			 block_pointer block);
+    void line_cache_store(setup_pointer settings, long offset, long end);
 
     const char *getSavedError();
     // set error message text without going through printf format interpretation
@@ -129,6 +129,7 @@ Interp::Interp()
 	// wrapper instance on every init(), abandoning the old one and all user attributes
 	// tacked onto it, so make sure this is done exactly once
 	_setup.pythis =  boost::python::object(boost::cref(*this));
+	_setup.pythis_args = bp::make_tuple(_setup.pythis);
 	
 	// alias to 'interpreter.this' for the sake of ';py, .... ' comments
 	// besides 'this', eventually use proper instance names to handle
@@ -227,8 +228,7 @@ int Interp::close()
     }
 
   if (_setup.file_pointer != NULL) {
-    fclose(_setup.file_pointer);
-    _setup.file_pointer = NULL;
+    file_close(&_setup);
     _setup.percent_flag = false;
   }
   reset();
@@ -237,6 +237,39 @@ int Interp::close()
 }
  
 
+/***********************************************************************/
+
+/*! Interp::forked
+
+Returned Value: int (INTERP_OK)
+
+Side Effects:
+   The NC-code file is dropped without reading, seeking or closing it.
+   The _setup world model is reset.
+   _hal[] named parameters cannot be read from now on.
+
+Called By: external programs, in the child after fork()
+
+The child's FILE of the open file shares its file descriptor's read
+position with the parent, so an fseek or fclose of it, which also
+seeks, would move the parent's. The FILE is left open until the child
+exits. A _hal[] lookup would make the child a HAL component that
+nothing removes when it exits, so those fail instead.
+
+*/
+
+int Interp::forked()
+{
+    logOword("forked()");
+    _setup.file_pointer = NULL;
+    file_unmap(&_setup);	// nothing to seek with file_pointer gone
+    _setup.percent_flag = false;
+    _setup.lazy_closing = 0;
+    _setup.forked = true;
+    reset();
+    return INTERP_OK;
+}
+
 /***********************************************************************/
 
 /*! Interp::execute
@@ -1127,7 +1160,11 @@ int Interp::init()
 //_setup.feed_override set in Interp::synch
 //_setup.feed_rate set in Interp::synch
   _setup.filename[0] = 0;
+  file_unmap_all(&_setup);
   _setup.file_pointer = NULL;
+  // what was cached of program files depends on the features and remaps
+  _setup.file_indexes.clear();
+  _setup.file_index_current = NULL;
 //_setup.flood set in Interp::synch
 //  _setup.tool_offset_index = 1;  // unused - removed, mah
 //_setup.length_units set in Interp::synch
@@ -1361,13 +1398,9 @@ int Interp::open(const char *filename) //!< string: the name of the input NC-pro
   CHKS((_setup.file_pointer == NULL), NCE_UNABLE_TO_OPEN_FILE, filename);
   line = _setup.linetext;
   for (index = -1; index == -1;) {      /* skip blank lines */
-    CHKS((fgets(line, LINELEN, _setup.file_pointer) ==
-         NULL), NCE_FILE_ENDED_WITH_NO_PERCENT_SIGN);
-    length = strlen(line);
-    if (length == (LINELEN - 1)) {   // line is too long. need to finish reading the line to recover
-      for (; fgetc(_setup.file_pointer) != '\n';);      // could look for EOF
-      ERS(NCE_COMMAND_TOO_LONG);
-    }
+    length = file_read_line(&_setup, line);
+    CHKS((length == 0), NCE_FILE_ENDED_WITH_NO_PERCENT_SIGN);
+    CHKS((length < 0), NCE_COMMAND_TOO_LONG);
     for (index = (length - 1);  // index set on last char
          (index >= 0) && (isspace(line[index])); index--);
   }
@@ -1378,16 +1411,17 @@ int Interp::open(const char *filename) //!< string: the name of the input NC-pro
       _setup.sequence_number = 1;       // We have already read the first line
       // and we are not going back to it.
     } else {
-      fseek(_setup.file_pointer, 0, SEEK_SET);
+      file_seek(&_setup, 0);
       _setup.percent_flag = false;
       _setup.sequence_number = 0;       // Going back to line 0
     }
   } else {
-    fseek(_setup.file_pointer, 0, SEEK_SET);
+    file_seek(&_setup, 0);
     _setup.percent_flag = false;
     _setup.sequence_number = 0; // Going back to line 0
   }
   strcpy(_setup.filename, filename);
+  _setup.checkpoint_origin_valid = false;
   reset();
   return INTERP_OK;
 }
@@ -1464,6 +1498,8 @@ int Interp::_read(const char *command)  //!< may be NULL or a string to read
 {
   static char name[] = "Interp::read";
   int read_status;
+  cached_line *cached = NULL;
+  long offset = -1, end = -1;
 
   // this input reading code is in the wrong place. It should be executed
   // in sync(), not here. This would make correct parameter values available 
@@ -1568,12 +1604,20 @@ int Interp::_read(const char *command)  //!< may be NULL or a string to read
 
   if(_setup.file_pointer)
   {
-      EXECUTING_BLOCK(_setup).offset = ftell(_setup.file_pointer);
+      if (_setup.skipping_o || _setup.skipping_to_sub)
+	  CHP(control_skip_indexed(&_setup));
+      offset = EXECUTING_BLOCK(_setup).offset = file_tell(&_setup);
   }
 
-  read_status =
-    read_text(command, _setup.file_pointer, _setup.linetext,
-              _setup.blocktext, &_setup.line_length);
+  if (command == NULL && (cached = line_cache_find(&_setup, offset)))
+      read_status = line_cache_read(&_setup, cached);
+  else {
+      read_status =
+	  read_text(command, _setup.file_pointer, _setup.linetext,
+		    _setup.blocktext, &_setup.line_length);
+      if (command == NULL)
+	  end = file_tell(&_setup);
+  }
 
   if (read_status == INTERP_ERROR && _setup.skipping_to_sub) {
     _setup.skipping_to_sub = NULL;
@@ -1585,7 +1629,19 @@ int Interp::_read(const char *command)  //!< may be NULL or a string to read
   if ((read_status == INTERP_EXECUTE_FINISH)
       || (read_status == INTERP_OK)) {
     if (_setup.line_length != 0) {
-	CHP(parse_line(_setup.blocktext, &(EXECUTING_BLOCK(_setup)), &_setup));
+	if (cached && cached->parsed && !_setup.skipping_o &&
+	    (cached->lathe_diameter_mode == _setup.lathe_diameter_mode))
+	    CHP(line_cache_parse(&_setup, cached, &(EXECUTING_BLOCK(_setup))));
+	else {
+	    // a Python named parameter may read a line of its own
+	    expr_code_map *saved_codes = _setup.expr_codes;
+	    int status;
+
+	    _setup.expr_codes = cached ? &cached->exprs : NULL;
+	    status = parse_line(_setup.blocktext, &(EXECUTING_BLOCK(_setup)), &_setup);
+	    _setup.expr_codes = saved_codes;
+	    CHP(status);
+	}
     }
 
     else // Blank line (zero length)
@@ -1604,6 +1660,8 @@ int Interp::_read(const char *command)  //!< may be NULL or a string to read
             EXECUTING_BLOCK(_setup).o_type = 0;
 	}
     }
+    if ((command == NULL) && !cached)
+	line_cache_store(&_setup, offset, end);
   } else if (read_status == INTERP_ENDFILE);
   else
     ERP(read_status);
@@ -1613,6 +1671,10 @@ int Interp::_read(const char *command)  //!< may be NULL or a string to read
 int Interp::read(const char *command) 
 {
     int status;
+    if (!command && _setup.file_pointer && !_setup.checkpoint_origin_valid &&
+	(_setup.call_level == 0) &&
+	(_setup.sequence_number == (_setup.percent_flag ? 1 : 0)))
+	checkpoint_start();
     if ((status = _read(command)) > INTERP_MIN_ERROR) {
 	unwind_call(status, __FILE__,__LINE__,__FUNCTION__);
     }
@@ -1648,13 +1710,13 @@ int Interp::unwind_call(int status, const char *file, int line, const char *func
 	// needed to make sure this works in rs274 -n 0 (continue on error) mode
 	if (sub->filename && sub->filename[0]) {
 	    if(0 != strcmp(_setup.filename, sub->filename)) {
-		fclose(_setup.file_pointer);
+		file_close(&_setup);
 		_setup.file_pointer = fopen(sub->filename, "r");
 		logDebug("unwind_call: reopening '%s' at %ld",
 			 sub->filename, sub->position);
 		strcpy(_setup.filename, sub->filename);
 	    }
-	    fseek(_setup.file_pointer, sub->position, SEEK_SET);
+	    file_seek(&_setup, sub->position);
 	}
 	_setup.sequence_number = sub->sequence_number;
 	logDebug("unwind_call: setting sequence number=%d from frame %d",
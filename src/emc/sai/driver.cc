@@ -30,6 +30,12 @@
 #include <string.h>   /* strcpy     */
 #include <getopt.h>
 #include <stdarg.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <new>
 #include <string>
 
 #include <readline/readline.h>
@@ -60,8 +66,14 @@ const char *history = "~/.rs274";
 #define interp_read	 interp_new.read
 #define interp_load_tool_table interp_new.load_tool_table
 #define interp_set_loglevel interp_new.set_loglevel
+#define call_level       interp_new.call_level
 #define interp_task_init interp_new.task_init
 
+/* in saicanon.cc and nullcanon.cc, for the -B mode */
+extern long _canon_calls;
+extern double _canon_time;
+extern bool _canon_record;
+
 /*
 
 This file contains the source code for an emulation of using the six-axis
@@ -71,6 +83,88 @@ rs274 interpreter from the EMC system.
 
 /*********************************************************************/
 
+/* benchmark mode (-B)
+
+The time interp_read and interp_execute take for a program is summed up
+per phase, and report_benchmark prints it to stderr together with the
+counts, one "name value" pair per line. The canon layer times its own
+calls (see _canon_time), which is taken out of the execute phase. Every
+operator new is counted, which covers the interpreter's C++ containers
+but not plain malloc. A remap whose Python functions ran gets a line
+with their calls, total and longest time.
+
+*/
+
+struct benchmark_stats {
+  int on;
+  long lines;             /* interp_read calls */
+  long blocks;            /* interp_execute calls on lines not empty */
+  double read_time;
+  double execute_time;    /* canon calls included */
+  double total_time;
+};
+static benchmark_stats bench;
+static unsigned long bench_allocations;
+
+void *operator new(size_t size)
+{
+  void *p;
+
+  bench_allocations++;
+  if ((p = malloc(size ? size : 1)) == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) throw()
+{
+  free(p);
+}
+
+static double bench_now()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double per_second(double count, double seconds)
+{
+  return (seconds > 0.0) ? (count / seconds) : 0.0;
+}
+
+void report_benchmark(const char *program)
+{
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+  fprintf(stderr, "program          %s\n", program);
+  fprintf(stderr, "lines            %ld\n", bench.lines);
+  fprintf(stderr, "blocks           %ld\n", bench.blocks);
+  fprintf(stderr, "canon-calls      %ld\n", _canon_calls);
+  fprintf(stderr, "seconds          %.6f\n", bench.total_time);
+  fprintf(stderr, "lines/s          %.0f\n", per_second(bench.lines, bench.total_time));
+  fprintf(stderr, "blocks/s         %.0f\n", per_second(bench.blocks, bench.total_time));
+  fprintf(stderr, "canon-calls/s    %.0f\n", per_second(_canon_calls, bench.total_time));
+  fprintf(stderr, "read-seconds     %.6f\n", bench.read_time);
+  fprintf(stderr, "execute-seconds  %.6f\n", bench.execute_time - _canon_time);
+  fprintf(stderr, "canon-seconds    %.6f\n", _canon_time);
+  fprintf(stderr, "peak-rss-kb      %ld\n", usage.ru_maxrss);
+  fprintf(stderr, "allocations      %lu\n", bench_allocations);
+  Interp *interp = dynamic_cast<Interp *>(pinterp);
+  if (interp == NULL)
+    return;
+  for (remap_iterator r = interp->_setup.remaps.begin();
+       r != interp->_setup.remaps.end(); r++)
+    if (r->second.py_calls)
+      fprintf(stderr, "remap %s calls %lu seconds %.6f max-seconds %.6f\n",
+              r->first, r->second.py_calls, r->second.py_seconds,
+              r->second.py_max_seconds);
+}
+
+/*********************************************************************/
+
 /* report_error
 
 Returned Value: none
@@ -246,12 +340,23 @@ int interpret_from_file( /* ARGUMENTS                  */
 {
   int status=0;
   char line[LINELEN];
+  double start = 0.0, t = 0.0;
 
   SET_BLOCK_DELETE(block_delete);
+  if (bench.on)
+    start = bench_now();
 
   for(; ;)
     {
-      status = interp_read();
+      if (bench.on)
+        {
+          t = bench_now();
+          status = interp_read();
+          bench.read_time += bench_now() - t;
+          bench.lines++;
+        }
+      else
+        status = interp_read();
       if ((status == INTERP_EXECUTE_FINISH) && (block_delete == ON))
         continue;
       else if (status == INTERP_ENDFILE)
@@ -281,7 +386,16 @@ int interpret_from_file( /* ARGUMENTS                  */
           else /* if do_next == 0 -- 0 means continue */
             continue;
         }
-      status = interp_execute();
+      if (bench.on)
+        {
+          t = bench_now();
+          status = interp_execute();
+          bench.execute_time += bench_now() - t;
+          if (line_length() != 0)
+            bench.blocks++;
+        }
+      else
+        status = interp_execute();
       if ((status != INTERP_OK) &&
           (status != INTERP_EXIT) &&
           (status != INTERP_EXECUTE_FINISH))
@@ -300,13 +414,163 @@ int interpret_from_file( /* ARGUMENTS                  */
             break;
         }
       else if (status == INTERP_EXIT)
-        return 0;
+        {
+          status = 0;
+          break;
+        }
     }
+  if (bench.on)
+    bench.total_time = bench_now() - start;
   return ((status == 1) ? 1 : 0);
 }
 
 /************************************************************************/
 
+/* run_from_line
+
+Returned Value: int (0 or 1), as interpret_from_file
+
+Side Effects:
+   The open NC-program file is interpreted from line start_line on.
+
+Called By:
+   main
+
+This emulates how task runs a program from a line (-r). A child process
+interprets the file without output first and takes a checkpoint at
+every line of the top level, like the pre-scan in task does. Of the
+checkpoints taken before the program first got to start_line, the last
+one is restored. The lines left before start_line are interpreted
+without output, the rest as by interpret_from_file. Which checkpoint was
+restored is reported on stderr; if none can be, the lines before
+start_line are all interpreted without output.
+
+*/
+
+int run_from_line(       /* ARGUMENTS                  */
+ int start_line,         /* line to start output at    */
+ int do_next,            /* what to do if error        */
+ int block_delete,       /* switch which is ON or OFF  */
+ int print_stack)        /* option which is ON or OFF  */
+{
+  FILE *checkpoints, *output = _outfile;
+  std::string state, found;
+  char line[LINELEN + PATH_MAX];
+  double position[6], found_position[6];
+  int status, at = 0;
+  pid_t pid;
+
+  checkpoints = tmpfile();
+  _outfile = fopen("/dev/null", "w");
+  if ((checkpoints == NULL) || (_outfile == NULL))
+    {
+      fprintf(stderr, "run from line: cannot open the checkpoint files\n");
+      return 1;
+    }
+  SET_BLOCK_DELETE(block_delete);
+
+  fflush(output);
+  fflush(stderr);
+  if ((pid = fork()) == 0)
+    {
+      for (; ;)
+        {
+          status = interp_read();
+          if ((status == INTERP_EXECUTE_FINISH) && (block_delete == ON))
+            continue;
+          if ((status != INTERP_OK) && (status != INTERP_EXECUTE_FINISH))
+            break;
+          status = interp_execute();
+          if ((status != INTERP_OK) && (status != INTERP_EXECUTE_FINISH))
+            break;
+          if (pinterp->save_checkpoint(state) == INTERP_OK)
+            fprintf(checkpoints, "position %.17g %.17g %.17g %.17g %.17g %.17g\n%s",
+                    GET_EXTERNAL_POSITION_X(), GET_EXTERNAL_POSITION_Y(),
+                    GET_EXTERNAL_POSITION_Z(), GET_EXTERNAL_POSITION_A(),
+                    GET_EXTERNAL_POSITION_B(), GET_EXTERNAL_POSITION_C(),
+                    state.c_str());
+        }
+      fflush(checkpoints);
+      _exit(0);
+    }
+  if ((pid == -1) || (waitpid(pid, NULL, 0) != pid))
+    fprintf(stderr, "run from line: no checkpoints taken\n");
+
+  rewind(checkpoints);
+  state.clear();
+  while (fgets(line, sizeof(line), checkpoints))
+    {
+      /* where the child's canon was, task has the machine for that */
+      if (sscanf(line, "position %lf %lf %lf %lf %lf %lf", &position[0],
+                 &position[1], &position[2], &position[3], &position[4],
+                 &position[5]) == 6)
+        continue;
+      if (sscanf(line, "checkpoint %d", &at) == 1)
+        {
+          if (at >= start_line)
+            break;
+          state.clear();
+        }
+      state += line;
+      if (!strcmp(line, "end\n"))
+        {
+          found = state;
+          memcpy(found_position, position, sizeof(position));
+          if (at == start_line - 1)
+            break;
+        }
+    }
+  fclose(checkpoints);
+
+  if (!found.empty())
+    {
+      sscanf(found.c_str(), "checkpoint %d", &at);
+      if ((status = pinterp->restore_checkpoint(found.c_str())) != INTERP_OK)
+        {
+          report_error(status, print_stack);
+          at = 0;
+        }
+      else
+        {
+          CANON_UPDATE_END_POINT(found_position[0], found_position[1],
+                                 found_position[2], found_position[3],
+                                 found_position[4], found_position[5],
+                                 0.0, 0.0, 0.0);
+          pinterp->synch();
+          fprintf(stderr, "restored the checkpoint at line %d\n", at);
+        }
+    }
+  else
+    at = 0;
+  if (at == 0)
+    fprintf(stderr, "no checkpoint, reading from the top\n");
+
+  /* the lines before start_line, at the top level */
+  while ((call_level() != 0) || (sequence_number() + 1 < start_line))
+    {
+      status = interp_read();
+      if ((status == INTERP_EXECUTE_FINISH) && (block_delete == ON))
+        continue;
+      if ((status != INTERP_OK) && (status != INTERP_EXECUTE_FINISH))
+        break;
+      status = interp_execute();
+      if ((status != INTERP_OK) && (status != INTERP_EXECUTE_FINISH))
+        break;
+    }
+  fclose(_outfile);
+  _outfile = output;
+  if ((status != INTERP_OK) && (status != INTERP_EXECUTE_FINISH))
+    {
+      if (status == INTERP_ENDFILE || status == INTERP_EXIT)
+        return 0;
+      report_error(status, print_stack);
+      return 1;
+    }
+  return interpret_from_file(do_next, block_delete, print_stack);
+}
+
+/************************************************************************/
+
 /* read_tool_file
 
 Returned Value: int
@@ -546,6 +810,7 @@ int main (int argc, char ** argv)
   int go_flag;
   char *inifile = NULL;
   int log_level = -1;
+  int start_line = 0;
   std::string interp;
 
   do_next = 2;  /* 2=stop */
@@ -557,7 +822,7 @@ int main (int argc, char ** argv)
   go_flag = 0;
 
   while(1) {
-      int c = getopt(argc, argv, "p:t:v:bsn:gi:l:T");
+      int c = getopt(argc, argv, "p:t:v:bsn:gi:l:TBr:");
       if(c == -1) break;
 
       switch(c) {
@@ -571,6 +836,8 @@ int main (int argc, char ** argv)
           case 'g': go_flag = !go_flag; break;
           case 'i': inifile = optarg; break;
           case 'T': _task = 1; break;
+          case 'B': bench.on = 1; go_flag = 1; break;
+          case 'r': start_line = atoi(optarg); break;
           case '?': default: goto usage;
       }
   }
@@ -580,7 +847,7 @@ int main (int argc, char ** argv)
 usage:
       fprintf(stderr,
             "Usage: %s [-p interp.so] [-t tool.tbl] [-v var-file.var] [-n 0|1|2]\n"
-            "          [-b] [-s] [-g] [input file [output file]]\n"
+            "          [-b] [-s] [-g] [-B] [-r line] [input file [output file]]\n"
             "\n"
             "    -p: Specify the pluggable interpreter to use\n"
             "    -t: Specify the .tbl (tool table) file to use\n"
@@ -595,6 +862,11 @@ usage:
             "    -i: specify the .ini file (default: no ini file)\n"
             "    -T: call task_init()\n"
             "    -l: specify the log_level (default: -1)\n"
+            "    -B: benchmark: run the input file in batch mode and print\n"
+            "        throughput and time per phase to stderr. The canon calls\n"
+            "        are only recorded if an output file is given\n"
+            "    -r: run from line: start the output at the given line, from\n"
+            "        the nearest checkpoint before it\n"
             , argv[0]);
       exit(1);
     }
@@ -655,6 +927,21 @@ usage:
           fprintf(stderr, "could not open output file %s\n", argv[2]);
           exit(1);
         }
+      _canon_record = true;
+    }
+  else if (bench.on)
+    {
+      if (argc != 2)
+        {
+          fprintf(stderr, "-B needs an input file\n");
+          exit(1);
+        }
+      _outfile = fopen("/dev/null", "w");
+      if (_outfile == NULL)
+        {
+          fprintf(stderr, "could not open /dev/null\n");
+          exit(1);
+        }
     }
   if (inifile!= 0) {
       setenv("INI_FILE_NAME",inifile,1);
@@ -681,10 +968,15 @@ usage:
           report_error(status, print_stack);
           exit(1);
         }
-      status = interpret_from_file(do_next, block_delete, print_stack);
+      if (start_line > 1)
+        status = run_from_line(start_line, do_next, block_delete, print_stack);
+      else
+        status = interpret_from_file(do_next, block_delete, print_stack);
       file_name(buffer, 5);  /* called to exercise the function */
       file_name(buffer, 79); /* called to exercise the function */
       interp_close();
+      if (bench.on)
+        report_benchmark(argv[1]);
     }
   line_length();         /* called to exercise the function */
   sequence_number();     /* called to exercise the function */
@@ -63,6 +63,18 @@ static EmcPose _tool_offset;
 static bool _toolchanger_fault;
 static int  _toolchanger_reason;
 
+/* For the driver's -B mode: the canon calls made and, if _canon_record is
+   set, the name of each call written to _outfile. Nothing here takes time
+   worth measuring, so _canon_time stays 0. */
+long   _canon_calls = 0;
+double _canon_time = 0.0;
+bool   _canon_record = false;
+
+#define CANON_CALL() if (1)                                       \
+          {_canon_calls++;                                        \
+           if (_canon_record) fprintf(_outfile, "%s\n", __func__); \
+          } else
+
 /************************************************************************/
 
 /* Canonical "Do it" functions
@@ -155,27 +167,45 @@ void print_nc_line_number()
 /* Representation */
 
 void SET_XY_ROTATION(double t) {
+  CANON_CALL();
 }
 
 void SET_G5X_OFFSET(int index,
                     double x, double y, double z,
                     double a, double b, double c,
                     double u, double v, double w) {
+  CANON_CALL();
 }
 
 void SET_G92_OFFSET(double x, double y, double z,
                     double a, double b, double c,
                     double u, double v, double w) {
+  CANON_CALL();
+}
+
+/* the position task skips to when it runs a program from a line;
+   not a canon call of the program, so nothing is printed */
+void CANON_UPDATE_END_POINT(double x, double y, double z,
+                            double a, double b, double c,
+                            double u, double v, double w)
+{
+  _program_position_x = x;
+  _program_position_y = y;
+  _program_position_z = z;
+  _program_position_a = a; /*AA*/
+  _program_position_b = b; /*BB*/
+  _program_position_c = c; /*CC*/
 }
 
 void USE_LENGTH_UNITS(CANON_UNITS in_unit)
 {
+  CANON_CALL();
 }
 
 /* Free Space Motion */
 void SET_TRAVERSE_RATE(double rate)
 {
-
+  CANON_CALL();
 }
 
 void STRAIGHT_TRAVERSE( int line_number,
@@ -186,56 +216,62 @@ void STRAIGHT_TRAVERSE( int line_number,
  , double u, double v, double w
 )
 {
+  CANON_CALL();
 }
 
 /* Machining Attributes */
 void SET_FEED_MODE(int mode)
 {
+  CANON_CALL();
 }
 void SET_FEED_RATE(double rate)
 {
+  CANON_CALL();
 }
 
 void SET_FEED_REFERENCE(CANON_FEED_REFERENCE reference)
 {
-
+  CANON_CALL();
 }
 
 extern void SET_MOTION_CONTROL_MODE(CANON_MOTION_MODE mode, double tolerance)
 {
+  CANON_CALL();
 }
 
 extern void SET_NAIVECAM_TOLERANCE(double tolerance)
 {
+  CANON_CALL();
 }
 
 void SELECT_PLANE(CANON_PLANE in_plane)
 {
-
+  CANON_CALL();
 }
 
 void SET_CUTTER_RADIUS_COMPENSATION(double radius)
-{}
+{CANON_CALL();}
 
 void START_CUTTER_RADIUS_COMPENSATION(int side)
 {
+  CANON_CALL();
 }
 
 void STOP_CUTTER_RADIUS_COMPENSATION()
-{}
+{CANON_CALL();}
 
 void START_SPEED_FEED_SYNCH()
-{}
+{CANON_CALL();}
 
 void STOP_SPEED_FEED_SYNCH()
-{}
+{CANON_CALL();}
 
 /* Machining Functions */
 
 void NURBS_FEED(int lineno,
 std::vector<CONTROL_POINT> nurbs_control_points, unsigned int k)
 {
-
+  CANON_CALL();
 }
 
 void ARC_FEED(int line_number,
@@ -247,7 +283,7 @@ void ARC_FEED(int line_number,
  , double u, double v, double w
 )
 {
-
+  CANON_CALL();
 }
 
 void STRAIGHT_FEED(int line_number,
@@ -258,7 +294,7 @@ void STRAIGHT_FEED(int line_number,
  , double u, double v, double w
 )
 {
-
+  CANON_CALL();
 }
 
 
@@ -274,161 +310,173 @@ void STRAIGHT_PROBE(int line_number,
  , double u, double v, double w, unsigned char probe_type
 )
 {
-
+  CANON_CALL();
 }
 
 
 void RIGID_TAP(int line_number, double x, double y, double z)
 {
+  CANON_CALL();
 }
 
 
 void DWELL(double seconds)
-{}
+{CANON_CALL();}
 
 /* Spindle Functions */
 void SPINDLE_RETRACT_TRAVERSE()
-{}
+{CANON_CALL();}
 
 void SET_SPINDLE_MODE(double arg) {
+  CANON_CALL();
 }
 
 void START_SPINDLE_CLOCKWISE()
 {
+  CANON_CALL();
 }
 
 void START_SPINDLE_COUNTERCLOCKWISE()
 {
-
+  CANON_CALL();
 }
 
 void SET_SPINDLE_SPEED(double rpm)
 {
+  CANON_CALL();
 }
 
 void STOP_SPINDLE_TURNING()
 {
-
+  CANON_CALL();
 }
 
 void SPINDLE_RETRACT()
-{}
+{CANON_CALL();}
 
 void ORIENT_SPINDLE(double orientation, int mode)
 {
+  CANON_CALL();
 }
 
 void WAIT_SPINDLE_ORIENT_COMPLETE(double timeout)
 {
+  CANON_CALL();
 }
 
 void USE_NO_SPINDLE_FORCE()
-{}
+{CANON_CALL();}
 
 /* Tool Functions */
 void SET_TOOL_TABLE_ENTRY(int pocket, int toolno, EmcPose offset, double diameter,
                           double frontangle, double backangle, int orientation) {
+  CANON_CALL();
 }
 
 void USE_TOOL_LENGTH_OFFSET(EmcPose offset)
 {
+  CANON_CALL();
 }
 
 void CHANGE_TOOL(int slot)
 {
-
+  CANON_CALL();
 }
 
 void SELECT_POCKET(int slot, int tool)
-{}
+{CANON_CALL();}
 
 void CHANGE_TOOL_NUMBER(int slot)
 {
-
+  CANON_CALL();
 }
 
 
 /* Misc Functions */
 
 void CLAMP_AXIS(CANON_AXIS axis)
-{}
+{CANON_CALL();}
 
 void COMMENT(const char *s)
-{}
+{CANON_CALL();}
 
 void DISABLE_ADAPTIVE_FEED()
-{}
+{CANON_CALL();}
 
 void DISABLE_FEED_HOLD()
-{}
+{CANON_CALL();}
 
 void DISABLE_FEED_OVERRIDE()
-{}
+{CANON_CALL();}
 
 void DISABLE_SPEED_OVERRIDE()
-{}
+{CANON_CALL();}
 
 void ENABLE_ADAPTIVE_FEED()
-{}
+{CANON_CALL();}
 
 void ENABLE_FEED_HOLD()
-{}
+{CANON_CALL();}
 
 void ENABLE_FEED_OVERRIDE()
-{}
+{CANON_CALL();}
 
 void ENABLE_SPEED_OVERRIDE()
-{}
+{CANON_CALL();}
 
 void FLOOD_OFF()
 {
+  CANON_CALL();
 }
 
 void FLOOD_ON()
 {
+  CANON_CALL();
 }
 
 void INIT_CANON()
 {
+  CANON_CALL();
 }
 
 void MESSAGE(char *s)
-{}
+{CANON_CALL();}
 
 void LOG(char *s)
-{}
+{CANON_CALL();}
 void LOGOPEN(char *s)
-{}
+{CANON_CALL();}
 void LOGAPPEND(char *s)
-{}
+{CANON_CALL();}
 void LOGCLOSE()
-{}
+{CANON_CALL();}
 
 void MIST_OFF()
 {
-
+  CANON_CALL();
 }
 
 void MIST_ON()
 {
+  CANON_CALL();
 }
 
 void PALLET_SHUTTLE()
-{}
+{CANON_CALL();}
 
 void TURN_PROBE_OFF()
-{}
+{CANON_CALL();}
 
 void TURN_PROBE_ON()
-{}
+{CANON_CALL();}
 
 void UNCLAMP_AXIS(CANON_AXIS axis)
-{}
+{CANON_CALL();}
 
 /* Program Functions */
 
 void PROGRAM_STOP()
-{}
+{CANON_CALL();}
 
 void SET_BLOCK_DELETE(bool state)
 {block_delete = state;} //state == ON, means we don't interpret lines starting with "/"
@@ -443,10 +491,10 @@ bool GET_OPTIONAL_PROGRAM_STOP()
 {return optional_program_stop;} //state == ON, means we stop
 
 void OPTIONAL_PROGRAM_STOP()
-{}
+{CANON_CALL();}
 
 void PROGRAM_END()
-{}
+{CANON_CALL();}
 
 
 /*************************************************************************/
@@ -480,7 +528,7 @@ double GET_EXTERNAL_ANGLE_UNITS() {return 1.0;}
 int GET_EXTERNAL_SELECTED_TOOL_SLOT() { return 0; }
 int GET_EXTERNAL_SPINDLE_OVERRIDE_ENABLE() {return 1;}
 void START_SPEED_FEED_SYNCH(double sync, bool vel)
-{}
+{CANON_CALL();}
 CANON_MOTION_MODE motion_mode;
 
 int GET_EXTERNAL_DIGITAL_INPUT(int index, int def) { return def; }
@@ -725,31 +773,37 @@ int USER_DEFINED_FUNCTION_ADD(USER_DEFINED_FUNCTION_TYPE func, int num)
 
 void SET_MOTION_OUTPUT_BIT(int index)
 {
+    CANON_CALL();
     return;
 }
 
 void CLEAR_MOTION_OUTPUT_BIT(int index)
 {
+    CANON_CALL();
     return;
 }
 
 void SET_MOTION_OUTPUT_VALUE(int index, double value)
 {
+    CANON_CALL();
     return;
 }
 
 void SET_AUX_OUTPUT_BIT(int index)
 {
+    CANON_CALL();
     return;
 }
 
 void CLEAR_AUX_OUTPUT_BIT(int index)
 {
+    CANON_CALL();
     return;
 }
 
 void SET_AUX_OUTPUT_VALUE(int index, double value)
 {
+    CANON_CALL();
     return;
 }
 
@@ -799,9 +853,11 @@ double GET_EXTERNAL_TOOL_LENGTH_WOFFSET()
 }
 
 void FINISH(void) {
+  CANON_CALL();
 }
 
 void START_CHANGE(void) {
+  CANON_CALL();
 }
 
 
@@ -818,6 +874,7 @@ int GET_EXTERNAL_TC_REASON()
 /* Sends error message */
 void CANON_ERROR(const char *fmt, ...)
 {
+    CANON_CALL();
     va_list ap;
 
     if (fmt != NULL) {
@@ -839,8 +896,14 @@ void CANON_ERROR(const char *fmt, ...)
 }
 void PLUGIN_CALL(int len, const char *call)
 {
+  CANON_CALL();
 }
 
 void IO_PLUGIN_CALL(int len, const char *call)
+{
+  CANON_CALL();
+}
+
+void UPDATE_TAG(StateTag tag)
 {
 }
@@ -40,6 +40,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <time.h>
 
 /* where to print */
 //extern FILE * _outfile;
@@ -91,6 +92,23 @@ static EmcPose _tool_offset;
 static bool _toolchanger_fault;
 static int  _toolchanger_reason;
 
+/* For the driver's -B mode: the canon calls printed and the time spent
+   printing them. This canon layer always records the calls. */
+long   _canon_calls = 0;
+double _canon_time = 0.0;
+bool   _canon_record = true;
+
+struct canon_timer {
+    struct timespec start;
+    canon_timer() { clock_gettime(CLOCK_MONOTONIC, &start); }
+    ~canon_timer() {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        _canon_time += (end.tv_sec - start.tv_sec) +
+            (end.tv_nsec - start.tv_nsec) * 1e-9;
+    }
+};
+
 /************************************************************************/
 
 /* Canonical "Do it" functions
@@ -118,6 +136,7 @@ void print_nc_line_number()
   int k;
   int m;
 
+  _canon_calls++;
   if(NULL == _outfile)
     {
       _outfile = stdout;
@@ -144,63 +163,63 @@ void print_nc_line_number()
 
 
 #define PRINT0(control) if (1)                        \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++); \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++); \
            print_nc_line_number();                    \
            {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  control);                \
           } else
 #define PRINT1(control, arg1) if (1)                  \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++); \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++); \
            print_nc_line_number();                    \
            {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  control, arg1);          \
           } else
 #define PRINT2(control, arg1, arg2) if (1)            \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++); \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++); \
            print_nc_line_number();                    \
            {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  control, arg1, arg2);    \
           } else
 #define PRINT3(control, arg1, arg2, arg3) if (1)         \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);    \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);    \
            print_nc_line_number();                       \
            {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  control, arg1, arg2, arg3); \
           } else
 #define PRINT4(control, arg1, arg2, arg3, arg4) if (1)         \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);          \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);          \
            print_nc_line_number();                             \
            {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  control, arg1, arg2, arg3, arg4); \
           } else
 #define PRINT5(control, arg1, arg2, arg3, arg4, arg5) if (1)         \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                \
            print_nc_line_number();                                   \
            {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  control, arg1, arg2, arg3, arg4, arg5); \
           } else
 #define PRINT6(control, arg1, arg2, arg3, arg4, arg5, arg6) if (1)         \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                      \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                      \
            print_nc_line_number();                                         \
            {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  control, arg1, arg2, arg3, arg4, arg5, arg6); \
           } else
 #define PRINT7(control, arg1, arg2, arg3, arg4, arg5, arg6, arg7) if (1) \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                    \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                    \
            print_nc_line_number();                                       \
            {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  control,                                    \
                            arg1, arg2, arg3, arg4, arg5, arg6, arg7);    \
           } else
 #define PRINT9(control,arg1,arg2,arg3,arg4,arg5,arg6,arg7,arg8,arg9) \
           if (1)                                                            \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                       \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                       \
            print_nc_line_number();                                          \
            fprintf(_outfile, control,                                       \
                    arg1,arg2,arg3,arg4,arg5,arg6,arg7,arg8,arg9);           \
           } else
 #define PRINT10(control,arg1,arg2,arg3,arg4,arg5,arg6,arg7,arg8,arg9,arg10) \
           if (1)                                                            \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                       \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                       \
            print_nc_line_number();                                          \
            fprintf(_outfile, control,                                       \
                    arg1,arg2,arg3,arg4,arg5,arg6,arg7,arg8,arg9,arg10);     \
           } else
 #define PRINT14(control,arg1,arg2,arg3,arg4,arg5,arg6,arg7,arg8,arg9,arg10,arg11,arg12,arg13,arg14) \
           if (1)                                                            \
-          {{if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                       \
+          {canon_timer timer; {if(_outfile==NULL){_outfile=stdout;}} fprintf(_outfile,  "%5d ", _line_number++);                       \
            print_nc_line_number();                                          \
            fprintf(_outfile, control,                                       \
                    arg1,arg2,arg3,arg4,arg5,arg6,arg7,arg8,arg9,arg10,arg11,arg12,arg13,arg14); \
@@ -209,6 +228,7 @@ void print_nc_line_number()
 /* Representation */
 
 void SET_XY_ROTATION(double t) {
+  canon_timer timer;
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "SET_XY_ROTATION(%.4f)\n", t);
@@ -220,6 +240,7 @@ void SET_G5X_OFFSET(int index,
                     double x, double y, double z,
                     double a, double b, double c,
                     double u, double v, double w) {
+  canon_timer timer;
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "SET_G5X_OFFSET(%d, %.4f, %.4f, %.4f, %.4f, %.4f, %.4f)\n",
@@ -242,6 +263,7 @@ void SET_G5X_OFFSET(int index,
 void SET_G92_OFFSET(double x, double y, double z,
                     double a, double b, double c,
                     double u, double v, double w) {
+  canon_timer timer;
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "SET_G92_OFFSET(%.4f, %.4f, %.4f, %.4f, %.4f, %.4f)\n",
@@ -261,6 +283,20 @@ void SET_G92_OFFSET(double x, double y, double z,
   _g92_c = c;  /*CC*/
 }
 
+/* the position task skips to when it runs a program from a line;
+   not a canon call of the program, so nothing is printed */
+void CANON_UPDATE_END_POINT(double x, double y, double z,
+                            double a, double b, double c,
+                            double u, double v, double w)
+{
+  _program_position_x = x;
+  _program_position_y = y;
+  _program_position_z = z;
+  _program_position_a = a; /*AA*/
+  _program_position_b = b; /*BB*/
+  _program_position_c = c; /*CC*/
+}
+
 void USE_LENGTH_UNITS(CANON_UNITS in_unit)
 {
   if (in_unit == CANON_UNITS_INCHES)
@@ -324,6 +360,7 @@ void STRAIGHT_TRAVERSE( int line_number,
  , double u, double v, double w
 )
 {
+  canon_timer timer;
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "STRAIGHT_TRAVERSE(%.4f, %.4f, %.4f"
@@ -422,6 +459,7 @@ void STOP_SPEED_FEED_SYNCH()
 void NURBS_FEED(int lineno,
 std::vector<CONTROL_POINT> nurbs_control_points, unsigned int k)
 {
+  canon_timer timer;
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "NURBS_FEED(%lu, ...)\n", (unsigned long)nurbs_control_points.size());
@@ -439,6 +477,7 @@ void ARC_FEED(int line_number,
  , double u, double v, double w
 )
 {
+  canon_timer timer;
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "ARC_FEED(%.4f, %.4f, %.4f, %.4f, %d, %.4f"
@@ -482,6 +521,7 @@ void STRAIGHT_FEED(int line_number,
  , double u, double v, double w
 )
 {
+  canon_timer timer;
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "STRAIGHT_FEED(%.4f, %.4f, %.4f"
@@ -523,6 +563,8 @@ void STRAIGHT_PROBE(int line_number,
   dz = (_program_position_z - z);
   distance = rtapi_sqrt((dx * dx) + (dy * dy) + (dz * dz));
 
+  canon_timer timer;
+
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "STRAIGHT_PROBE(%.4f, %.4f, %.4f"
@@ -557,6 +599,9 @@ void RIGID_TAP(int line_number, double x, double y, double z)
 {
 
 
+    canon_timer timer;
+
+
     fprintf(_outfile, "%5d ", _line_number++);
     print_nc_line_number();
     fprintf(_outfile, "RIGID_TAP(%.4f, %.4f, %.4f)\n", x, y, z);
@@ -501,6 +501,49 @@ static double toExtVel(double vel) {
 
 static double toExtAcc(double acc) { return toExtVel(acc); }
 
+/* XYZ direction at the end of the last move sent to motion, used for the
+   corner speed caps below */
+static PM_CARTESIAN preplanDir;
+static bool preplanDirValid = false;
+
+/* Highest speed at which a curve of the given radius (mm) can be followed
+   without exceeding [TRAJ]PREPLAN_MAX_JERK: v^3 / r^2 <= j. */
+static double preplanJerkVel(double radius)
+{
+    return rtapi_cbrt(FROM_EXT_LEN(traj_preplan_max_jerk) * radius * radius);
+}
+
+/* Speed cap in mm/sec for the corner between the last move sent and a new
+   one that starts in direction dir_in and ends in direction dir_out, or -1
+   for none.  The tightest path through the corner that stays within the
+   G64 P tolerance is a circle tangent to both moves; the cap is the jerk
+   limited speed on that circle.  It is only sent to the TP as an upper
+   bound, nothing is held back here waiting for later moves. */
+static double preplanCorner(PM_CARTESIAN dir_in, PM_CARTESIAN dir_out)
+{
+    bool have_prev = preplanDirValid;
+    PM_CARTESIAN prev = preplanDir;
+
+    preplanDirValid = mag(dir_out) > CART_FUZZ;
+    if (preplanDirValid) {
+        preplanDir = unit(dir_out);
+    }
+
+    if (traj_preplan_max_jerk <= 0 || !have_prev
+            || canonMotionMode != CANON_CONTINUOUS
+            || canonMotionTolerance <= 0 || mag(dir_in) <= CART_FUZZ) {
+        return -1;
+    }
+
+    double c = dot(prev, unit(dir_in));
+    if (c >= 1 - 1e-9) {
+        return -1;  // tangent, no corner
+    }
+    // sin of half the angle between the two moves
+    double s = rtapi_sqrt(rtapi_fmax(0.0, (1 + c) / 2));
+    return preplanJerkVel(canonMotionTolerance * s / (1 - s));
+}
+
 static void send_g5x_msg(int index) {
     flush_segments();
 
@@ -966,6 +1009,11 @@ static void flush_segments(void) {
 
     linearMoveMsg.type = EMC_MOTION_TYPE_FEED;
     linearMoveMsg.indexrotary = -1;
+    PM_CARTESIAN dir(x - canonEndPoint.x, y - canonEndPoint.y, z - canonEndPoint.z);
+    double corner_vel = preplanCorner(dir, dir);
+    if (corner_vel >= 0) {
+        linearMoveMsg.planned_vel = toExtVel(corner_vel);
+    }
     if ((vel && acc) || synched) {
         interp_list.set_line_number(line_no);
         tag_and_send(linearMoveMsg,pos.tag);
@@ -1082,6 +1130,11 @@ void STRAIGHT_TRAVERSE(int line_number,
     linearMoveMsg.vel = linearMoveMsg.ini_maxvel = toExtVel(vel);
     linearMoveMsg.acc = toExtAcc(acc);
     linearMoveMsg.indexrotary = rotary_unlock_for_traverse;
+    PM_CARTESIAN dir(x - canonEndPoint.x, y - canonEndPoint.y, z - canonEndPoint.z);
+    double corner_vel = preplanCorner(dir, dir);
+    if (corner_vel >= 0) {
+        linearMoveMsg.planned_vel = toExtVel(corner_vel);
+    }
 
     int old_feed_mode = feed_mode;
     if(feed_mode)
@@ -1140,6 +1193,7 @@ void RIGID_TAP(int line_number, double x, double y, double z)
     rigidTapMsg.acc = toExtAcc(acc);
 
     flush_segments();
+    preplanDirValid = false;
 
     if(ini_maxvel && acc)  {
         interp_list.set_line_number(line_number);
@@ -1168,6 +1222,7 @@ void STRAIGHT_PROBE(int line_number,
     rotate_and_offset_pos(x,y,z,a,b,c,u,v,w);
 
     flush_segments();
+    preplanDirValid = false;
 
     VelData veldata = getStraightVelocity(x, y, z, a, b, c, u, v, w);
     ini_maxvel = vel = veldata.vel;
@@ -1744,6 +1799,9 @@ void ARC_FEED(int line_number,
 
     // Restrict our maximum velocity in-plane if need be
     double v_max_planar = MIN(v_max_radial, v_max_axes);
+    if (traj_preplan_max_jerk > 0) {
+        v_max_planar = MIN(v_max_planar, preplanJerkVel(effective_radius));
+    }
     canon_debug("v_max_planar = %f\n", v_max_planar);
 
     // Find the equivalent maximum velocity for a linear displacement
@@ -1799,6 +1857,21 @@ void ARC_FEED(int line_number,
 
     cartesian_move = 1;
 
+    // Directions at the start and end for the corner speed cap: tangential
+    // (in the direction of travel), radial (spiral) and axial (helix) parts
+    double sweep = rtapi_fabs(full_angle);
+    double travel = full_angle > 0 ? 1.0 : -1.0;
+    PM_CARTESIAN start_dir = travel * (p_start_1 * plane_y - p_start_2 * plane_x)
+        + (spiral / sweep / start_radius) * (p_start_1 * plane_x + p_start_2 * plane_y)
+        + (axis_len / sweep) * normal_cart;
+    PM_CARTESIAN end_dir = travel * (p_end_1 * plane_y - p_end_2 * plane_x)
+        + (spiral / sweep / end_radius) * (p_end_1 * plane_x + p_end_2 * plane_y)
+        + (axis_len / sweep) * normal_cart;
+    double corner_vel = preplanCorner(start_dir, end_dir);
+    if (corner_vel >= 0) {
+        linearMoveMsg.planned_vel = circularMoveMsg.planned_vel = toExtVel(corner_vel);
+    }
+
     if (rotation == 0) {
         // linear move
         // FIXME (Rob) Am I missing something? the P word should never be zero,
@@ -2515,6 +2588,7 @@ void INIT_CANON()
     double units;
 
     chained_points.clear();
+    preplanDirValid = false;
 
     // initialize locals to original values
     g5xOffset.x = 0.0;
@@ -2617,6 +2691,7 @@ CANON_POSITION GET_EXTERNAL_POSITION()
     EmcPose pos;
 
     chained_points.clear();
+    preplanDirValid = false;
 
     pos = emcStatus->motion.traj.position;
 
@@ -19,6 +19,8 @@
 #include <unistd.h>		// stat()
 #include <limits.h>		// PATH_MAX
 #include <dlfcn.h>
+#include <map>
+#include <string>
 
 #include "rcs.hh"		// INIFILE
 #include "emc.hh"		// EMC NML
@@ -39,6 +41,14 @@
 #define MAX_M_DIRS (USER_DEFINED_FUNCTION_MAX_DIRS+1)
 //note:the +1 is for the PROGRAM_PREFIX or default directory==nc_files
 
+/* checkpoints of the interpreter state in the program last opened, by
+   line, for as long as the file stays the same; see
+   emcTaskPlanRestoreCheckpoint() */
+static std::map<int, std::string> checkpoints;
+static std::string checkpointFile;
+static struct stat checkpointStat;
+static int checkpointLine = 0;		// last one taken in this run
+
 /* flag for how we want to interpret traj coord mode, as mdi or auto */
 static int mdiOrAuto = EMC_TASK_MODE_AUTO;
 
@@ -532,6 +542,19 @@ int emcTaskPlanOpen(const char *file)
     }
     taskplanopen = 1;
 
+    // the checkpoints are kept if this is the program they were taken in
+    struct stat st;
+    if (stat(file, &st) != 0)
+	memset(&st, 0, sizeof(st));
+    if (checkpointFile != file || st.st_size != checkpointStat.st_size ||
+	st.st_mtim.tv_sec != checkpointStat.st_mtim.tv_sec ||
+	st.st_mtim.tv_nsec != checkpointStat.st_mtim.tv_nsec) {
+	checkpoints.clear();
+	checkpointFile = file;
+	checkpointStat = st;
+    }
+    checkpointLine = 0;
+
     if (emc_debug & EMC_DEBUG_INTERP) {
         rcs_print("emcTaskPlanOpen(%s) returned %d\n", file, retval);
     }
@@ -648,6 +671,70 @@ int emcTaskPlanLevel()
     return retval;
 }
 
+int emcTaskPlanCheckpoint(int interval)
+{
+    std::string state;
+    int line = interp.line();
+
+    if (line < checkpointLine + interval)
+	return 0;
+    // not taken inside a sub, a remap or with cutter comp on
+    if (interp.save_checkpoint(state) != INTERP_OK)
+	return -1;
+    checkpoints[line] = state;
+    checkpointLine = line;
+    return 0;
+}
+
+int emcTaskPlanLoadCheckpoints(const char *path)
+{
+    char text[2 * LINELEN + PATH_MAX];
+    std::string state;
+    int line = 0, count = 0;
+    FILE *in;
+
+    if ((in = fopen(path, "r")) == NULL)
+	return -1;
+    while (fgets(text, sizeof(text), in)) {
+	if (sscanf(text, "checkpoint %d", &line) == 1)
+	    state.clear();
+	state += text;
+	if (!strcmp(text, "end\n") && line > 0) {
+	    checkpoints[line] = state;
+	    count++;
+	}
+    }
+    fclose(in);
+
+    if (emc_debug & EMC_DEBUG_INTERP) {
+        rcs_print("emcTaskPlanLoadCheckpoints(%s) loaded %d\n", path, count);
+    }
+
+    return count;
+}
+
+int emcTaskPlanRestoreCheckpoint(int line)
+{
+    std::map<int, std::string>::iterator it = checkpoints.lower_bound(line);
+
+    if (it == checkpoints.begin())
+	return 0;
+    --it;
+    // refused if the program was started in another state than the
+    // checkpoint's run was, or has been read from already
+    int retval = interp.restore_checkpoint(it->second.c_str());
+
+    if (emc_debug & EMC_DEBUG_INTERP) {
+        rcs_print("emcTaskPlanRestoreCheckpoint(%d) restoring line %d returned %d\n",
+		  line, it->first, retval);
+    }
+
+    if (retval != INTERP_OK)
+	return 0;
+    checkpointLine = it->first;
+    return it->first;
+}
+
 int emcTaskPlanCommand(char *cmd)
 {
     char buf[LINELEN];
@@ -82,6 +82,7 @@ fpu_control_t __fpu_control = _FPU_IEEE & ~(_FPU_MASK_IM | _FPU_MASK_ZM | _FPU_M
 #include "taskclass.hh"
 #include "motion.h"             // EMCMOT_ORIENT_*
 #include "inihal.hh"
+#include "prescan.hh"		// emcTaskPrescanStart etc
 
 /* time after which the user interface is declared dead
  * because it would'nt read any more messages
@@ -446,6 +447,12 @@ static NML_INTERP_LIST mdi_input_queue;
 #define  MAX_MDI_QUEUE 10
 static int max_mdi_queued_commands = MAX_MDI_QUEUE;
 
+// pre-scan programs when they are opened, [TASK]PRESCAN
+static int emc_task_prescan = 0;
+
+// lines between checkpoints for run from line, [TASK]CHECKPOINT_INTERVAL
+static int emc_task_checkpoint_interval = 0;
+
 /*
   checkInterpList(NML_INTERP_LIST *il, EMC_STAT *stat) takes a pointer
   to an interpreter list and a pointer to the EMC status, pops each NML
@@ -623,6 +630,8 @@ interpret_again:
 			    } else {
 
 				// executed a good line
+				if (emc_task_checkpoint_interval > 0)
+				    emcTaskPlanCheckpoint(emc_task_checkpoint_interval);
 			    }
 
 			    // throw the results away if we're supposed to
@@ -974,6 +983,7 @@ static int emcTaskPlan(void)
 	    case EMC_MOTION_SET_AOUT_TYPE:
 	    case EMC_MOTION_ADAPTIVE_TYPE:
 	    case EMC_TRAJ_RIGID_TAP_TYPE:
+	    case EMC_TRAJ_AUX_ABORT_TYPE:
 	    case EMC_TRAJ_SET_TELEOP_ENABLE_TYPE:
 	    case EMC_TRAJ_SET_TELEOP_VECTOR_TYPE:
 	    case EMC_SET_DEBUG_TYPE:
@@ -1077,6 +1087,8 @@ static int emcTaskPlan(void)
 		case EMC_TRAJ_PROBE_TYPE:
 		case EMC_AUX_INPUT_WAIT_TYPE:
 		case EMC_TRAJ_RIGID_TAP_TYPE:
+		case EMC_TRAJ_AUX_LINEAR_MOVE_TYPE:
+		case EMC_TRAJ_AUX_ABORT_TYPE:
 		case EMC_SET_DEBUG_TYPE:
 		    retval = emcTaskIssueCommand(emcCommand);
 		    break;
@@ -1158,6 +1170,8 @@ static int emcTaskPlan(void)
 		case EMC_TRAJ_PROBE_TYPE:
 		case EMC_AUX_INPUT_WAIT_TYPE:
 		case EMC_TRAJ_RIGID_TAP_TYPE:
+		case EMC_TRAJ_AUX_LINEAR_MOVE_TYPE:
+		case EMC_TRAJ_AUX_ABORT_TYPE:
 		case EMC_SET_DEBUG_TYPE:
                 case EMC_COOLANT_MIST_ON_TYPE:
                 case EMC_COOLANT_MIST_OFF_TYPE:
@@ -1242,6 +1256,8 @@ static int emcTaskPlan(void)
 		case EMC_TRAJ_PROBE_TYPE:
 		case EMC_AUX_INPUT_WAIT_TYPE:
 		case EMC_TRAJ_RIGID_TAP_TYPE:
+		case EMC_TRAJ_AUX_LINEAR_MOVE_TYPE:
+		case EMC_TRAJ_AUX_ABORT_TYPE:
 		case EMC_SET_DEBUG_TYPE:
 		    retval = emcTaskIssueCommand(emcCommand);
 		    break;
@@ -1313,6 +1329,8 @@ static int emcTaskPlan(void)
 		case EMC_TRAJ_PROBE_TYPE:
 		case EMC_AUX_INPUT_WAIT_TYPE:
 	        case EMC_TRAJ_RIGID_TAP_TYPE:
+	        case EMC_TRAJ_AUX_LINEAR_MOVE_TYPE:
+	        case EMC_TRAJ_AUX_ABORT_TYPE:
 		case EMC_SET_DEBUG_TYPE:
                 case EMC_COOLANT_MIST_ON_TYPE:
                 case EMC_COOLANT_MIST_OFF_TYPE:
@@ -1407,6 +1425,8 @@ static int emcTaskPlan(void)
 	    case EMC_MOTION_SET_AOUT_TYPE:
 	    case EMC_MOTION_ADAPTIVE_TYPE:
 	    case EMC_TRAJ_RIGID_TAP_TYPE:
+	    case EMC_TRAJ_AUX_LINEAR_MOVE_TYPE:
+	    case EMC_TRAJ_AUX_ABORT_TYPE:
 	    case EMC_SET_DEBUG_TYPE:
 		retval = emcTaskIssueCommand(emcCommand);
 		break;
@@ -1718,7 +1738,10 @@ static int emcTaskIssueCommand(NMLmsg * cmd)
 					set_homing_params_msg->is_shared,
 					set_homing_params_msg->home_sequence,
 					set_homing_params_msg->volatile_home,
-                                        set_homing_params_msg->locking_indexer);
+                                        set_homing_params_msg->locking_indexer,
+					set_homing_params_msg->home_group,
+					set_homing_params_msg->search_jerk,
+					set_homing_params_msg->index_direct);
 	break;
 
     case EMC_AXIS_SET_FERROR_TYPE:
@@ -1813,7 +1836,8 @@ static int emcTaskIssueCommand(NMLmsg * cmd)
         retval = emcTrajLinearMove(emcTrajLinearMoveMsg->end,
                                    emcTrajLinearMoveMsg->type, emcTrajLinearMoveMsg->vel,
                                    emcTrajLinearMoveMsg->ini_maxvel, emcTrajLinearMoveMsg->acc,
-                                   emcTrajLinearMoveMsg->indexrotary);
+                                   emcTrajLinearMoveMsg->indexrotary,
+                                   emcTrajLinearMoveMsg->planned_vel);
 	break;
 
     case EMC_TRAJ_CIRCULAR_MOVE_TYPE:
@@ -1824,7 +1848,8 @@ static int emcTaskIssueCommand(NMLmsg * cmd)
                 emcTrajCircularMoveMsg->turn, emcTrajCircularMoveMsg->type,
                 emcTrajCircularMoveMsg->vel,
                 emcTrajCircularMoveMsg->ini_maxvel,
-                emcTrajCircularMoveMsg->acc);
+                emcTrajCircularMoveMsg->acc,
+                emcTrajCircularMoveMsg->planned_vel);
 	break;
 
     case EMC_TRAJ_PAUSE_TYPE:
@@ -1841,6 +1866,19 @@ static int emcTaskIssueCommand(NMLmsg * cmd)
 	retval = emcTrajAbort();
 	break;
 
+    case EMC_TRAJ_AUX_LINEAR_MOVE_TYPE:
+	{
+	    EMC_TRAJ_AUX_LINEAR_MOVE *auxMove = (EMC_TRAJ_AUX_LINEAR_MOVE *) cmd;
+	    retval = emcTrajAuxLinearMove(auxMove->planner, auxMove->id,
+					  auxMove->end, auxMove->vel,
+					  auxMove->ini_maxvel, auxMove->acc);
+	}
+	break;
+
+    case EMC_TRAJ_AUX_ABORT_TYPE:
+	retval = emcTrajAuxAbort(((EMC_TRAJ_AUX_ABORT *) cmd)->planner);
+	break;
+
     case EMC_TRAJ_DELAY_TYPE:
 	emcTrajDelayMsg = (EMC_TRAJ_DELAY *) cmd;
 	// set the timeout clock to expire at 'now' + delay time
@@ -2157,6 +2195,9 @@ static int emcTaskIssueCommand(NMLmsg * cmd)
 	    emcOperatorError(0, _("can't open %s"), open_msg->file);
 	} else {
 	    strcpy(emcStatus->task.file, open_msg->file);
+	    if (emc_task_prescan)
+		emcTaskPrescanStart(open_msg->file,
+				    emc_task_checkpoint_interval);
 	    retval = 0;
 	}
 	break;
@@ -2264,6 +2305,28 @@ static int emcTaskIssueCommand(NMLmsg * cmd)
 	}
 	run_msg = (EMC_TASK_PLAN_RUN *) cmd;
 	programStartLine = run_msg->line;
+	if (programStartLine > 1 && emc_task_checkpoint_interval > 0) {
+	    // continue from the last checkpoint before the start line
+	    // instead of reading all the lines up to it
+	    int restored = emcTaskPlanRestoreCheckpoint(programStartLine);
+	    if (restored > 0) {
+		// what restoring queued goes the way of skipped lines
+		interp_list.clear();
+		CANON_UPDATE_END_POINT(emcStatus->motion.traj.actualPosition.tran.x,
+				       emcStatus->motion.traj.actualPosition.tran.y,
+				       emcStatus->motion.traj.actualPosition.tran.z,
+				       emcStatus->motion.traj.actualPosition.a,
+				       emcStatus->motion.traj.actualPosition.b,
+				       emcStatus->motion.traj.actualPosition.c,
+				       emcStatus->motion.traj.actualPosition.u,
+				       emcStatus->motion.traj.actualPosition.v,
+				       emcStatus->motion.traj.actualPosition.w);
+		if (restored + 1 == programStartLine) {
+		    emcTaskPlanSynch();
+		    programStartLine = 0;
+		}
+	    }
+	}
 	emcStatus->task.interpState = EMC_TASK_INTERP_READING;
 	emcStatus->task.task_paused = 0;
 	retval = 0;
@@ -3040,6 +3103,7 @@ static int emctask_shutdown(void)
 {
     // shut down the subsystems
     if (0 != emcStatus) {
+	emcTaskPrescanExit();
 	emcTaskHalt();
 	emcTaskPlanExit();
 	emcMotionHalt();
@@ -3204,6 +3268,16 @@ static int iniLoad(const char *filename)
 	max_mdi_queued_commands = atoi(inistring);
     }
 
+    // run opened programs through a second interpreter in the background
+    if (NULL != (inistring = inifile.Find("PRESCAN", "TASK"))) {
+	emc_task_prescan = atoi(inistring);
+    }
+
+    // interpreter checkpoints to run from line with, off by default
+    if (NULL != (inistring = inifile.Find("CHECKPOINT_INTERVAL", "TASK"))) {
+	emc_task_checkpoint_interval = atoi(inistring);
+    }
+
     // close it
     inifile.Close();
 
@@ -3327,6 +3401,8 @@ int main(int argc, char *argv[])
 
     while (!done) {
         check_ini_hal_items();
+	if (emc_task_prescan)
+	    emcTaskPrescanPoll();
 	// read command
 	if (0 != emcCommandBuffer->peek()) {
 	    // got a new command, so clear out errors
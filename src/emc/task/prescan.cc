@@ -0,0 +1,519 @@
+/********************************************************************
+* Description: prescan.cc
+*   Background pre-scan of the program task has opened.
+*
+*   The canon layer and the interpreter list are globals of the task
+*   process, so a second interpreter cannot run in a thread next to the
+*   live one. The worker is a fork of task instead: it gets a copy of
+*   the interpreter in the state the program will start from, and the
+*   interpreter list it fills is its own, which makes it the recording
+*   canon. The worker reads the list back after every block, writes the
+*   summary to a file and exits; task picks it up in
+*   emcTaskPrescanPoll(). It runs at SCHED_IDLE and off the CPU task
+*   runs on, so it only gets what task leaves unused.
+*
+*   The summary file has a header of "key values" records:
+*
+*     file <program>
+*     error <line> <message>		only if there was one
+*     time <estimated seconds>
+*     min <x> <y> <z> <a> <b> <c> <u> <v> <w>
+*     max <x> <y> <z> <a> <b> <c> <u> <v> <w>
+*     feed <lowest> <highest>		feed moves, units per second
+*     tool <line> <tool number>	one per tool prepared
+*
+*   followed by one "line <number> <byte offset> <estimated seconds>"
+*   record for every line of the program. The estimate is distance
+*   over velocity and leaves acceleration out.
+*
+*   With a checkpoint interval, the worker also writes a checkpoint of
+*   the interpreter state every that many lines of the top level to
+*   a checkpoints file next to the summary, which emcTaskPrescanPoll()
+*   hands to emcTaskPlanLoadCheckpoints() and removes. Run from line can
+*   then start from one before any part of the program has run.
+*
+*   Both files live in a directory of task's own made with mkdtemp()
+*   and are created with O_EXCL, so nobody else can put a symlink where
+*   they are written. The summary stays for the UI to read until the
+*   next program is opened; emcTaskPrescanExit() removes it all.
+*
+*   Remaps and o-word subs run in the worker as they would in the
+*   program, Python code included, which is why [TASK]PRESCAN is off
+*   by default. Reading a _hal[] parameter is an error in the worker
+*   (see Interp::forked()), the scan stops at that line.
+*
+* Author:
+* License: GPL Version 2
+* System: Linux
+*
+* Copyright (c) 2026 All rights reserved.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+********************************************************************/
+
+#include <Python.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <libintl.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "rcs.hh"
+#include "emc.hh"
+#include "emc_nml.hh"
+#include "emcglb.h"
+#include "interpl.hh"
+#include "canon.hh"
+#include "rs274ngc_interp.hh"
+#include "interp_return.hh"
+#include "motion_types.h"
+#include "posemath.h"
+#include "rcs_print.hh"
+#include "task.hh"		// emcTaskPlanLoadCheckpoints()
+#include "prescan.hh"
+
+#define _(s) gettext(s)
+
+extern InterpBase *pinterp;
+#define interp (*pinterp)
+
+// points an arc is sampled at for the extents
+#define PRESCAN_ARC_POINTS 16
+
+static pid_t prescanPid = 0;
+static char prescanDir[LINELEN];
+static char prescanPath[LINELEN + 16];
+static char prescanCheckpoints[LINELEN + 16];
+static int prescanCheckpointInterval = 0;
+
+struct prescan_summary {
+    int error_line;
+    char error[LINELEN];
+    bool moved;
+    EmcPose pos, min, max;
+    double feed_min, feed_max;
+    double time;
+    std::vector<std::pair<int, int> > tools;	// line, tool
+    std::map<int, double> line_time;
+};
+
+static void extend(prescan_summary &s, const EmcPose &p)
+{
+    if (!s.moved) {
+	s.min = s.max = p;
+	s.moved = true;
+	return;
+    }
+#define EXTEND(f) \
+    if (p.f < s.min.f) s.min.f = p.f; \
+    if (p.f > s.max.f) s.max.f = p.f;
+    EXTEND(tran.x) EXTEND(tran.y) EXTEND(tran.z)
+    EXTEND(a) EXTEND(b) EXTEND(c)
+    EXTEND(u) EXTEND(v) EXTEND(w)
+#undef EXTEND
+}
+
+// the length motion plans the move by: xyz, or else uvw, or else abc
+static double move_length(const EmcPose &from, const EmcPose &to)
+{
+    double d;
+
+    d = sqrt(pmSq(to.tran.x - from.tran.x) + pmSq(to.tran.y - from.tran.y) +
+	     pmSq(to.tran.z - from.tran.z));
+    if (d < CART_FUZZ)
+	d = sqrt(pmSq(to.u - from.u) + pmSq(to.v - from.v) +
+		 pmSq(to.w - from.w));
+    if (d < CART_FUZZ)
+	d = sqrt(pmSq(to.a - from.a) + pmSq(to.b - from.b) +
+		 pmSq(to.c - from.c));
+    return d;
+}
+
+static void add_time(prescan_summary &s, int line, double length, double vel)
+{
+    double t;
+
+    if (vel <= 0.0)
+	return;
+    t = length / vel;
+    s.time += t;
+    s.line_time[line] += t;
+}
+
+static void add_feed(prescan_summary &s, double vel)
+{
+    if (s.feed_max == 0.0 || vel < s.feed_min)
+	s.feed_min = vel;
+    if (vel > s.feed_max)
+	s.feed_max = vel;
+}
+
+static double arc_length(prescan_summary &s, const EMC_TRAJ_CIRCULAR_MOVE *m)
+{
+    PmCircle circle;
+    PmCartesian start, end, center, normal, point;
+
+    start = s.pos.tran;
+    end = m->end.tran;
+    center.x = m->center.x; center.y = m->center.y; center.z = m->center.z;
+    normal.x = m->normal.x; normal.y = m->normal.y; normal.z = m->normal.z;
+    if (pmCircleInit(&circle, &start, &end, &center, &normal, m->turn) != 0)
+	return move_length(s.pos, m->end);
+
+    for (int i = 1; i < PRESCAN_ARC_POINTS; i++) {
+	EmcPose p = m->end;
+	pmCirclePoint(&circle, circle.angle * i / PRESCAN_ARC_POINTS, &point);
+	p.tran = point;
+	extend(s, p);
+    }
+    return sqrt(pmSq(circle.angle * circle.radius) +
+		pmSq(pmSqrt(pmSq(circle.rHelix.x) + pmSq(circle.rHelix.y) +
+			    pmSq(circle.rHelix.z))));
+}
+
+/* Read back what the interpreter queued. */
+static void drain(prescan_summary &s)
+{
+    NMLmsg *msg;
+    int line;
+
+    while ((msg = interp_list.get()) != NULL) {
+	line = interp_list.get_line_number();
+	switch (msg->type) {
+	case EMC_TRAJ_LINEAR_MOVE_TYPE: {
+	    EMC_TRAJ_LINEAR_MOVE *m = (EMC_TRAJ_LINEAR_MOVE *) msg;
+	    if (m->type != EMC_MOTION_TYPE_TRAVERSE)
+		add_feed(s, m->vel);
+	    add_time(s, line, move_length(s.pos, m->end), m->vel);
+	    s.pos = m->end;
+	    extend(s, s.pos);
+	    break;
+	}
+	case EMC_TRAJ_CIRCULAR_MOVE_TYPE: {
+	    EMC_TRAJ_CIRCULAR_MOVE *m = (EMC_TRAJ_CIRCULAR_MOVE *) msg;
+	    add_feed(s, m->vel);
+	    add_time(s, line, arc_length(s, m), m->vel);
+	    s.pos = m->end;
+	    extend(s, s.pos);
+	    break;
+	}
+	case EMC_TRAJ_PROBE_TYPE: {
+	    EMC_TRAJ_PROBE *m = (EMC_TRAJ_PROBE *) msg;
+	    add_time(s, line, move_length(s.pos, m->pos), m->vel);
+	    extend(s, m->pos);
+	    break;
+	}
+	case EMC_TRAJ_RIGID_TAP_TYPE: {
+	    EMC_TRAJ_RIGID_TAP *m = (EMC_TRAJ_RIGID_TAP *) msg;
+	    // down and back up
+	    add_time(s, line, 2.0 * move_length(s.pos, m->pos), m->vel);
+	    extend(s, m->pos);
+	    break;
+	}
+	case EMC_TRAJ_DELAY_TYPE:
+	    s.time += ((EMC_TRAJ_DELAY *) msg)->delay;
+	    s.line_time[line] += ((EMC_TRAJ_DELAY *) msg)->delay;
+	    break;
+	case EMC_TOOL_PREPARE_TYPE:
+	    s.tools.push_back(std::make_pair(line,
+					     ((EMC_TOOL_PREPARE *) msg)->tool));
+	    break;
+	case EMC_OPERATOR_ERROR_TYPE:
+	    if (s.error_line == 0) {
+		s.error_line = line;
+		snprintf(s.error, sizeof(s.error), "%s",
+			 ((EMC_OPERATOR_ERROR *) msg)->error);
+	    }
+	    break;
+	}
+    }
+}
+
+static void interp_error(prescan_summary &s, int retval)
+{
+    s.error_line = interp.sequence_number();
+    s.error[0] = 0;
+    interp.error_text(retval, s.error, LINELEN);
+    if (s.error_line <= 0)
+	s.error_line = 1;
+}
+
+static int write_summary(prescan_summary &s, const char *file, const char *path)
+{
+    char tmp[LINELEN + 32], text[LINELEN];
+    FILE *in, *out;
+    long offset;
+    int line, fd;
+
+    snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+    if ((fd = mkstemp(tmp)) < 0)
+	return -1;
+    if ((out = fdopen(fd, "w")) == NULL) {
+	close(fd);
+	unlink(tmp);
+	return -1;
+    }
+    fprintf(out, "file %s\n", file);
+    if (s.error_line)
+	fprintf(out, "error %d %s\n", s.error_line, s.error);
+    fprintf(out, "time %.3f\n", s.time);
+    fprintf(out, "min %g %g %g %g %g %g %g %g %g\n",
+	    s.min.tran.x, s.min.tran.y, s.min.tran.z,
+	    s.min.a, s.min.b, s.min.c, s.min.u, s.min.v, s.min.w);
+    fprintf(out, "max %g %g %g %g %g %g %g %g %g\n",
+	    s.max.tran.x, s.max.tran.y, s.max.tran.z,
+	    s.max.a, s.max.b, s.max.c, s.max.u, s.max.v, s.max.w);
+    fprintf(out, "feed %g %g\n", s.feed_min, s.feed_max);
+    for (size_t i = 0; i < s.tools.size(); i++)
+	fprintf(out, "tool %d %d\n", s.tools[i].first, s.tools[i].second);
+
+    // the line to byte map, lines as the interpreter counts them
+    if ((in = fopen(file, "r")) != NULL) {
+	for (line = 1, offset = 0; fgets(text, sizeof(text), in); ) {
+	    size_t n = strlen(text);
+	    if (n && text[n - 1] != '\n' && !feof(in)) {
+		offset += n;	// the rest of an overlong line follows
+		continue;
+	    }
+	    std::map<int, double>::iterator it = s.line_time.find(line);
+	    fprintf(out, "line %d %ld %.4f\n", line, offset,
+		    it == s.line_time.end() ? 0.0 : it->second);
+	    offset += n;
+	    line++;
+	}
+	fclose(in);
+    }
+    if (fclose(out) != 0 || rename(tmp, path) != 0) {
+	unlink(tmp);
+	return -1;
+    }
+    return 0;
+}
+
+/* The worker. Nothing here may reach the NML channels, HAL or the exit
+   handlers of task, hence _exit(). */
+static void prescan(const char *file, const char *path, int task_cpu,
+		    int checkpoint_interval)
+{
+    prescan_summary s;
+    struct sched_param param;
+    cpu_set_t cpus;
+    std::string state;
+    FILE *checkpoints = NULL;
+    int retval, checkpoint_line = 0;
+
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    memset(&param, 0, sizeof(param));
+    sched_setscheduler(0, SCHED_IDLE, &param);
+    if (task_cpu >= 0 && sched_getaffinity(0, sizeof(cpus), &cpus) == 0 &&
+	CPU_ISSET(task_cpu, &cpus) && CPU_COUNT(&cpus) > 1) {
+	CPU_CLR(task_cpu, &cpus);
+	sched_setaffinity(0, sizeof(cpus), &cpus);
+    }
+    if (Py_IsInitialized())
+	PyOS_AfterFork();
+
+    s.error_line = 0;
+    s.error[0] = 0;
+    s.moved = false;
+    s.feed_min = s.feed_max = 0.0;
+    s.time = 0.0;
+    s.pos = emcStatus->motion.traj.position;
+    s.min = s.max = s.pos;
+
+    interp_list.clear();
+    // a file of its own to read; the open one shares its read position
+    // with task's, so it is dropped without touching it
+    interp.forked();
+    if ((retval = interp.open(file)) > INTERP_MIN_ERROR) {
+	interp_error(s, retval);
+	write_summary(s, file, path);
+	_exit(1);
+    }
+    if (checkpoint_interval > 0) {
+	int fd = open(prescanCheckpoints, O_WRONLY | O_CREAT | O_EXCL, 0600);
+	if (fd >= 0 && (checkpoints = fdopen(fd, "w")) == NULL)
+	    close(fd);
+    }
+    for (;;) {
+	retval = interp.read();
+	if (retval == INTERP_ENDFILE)
+	    break;
+	if (retval > INTERP_MIN_ERROR) {
+	    interp_error(s, retval);
+	    break;
+	}
+	retval = interp.execute();
+	if (retval > INTERP_MIN_ERROR) {
+	    interp_error(s, retval);
+	    break;
+	}
+	// nothing to wait for here, take the queue buster's state as is
+	if (retval == INTERP_EXECUTE_FINISH)
+	    interp.synch();
+	else if (checkpoints && retval == INTERP_OK &&
+		 interp.line() >= checkpoint_line + checkpoint_interval &&
+		 interp.save_checkpoint(state) == INTERP_OK) {
+	    fputs(state.c_str(), checkpoints);
+	    checkpoint_line = interp.line();
+	}
+	drain(s);
+	if (retval == INTERP_EXIT || s.error_line)
+	    break;
+    }
+    FINISH();
+    drain(s);
+    if (checkpoints && fclose(checkpoints) != 0)
+	unlink(prescanCheckpoints);
+    if (write_summary(s, file, path) != 0)
+	_exit(2);
+    _exit(s.error_line ? 1 : 0);
+}
+
+int emcTaskPrescanStart(const char *file, int checkpoint_interval)
+{
+    int cpu;
+
+    emcTaskPrescanAbort();
+    if (prescanDir[0] == 0) {
+	snprintf(prescanDir, sizeof(prescanDir), "%s/linuxcnc-prescan-XXXXXX",
+		 P_tmpdir);
+	if (mkdtemp(prescanDir) == NULL) {
+	    rcs_print_error("emcTaskPrescanStart: can't make %s: %s\n",
+			    prescanDir, strerror(errno));
+	    prescanDir[0] = 0;
+	    return -1;
+	}
+	snprintf(prescanPath, sizeof(prescanPath), "%s/summary", prescanDir);
+	snprintf(prescanCheckpoints, sizeof(prescanCheckpoints),
+		 "%s/checkpoints", prescanDir);
+    }
+    prescanCheckpointInterval = checkpoint_interval;
+    cpu = sched_getcpu();
+
+    // or the worker flushes what task has buffered a second time
+    fflush(stdout);
+    fflush(stderr);
+    prescanPid = fork();
+    if (prescanPid == -1) {
+	prescanPid = 0;
+	rcs_print_error("emcTaskPrescanStart: can't start the pre-scan of %s\n",
+			file);
+	return -1;
+    }
+    if (prescanPid == 0)
+	prescan(file, prescanPath, cpu, checkpoint_interval);
+
+    emcStatus->task.prescanState = EMC_TASK_PRESCAN_RUNNING;
+    emcStatus->task.prescanErrorLine = 0;
+    emcStatus->task.prescanTime = 0.0;
+    ZERO_EMC_POSE(emcStatus->task.prescanMin);
+    ZERO_EMC_POSE(emcStatus->task.prescanMax);
+    emcStatus->task.prescanFile[0] = 0;
+    return 0;
+}
+
+static int read_pose(const char *text, EmcPose *p)
+{
+    return sscanf(text, "%lf %lf %lf %lf %lf %lf %lf %lf %lf",
+		  &p->tran.x, &p->tran.y, &p->tran.z,
+		  &p->a, &p->b, &p->c, &p->u, &p->v, &p->w) == 9 ? 0 : -1;
+}
+
+void emcTaskPrescanPoll(void)
+{
+    EMC_TASK_STAT *task = &emcStatus->task;
+    char text[LINELEN + 32], error[LINELEN];
+    int status, line;
+    pid_t pid;
+    FILE *in;
+
+    if (prescanPid == 0)
+	return;
+    pid = waitpid(prescanPid, &status, WNOHANG);
+    if (pid == 0)
+	return;
+    prescanPid = 0;
+    // those taken before an error are good for the lines before it
+    if (prescanCheckpointInterval > 0) {
+	emcTaskPlanLoadCheckpoints(prescanCheckpoints);
+	unlink(prescanCheckpoints);
+    }
+    if (pid == -1 || !WIFEXITED(status) || WEXITSTATUS(status) > 1 ||
+	(in = fopen(prescanPath, "r")) == NULL) {
+	rcs_print_error("emcTaskPrescanPoll: the pre-scan failed\n");
+	task->prescanState = EMC_TASK_PRESCAN_NONE;
+	return;
+    }
+
+    error[0] = 0;
+    line = 0;
+    // the header is all that goes into the status
+    while (fgets(text, sizeof(text), in) && strncmp(text, "line ", 5)) {
+	text[strcspn(text, "\n")] = 0;
+	if (!strncmp(text, "error ", 6))
+	    sscanf(text + 6, "%d %[^\n]", &line, error);
+	else if (!strncmp(text, "time ", 5))
+	    sscanf(text + 5, "%lf", &task->prescanTime);
+	else if (!strncmp(text, "min ", 4))
+	    read_pose(text + 4, &task->prescanMin);
+	else if (!strncmp(text, "max ", 4))
+	    read_pose(text + 4, &task->prescanMax);
+    }
+    fclose(in);
+    strcpy(task->prescanFile, prescanPath);
+    task->prescanErrorLine = line;
+    if (line) {
+	task->prescanState = EMC_TASK_PRESCAN_ERROR;
+	emcOperatorError(0, _("pre-scan: line %d: %s"), line, error);
+    } else {
+	task->prescanState = EMC_TASK_PRESCAN_DONE;
+    }
+}
+
+void emcTaskPrescanAbort(void)
+{
+    if (prescanPid != 0) {
+	kill(prescanPid, SIGKILL);
+	waitpid(prescanPid, NULL, 0);
+	prescanPid = 0;
+    }
+    if (prescanDir[0] == 0)
+	return;
+    unlink(prescanCheckpoints);
+    unlink(prescanPath);
+    emcStatus->task.prescanState = EMC_TASK_PRESCAN_NONE;
+    emcStatus->task.prescanFile[0] = 0;
+}
+
+void emcTaskPrescanExit(void)
+{
+    emcTaskPrescanAbort();
+    if (prescanDir[0] == 0)
+	return;
+    rmdir(prescanDir);
+    prescanDir[0] = 0;
+}
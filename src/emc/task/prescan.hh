@@ -0,0 +1,51 @@
+/********************************************************************
+* Description: prescan.hh
+*   Background pre-scan of the program task has opened.
+*
+*   A worker process runs the interpreter over the whole program as
+*   soon as it is opened, so errors, extents, tool changes and an
+*   estimate of the run time are known before cycle start, not when
+*   the live interpreter's readahead gets to them.
+*
+* Author:
+* License: GPL Version 2
+* System: Linux
+*
+* Copyright (c) 2026 All rights reserved.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+********************************************************************/
+#ifndef PRESCAN_HH
+#define PRESCAN_HH
+
+/* Start pre-scanning file, dropping a pre-scan still running. The
+   interpreter must have opened file. With checkpoint_interval > 0 the
+   worker takes a checkpoint for run from line every that many lines.
+   Returns 0, or -1 if no worker could be started. */
+extern int emcTaskPrescanStart(const char *file, int checkpoint_interval);
+
+/* Called every task cycle: once the worker is done, its summary is
+   published in emcStatus->task, an error it found is reported and the
+   checkpoints it took are loaded. */
+extern void emcTaskPrescanPoll(void);
+
+/* Stop a running worker and remove what it wrote. */
+extern void emcTaskPrescanAbort(void);
+
+/* emcTaskPrescanAbort() and remove the directory of the pre-scan files,
+   at shutdown. */
+extern void emcTaskPrescanExit(void);
+
+#endif				/* PRESCAN_HH */
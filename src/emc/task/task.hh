@@ -52,6 +52,16 @@ int emcTaskPlanLine();
 int emcTaskPlanLevel();
 int emcTaskPlanCommand(char *cmd);
 
+/* Run from line: checkpoints of the interpreter state are taken every
+   interval lines of the top level while a program runs, or loaded from
+   a file of them the pre-scan wrote. Restoring the last one before line
+   skips reading the lines up to it; it returns the checkpoint's line,
+   or 0 if there is none that fits the program and the state it starts
+   in. */
+int emcTaskPlanCheckpoint(int interval);
+int emcTaskPlanLoadCheckpoints(const char *path);
+int emcTaskPlanRestoreCheckpoint(int line);
+
 int emcTaskUpdate(EMC_TASK_STAT * stat);
 
 #endif
@@ -237,11 +237,13 @@ int emcAxisSetMinFerror(int axis, double ferror)
 int emcAxisSetHomingParams(int axis, double home, double offset, double home_final_vel,
 			   double search_vel, double latch_vel,
 			   int use_index, int ignore_limits, int is_shared,
-			   int sequence,int volatile_home, int locking_indexer)
+			   int sequence,int volatile_home, int locking_indexer,
+			   int home_group, double search_jerk, int index_direct)
 {
 #ifdef ISNAN_TRAP
     if (rtapi_isnan(home) || rtapi_isnan(offset) || rtapi_isnan(home_final_vel) ||
-	rtapi_isnan(search_vel) || rtapi_isnan(latch_vel)) {
+	rtapi_isnan(search_vel) || rtapi_isnan(latch_vel) ||
+	rtapi_isnan(search_jerk)) {
 	printf("isnan error in emcAxisSetHoming()\n");
 	return -1;
     }
@@ -260,6 +262,8 @@ int emcAxisSetHomingParams(int axis, double home, double offset, double home_fin
     emcmotCommand.latch_vel = latch_vel;
     emcmotCommand.flags = 0;
     emcmotCommand.home_sequence = sequence;
+    emcmotCommand.home_group = home_group;
+    emcmotCommand.search_jerk = search_jerk < 0.0 ? 0.0 : search_jerk;
     emcmotCommand.volatile_home = volatile_home;
     if (use_index) {
 	emcmotCommand.flags |= HOME_USE_INDEX;
@@ -273,6 +277,9 @@ int emcAxisSetHomingParams(int axis, double home, double offset, double home_fin
     if (locking_indexer) {
         emcmotCommand.flags |= HOME_UNLOCK_FIRST;
     }
+    if (index_direct) {
+	emcmotCommand.flags |= HOME_INDEX_DIRECT;
+    }
 
     return usrmotWriteEmcmotCommand(&emcmotCommand);
 }
@@ -532,6 +539,11 @@ int emcAxisLoadComp(int axis, const char *file, int type)
     return usrmotLoadComp(axis, file, type);
 }
 
+int emcTrajLoadVolComp(const char *file)
+{
+    return usrmotLoadVolComp(file);
+}
+
 static emcmot_config_t emcmotConfig;
 int get_emcmot_debug_info = 0;
 
@@ -994,7 +1006,7 @@ int emcTrajSetTermCond(int cond, double tolerance)
 }
 
 int emcTrajLinearMove(EmcPose end, int type, double vel, double ini_maxvel, double acc,
-                      int indexrotary)
+                      int indexrotary, double planned_vel)
 {
 #ifdef ISNAN_TRAP
     if (rtapi_isnan(end.tran.x) || rtapi_isnan(end.tran.y) || rtapi_isnan(end.tran.z) ||
@@ -1016,12 +1028,14 @@ int emcTrajLinearMove(EmcPose end, int type, double vel, double ini_maxvel, doub
     emcmotCommand.ini_maxvel = ini_maxvel;
     emcmotCommand.acc = acc;
     emcmotCommand.turn = indexrotary;
+    emcmotCommand.planned_vel = planned_vel;
 
     return usrmotWriteEmcmotCommand(&emcmotCommand);
 }
 
 int emcTrajCircularMove(EmcPose end, PM_CARTESIAN center,
-			PM_CARTESIAN normal, int turn, int type, double vel, double ini_maxvel, double acc)
+			PM_CARTESIAN normal, int turn, int type, double vel, double ini_maxvel, double acc,
+			double planned_vel)
 {
 #ifdef ISNAN_TRAP
     if (rtapi_isnan(end.tran.x) || rtapi_isnan(end.tran.y) || rtapi_isnan(end.tran.z) ||
@@ -1054,6 +1068,7 @@ int emcTrajCircularMove(EmcPose end, PM_CARTESIAN center,
     emcmotCommand.vel = vel;
     emcmotCommand.ini_maxvel = ini_maxvel;
     emcmotCommand.acc = acc;
+    emcmotCommand.planned_vel = planned_vel;
 
     return usrmotWriteEmcmotCommand(&emcmotCommand);
 }
@@ -1109,6 +1124,47 @@ int emcTrajRigidTap(EmcPose pos, double vel, double ini_maxvel, double acc)
     return usrmotWriteEmcmotCommand(&emcmotCommand);
 }
 
+int emcTrajSetAuxPlanner(int planner, int axis_mask)
+{
+    emcmotCommand.command = EMCMOT_SET_AUX_PLANNER;
+    emcmotCommand.planner = planner;
+    emcmotCommand.axis_mask = axis_mask;
+
+    return usrmotWriteEmcmotCommand(&emcmotCommand);
+}
+
+int emcTrajAuxLinearMove(int planner, int id, EmcPose end, double vel,
+			 double ini_maxvel, double acc)
+{
+#ifdef ISNAN_TRAP
+    if (rtapi_isnan(end.tran.x) || rtapi_isnan(end.tran.y) || rtapi_isnan(end.tran.z) ||
+        rtapi_isnan(end.a) || rtapi_isnan(end.b) || rtapi_isnan(end.c) ||
+        rtapi_isnan(end.u) || rtapi_isnan(end.v) || rtapi_isnan(end.w)) {
+	printf("isnan error in emcTrajAuxLinearMove()\n");
+	return 0;		// ignore it for now, just don't send it
+    }
+#endif
+
+    emcmotCommand.command = EMCMOT_AUX_LINE;
+    emcmotCommand.planner = planner;
+    emcmotCommand.id = id;
+    emcmotCommand.pos = end;
+    emcmotCommand.motion_type = EMC_MOTION_TYPE_FEED;
+    emcmotCommand.vel = vel;
+    emcmotCommand.ini_maxvel = ini_maxvel;
+    emcmotCommand.acc = acc;
+
+    return usrmotWriteEmcmotCommand(&emcmotCommand);
+}
+
+int emcTrajAuxAbort(int planner)
+{
+    emcmotCommand.command = EMCMOT_AUX_ABORT;
+    emcmotCommand.planner = planner;
+
+    return usrmotWriteEmcmotCommand(&emcmotCommand);
+}
+
 
 static int last_id = 0;
 static int last_id_printed = 0;
@@ -1217,6 +1273,12 @@ int emcTrajUpdate(EMC_TRAJ_STAT * stat)
     stat->adaptive_feed_enabled = enables & AF_ENABLED;
     stat->feed_hold_enabled = enables & FH_ENABLED;
 
+    stat->auxPlanners = emcmotStatus.num_aux_planners;
+    for (axis = 0; axis < emcmotStatus.num_aux_planners; axis++) {
+	stat->auxQueue[axis] = emcmotStatus.aux[axis].depth;
+	stat->auxId[axis] = emcmotStatus.aux[axis].id;
+    }
+
     if (new_config) {
 	stat->cycleTime = emcmotConfig.trajCycleTime;
 	stat->kinematics_type = emcmotConfig.kinematics_type;
@@ -1572,7 +1634,9 @@ int emcSetupArcBlends(int arcBlendEnable,
         int arcBlendOptDepth,
         int arcBlendGapCycles,
         double arcBlendRampFreq,
-        double arcBlendTangentKinkRatio) {
+        double arcBlendTangentKinkRatio,
+        int segmentMergeEnable,
+        int jointLimitSamples) {
 
     emcmotCommand.command = EMCMOT_SETUP_ARC_BLENDS;
     emcmotCommand.arcBlendEnable = arcBlendEnable;
@@ -1581,6 +1645,8 @@ int emcSetupArcBlends(int arcBlendEnable,
     emcmotCommand.arcBlendGapCycles = arcBlendGapCycles;
     emcmotCommand.arcBlendRampFreq = arcBlendRampFreq;
     emcmotCommand.arcBlendTangentKinkRatio = arcBlendTangentKinkRatio;
+    emcmotCommand.segmentMergeEnable = segmentMergeEnable;
+    emcmotCommand.jointLimitSamples = jointLimitSamples;
     return usrmotWriteEmcmotCommand(&emcmotCommand);
 }
 
@@ -254,8 +254,7 @@ static inline double findTrimAngle(PmCartesian const * const P,
 int checkTangentAngle(PmCircle const * const circ, SphericalArc const * const arc, BlendGeom3 const * const geom, BlendParameters const * const param, double cycle_time, int at_end)
 {
     // Debug Information to diagnose tangent issues
-    PmCartesian u_circ, u_arc;
-    arcTangent(arc, &u_arc, at_end);
+    PmCartesian u_circ;
 
     if (at_end) {
         pmCircleTangentVector(circ, 0, &u_circ);
@@ -263,11 +262,24 @@ int checkTangentAngle(PmCircle const * const circ, SphericalArc const * const ar
         pmCircleTangentVector(circ, circ->angle, &u_circ);
     }
 
+    return checkTangentVector(&u_circ, arc, param, cycle_time, at_end);
+}
+
+
+/**
+ * Verify that a blend arc is tangent to a segment with the given unit tangent
+ * vector where they meet.
+ */
+int checkTangentVector(PmCartesian const * const u_seg, SphericalArc const * const arc, BlendParameters const * const param, double cycle_time, int at_end)
+{
+    PmCartesian u_arc;
+    arcTangent(arc, &u_arc, at_end);
+
     pmCartUnitEq(&u_arc);
 
     // Find angle between tangent unit vectors
     double dot;
-    pmCartCartDot(&u_circ, &u_arc, &dot);
+    pmCartCartDot(u_seg, &u_arc, &dot);
     double blend_angle = rtapi_acos(saturate(dot,1.0));
 
     // Check against the maximum allowed tangent angle for the given velocity and acceleration
@@ -277,17 +289,17 @@ int checkTangentAngle(PmCircle const * const circ, SphericalArc const * const ar
             blend_angle,
             angle_max);
 
-    tp_debug_print("circ_tan = [%g %g %g]\n",
-            u_circ.x,
-            u_circ.y,
-            u_circ.z);
+    tp_debug_print("seg_tan = [%g %g %g]\n",
+            u_seg->x,
+            u_seg->y,
+            u_seg->z);
     tp_debug_print("arc_tan = [%g %g %g]\n",
             u_arc.x,
             u_arc.y,
             u_arc.z);
 
     PmCartesian diff;
-    pmCartCartSub(&u_arc,&u_circ,&diff);
+    pmCartCartSub(&u_arc,u_seg,&diff);
     tp_debug_print("diff = [%g %g %g]\n",
             diff.x,
             diff.y,
@@ -1056,6 +1068,100 @@ int blendInit3FromLineLine(BlendGeom3 * const geom, BlendParameters * const para
 }
 
 
+/**
+ * Find how much of a segment next to the intersection can be replaced by its
+ * tangent line. A curve of radius of curvature rho leaves its tangent line by
+ * about s^2 / (2 rho) after a distance s, so arcs and helices are limited to
+ * the length that keeps this within dev_max.
+ */
+static double blendTangentLength(TC_STRUCT const * const tc, double dev_max,
+        int at_end)
+{
+    if (tc->motion_type == TC_LINEAR) {
+        if (at_end) {
+            return rtapi_fmin(tc->target, tc->nominal_length * BLEND_DIST_FRACTION);
+        }
+        return tc->target * BLEND_DIST_FRACTION;
+    }
+
+    PmCircle const * const circ = &tc->coords.circle.xyz;
+    double r = pmCircleEffectiveMinRadius(circ);
+    double h;
+    pmCartMag(&circ->rHelix, &h);
+    double dh = h / circ->angle;
+    // Radius of curvature of a helix with radius r and rise dh per radian
+    double rho = (pmSq(r) + pmSq(dh)) / r;
+    double L_dev = pmSqrt(2.0 * rho * dev_max);
+
+    // Same split of the arc between neighbouring blends as the planar case
+    double L_max = at_end ? tc->target * 2.0 / 3.0 : tc->target / 3.0;
+    tp_debug_print("rho = %f, L_dev = %f, L_max = %f\n", rho, L_dev, L_max);
+    return rtapi_fmin(L_dev, L_max);
+}
+
+
+/**
+ * Setup blend parameters for a pair of segments that do not lie in one plane.
+ * This covers helices, and arcs whose plane does not contain the other
+ * segment, where no circular arc can be exactly tangent to both segments.
+ * Near the intersection each segment is replaced by its tangent line, and the
+ * blend length is limited so the real segment stays within a fraction of the
+ * blend tolerance of that line. The blend arc is then refitted to the real
+ * segments by blendTangentFit, and the remaining tangent error must pass
+ * checkTangentVector like any other arc blend.
+ *
+ * @param geom Stores simplified geometry used to calculate blend params.
+ * @param param Abstracted parameters for blending calculations
+ * @param prev_tc first move to blend (line or arc)
+ * @param tc second move to blend (line or arc)
+ * @param acc_bound maximum X, Y, Z machine acceleration
+ * @param vel_bound maximum X, Y, Z machine velocity
+ * @param maxFeedScale maximum allowed feed override (set in INI)
+ */
+int blendInit3FromTangents(BlendGeom3 * const geom, BlendParameters * const param,
+        TC_STRUCT const * const prev_tc,
+        TC_STRUCT const * const tc,
+        PmCartesian const * const acc_bound,
+        PmCartesian const * const vel_bound,
+        double maxFeedScale)
+{
+    if ((tc->motion_type != TC_LINEAR && tc->motion_type != TC_CIRCULAR) ||
+            (prev_tc->motion_type != TC_LINEAR && prev_tc->motion_type != TC_CIRCULAR)) {
+        return TP_ERR_INPUT_TYPE;
+    }
+
+    int res_init = blendGeom3Init(geom, prev_tc, tc);
+    if (res_init != TP_ERR_OK) {
+        return res_init;
+    }
+
+    param->theta = geom->theta_tan;
+    tp_debug_print("theta = %f\n", param->theta);
+    param->phi = (PM_PI - param->theta * 2.0);
+
+    blendGeom3Print(geom);
+
+    // Setup common parameters
+    int res_kin = blendParamKinematics(geom,
+            param,
+            prev_tc,
+            tc,
+            acc_bound,
+            vel_bound,
+            maxFeedScale);
+
+    // Part of the tolerance is kept for the segments leaving their tangents
+    double dev_max = param->tolerance * BLEND_TANGENT_DEV_RATIO;
+    param->tolerance -= dev_max;
+
+    param->L1 = blendTangentLength(prev_tc, dev_max, true);
+    param->L2 = blendTangentLength(tc, dev_max, false);
+    tp_debug_print("L1 = %f, L2 = %f\n", param->L1, param->L2);
+
+    return res_kin;
+}
+
+
 /**
  * Calculate plane normal and binormal based on unit direction vectors.
  */
@@ -1537,6 +1643,201 @@ int blendArcArcPostProcess(BlendPoints3 * const points, BlendPoints3 const * con
 }
 
 
+/**
+ * Trim a segment by a path length for a tangent fitted blend.
+ * The xyz geometry of tc is copied into cut and shortened by length d at its
+ * end (at_end) or start. The point where it was cut and the unit tangent
+ * there are stored in cut as well.
+ */
+int blendTangentTrim(TC_STRUCT const * const tc, double d, int at_end,
+        BlendCut3 * const cut)
+{
+    if (d <= 0.0 || d >= tc->target) {
+        return TP_ERR_FAIL;
+    }
+    cut->trim = d;
+
+    switch (tc->motion_type) {
+        case TC_LINEAR:
+            cut->line = tc->coords.line.xyz;
+            if (pmCartLineStretch(&cut->line, cut->line.tmag - d, !at_end)) {
+                return TP_ERR_FAIL;
+            }
+            pmCartLinePoint(&cut->line, at_end ? cut->line.tmag : 0.0, &cut->point);
+            cut->u_tan = cut->line.uVec;
+            return TP_ERR_OK;
+        case TC_CIRCULAR:
+            {
+                cut->circle = tc->coords.circle.xyz;
+                double angle_cut;
+                int res_angle = pmCircleAngleFromProgress(&cut->circle,
+                        &tc->coords.circle.fit,
+                        at_end ? tc->target - d : d,
+                        &angle_cut);
+                if (res_angle != TP_ERR_OK) {
+                    return TP_ERR_FAIL;
+                }
+                double new_angle = at_end ? angle_cut : cut->circle.angle - angle_cut;
+                if (pmCircleStretch(&cut->circle, new_angle, !at_end)) {
+                    return TP_ERR_FAIL;
+                }
+                double angle_end = at_end ? cut->circle.angle : 0.0;
+                pmCirclePoint(&cut->circle, angle_end, &cut->point);
+                pmCircleTangentVector(&cut->circle, angle_end, &cut->u_tan);
+                return TP_ERR_OK;
+            }
+        default:
+            return TP_ERR_INPUT_TYPE;
+    }
+}
+
+
+/**
+ * Chord condition for a circle tangent to both cut segments.
+ * A circular arc meets its chord at the same angle at both ends, so the chord
+ * has the same component along both end tangents. Returns the difference,
+ * which is positive when the second cut is too short.
+ */
+static double blendTangentChordError(BlendCut3 const * const cut1,
+        BlendCut3 const * const cut2)
+{
+    PmCartesian chord, du;
+    pmCartCartSub(&cut2->point, &cut1->point, &chord);
+    pmCartCartSub(&cut1->u_tan, &cut2->u_tan, &du);
+    double err;
+    pmCartCartDot(&chord, &du, &err);
+    return err;
+}
+
+
+/**
+ * Fit a blend arc to the tangents of the real segments.
+ * The first segment is cut at d_plan from the intersection, as computed from
+ * the tangent lines. The cut on the second segment is then found by bisection
+ * so that a circle can touch both cuts with matching tangents. For helices
+ * and other non-planar pairs the two tangents are slightly skew; the arc is
+ * placed in the plane of the tangents, halfway between the cut points. The
+ * radius, planned velocity and arc length in param, and the tangents and
+ * binormal in geom, are updated to the fitted arc, and the deviation from
+ * the intersection point is checked against the full blend tolerance.
+ */
+int blendTangentFit(BlendPoints3 * const points,
+        BlendParameters * const param, BlendGeom3 * const geom,
+        TC_STRUCT const * const prev_tc, TC_STRUCT const * const tc,
+        BlendCut3 * const cut1, BlendCut3 * const cut2)
+{
+    if (blendTangentTrim(prev_tc, param->d_plan, true, cut1) != TP_ERR_OK) {
+        tp_debug_print("failed to trim prev_tc at %f\n", param->d_plan);
+        return TP_ERR_FAIL;
+    }
+
+    // Bracket the second cut around d_plan, then bisect
+    double s_lo = param->d_plan / 4.0;
+    double s_hi = rtapi_fmin(param->d_plan * 4.0, tc->target * BLEND_DIST_FRACTION);
+    if (s_hi <= s_lo) {
+        return TP_ERR_FAIL;
+    }
+    if (blendTangentTrim(tc, s_lo, false, cut2) != TP_ERR_OK ||
+            blendTangentChordError(cut1, cut2) < 0.0) {
+        tp_debug_print("no tangent fit for s2 >= %f\n", s_lo);
+        return TP_ERR_FAIL;
+    }
+    if (blendTangentTrim(tc, s_hi, false, cut2) != TP_ERR_OK ||
+            blendTangentChordError(cut1, cut2) > 0.0) {
+        tp_debug_print("no tangent fit for s2 <= %f\n", s_hi);
+        return TP_ERR_FAIL;
+    }
+    int i;
+    for (i = 0; i < BLEND_TANGENT_FIT_ITERATIONS; ++i) {
+        double s_mid = (s_lo + s_hi) / 2.0;
+        if (blendTangentTrim(tc, s_mid, false, cut2) != TP_ERR_OK) {
+            return TP_ERR_FAIL;
+        }
+        if (blendTangentChordError(cut1, cut2) > 0.0) {
+            s_lo = s_mid;
+        } else {
+            s_hi = s_mid;
+        }
+    }
+    tp_debug_print("tangent fit: s1 = %f, s2 = %f\n", cut1->trim, cut2->trim);
+
+    // Plane of the two tangents, and in-plane normals towards the center
+    PmCartesian binormal, n1, n2, dn;
+    pmCartCartCross(&cut1->u_tan, &cut2->u_tan, &binormal);
+    if (pmCartUnitEq(&binormal)) {
+        return TP_ERR_FAIL;
+    }
+    pmCartCartCross(&binormal, &cut1->u_tan, &n1);
+    pmCartCartCross(&binormal, &cut2->u_tan, &n2);
+    pmCartCartSub(&n1, &n2, &dn);
+
+    // Solve point1 + R n1 = point2 + R n2 within the plane
+    PmCartesian chord, skew;
+    pmCartCartSub(&cut2->point, &cut1->point, &chord);
+    double c_b, c_n, dn_sq;
+    pmCartCartDot(&chord, &binormal, &c_b);
+    pmCartCartDot(&chord, &dn, &c_n);
+    pmCartMagSq(&dn, &dn_sq);
+    if (dn_sq < TP_POS_EPSILON) {
+        return TP_ERR_FAIL;
+    }
+    double R = c_n / dn_sq;
+    tp_debug_print("fitted R = %f, skew = %f\n", R, c_b);
+    if (R < TP_POS_EPSILON) {
+        return TP_ERR_FAIL;
+    }
+
+    points->arc_start = cut1->point;
+    points->arc_end = cut2->point;
+    pmCartScalMult(&n1, R, &points->arc_center);
+    pmCartCartAddEq(&points->arc_center, &cut1->point);
+    pmCartScalMult(&binormal, c_b / 2.0, &skew);
+    pmCartCartAddEq(&points->arc_center, &skew);
+    points->trim1 = cut1->trim;
+    points->trim2 = cut2->trim;
+    tp_debug_print("arc center = %f %f %f\n",
+            points->arc_center.x,
+            points->arc_center.y,
+            points->arc_center.z);
+
+    // Update blend geometry and parameters for the fitted arc
+    geom->u_tan1 = cut1->u_tan;
+    geom->u_tan2 = cut2->u_tan;
+    geom->binormal = binormal;
+    double dot;
+    pmCartCartDot(&cut1->u_tan, &cut2->u_tan, &dot);
+    param->phi = rtapi_acos(saturate(dot, 1.0));
+    param->theta = (PM_PI - param->phi) / 2.0;
+    param->R_plan = R;
+    param->v_plan = rtapi_fmin(param->v_plan, pmSqrt(param->a_n_max * R));
+    param->v_actual = rtapi_fmin(param->v_plan, param->v_req);
+    param->s_arc = R * param->phi;
+    tp_debug_print("v_plan = %f, s_arc = %f\n", param->v_plan, param->s_arc);
+
+    //Verify tolerances
+    PmCartesian r_PC;
+    pmCartCartSub(&points->arc_center, &geom->P, &r_PC);
+    double h;
+    pmCartMag(&r_PC, &h);
+    double T_final = h - R;
+    double T_max = param->tolerance / (1.0 - BLEND_TANGENT_DEV_RATIO);
+    tp_debug_print("T_final = %f\n",T_final);
+    if (T_final > T_max) {
+        tp_debug_print("Projected circle T (%f) exceeds tolerance %f, aborting blend arc\n",
+                T_final,
+                T_max);
+        return TP_ERR_FAIL;
+    }
+
+    if (param->s_arc < TP_MIN_ARC_LENGTH) {
+        tp_debug_print("#Blend arc length too small, aborting arc\n");
+        return TP_ERR_FAIL;
+    }
+
+    return TP_ERR_OK;
+}
+
+
 /**
  * Setup the spherical arc struct based on the blend arc data.
  */
@@ -19,6 +19,9 @@
 #define BLEND_ACC_RATIO_TANGENTIAL 0.5
 #define BLEND_ACC_RATIO_NORMAL (pmSqrt(1.0 - pmSq(BLEND_ACC_RATIO_TANGENTIAL)))
 #define BLEND_KINK_FACTOR 0.25
+/* Share of the blend tolerance left for segments leaving their tangent line */
+#define BLEND_TANGENT_DEV_RATIO 0.25
+#define BLEND_TANGENT_FIT_ITERATIONS 40
 
 typedef enum {
     BLEND_NONE,
@@ -114,6 +117,19 @@ typedef struct {
 
 
 
+/**
+ * Trimmed copy of a line or arc next to a tangent fitted blend.
+ * Only the field matching the segment's motion type is used.
+ */
+typedef struct {
+    PmCartLine line;
+    PmCircle circle;
+    PmCartesian point;          /* point where the segment was cut */
+    PmCartesian u_tan;          /* unit tangent at the cut point */
+    double trim;                /* path length cut from the segment */
+} BlendCut3;
+
+
 #ifdef BLEND_9D
 typedef struct {
 //Not implemented yet
@@ -136,6 +152,8 @@ int sat_inplace(double * const x, double max);
 
 int checkTangentAngle(PmCircle const * const circ, SphericalArc const * const arc, BlendGeom3 const * const geom, BlendParameters const * const param, double cycle_time, int at_end);
 
+int checkTangentVector(PmCartesian const * const u_seg, SphericalArc const * const arc, BlendParameters const * const param, double cycle_time, int at_end);
+
 int findIntersectionAngle(PmCartesian const * const u1,
         PmCartesian const * const u2, double * const theta);
 
@@ -205,6 +223,21 @@ int blendInit3FromArcArc(BlendGeom3 * const geom, BlendParameters * const param,
         PmCartesian const * const vel_bound,
         double maxFeedScale);
 
+int blendInit3FromTangents(BlendGeom3 * const geom, BlendParameters * const param,
+        TC_STRUCT const * const prev_tc,
+        TC_STRUCT const * const tc,
+        PmCartesian const * const acc_bound,
+        PmCartesian const * const vel_bound,
+        double maxFeedScale);
+
+int blendTangentTrim(TC_STRUCT const * const tc, double d, int at_end,
+        BlendCut3 * const cut);
+
+int blendTangentFit(BlendPoints3 * const points,
+        BlendParameters * const param, BlendGeom3 * const geom,
+        TC_STRUCT const * const prev_tc, TC_STRUCT const * const tc,
+        BlendCut3 * const cut1, BlendCut3 * const cut2);
+
 int blendArcArcPostProcess(BlendPoints3 * const points, BlendPoints3 const * const points_in,
         BlendParameters * const param, BlendGeom3 const * const geom,
         PmCircle const * const circ1, PmCircle const * const circ2);
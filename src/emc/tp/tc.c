@@ -558,6 +558,8 @@ int tcSetupMotion(TC_STRUCT * const tc,
     tc->target_vel = vel;
     // To be filled in by tangent calculation, negative = invalid (KLUDGE)
     tc->kink_vel = -1.0;
+    // No corner speed cap from userspace unless the next move brings one
+    tc->planned_vel = -1.0;
 
     return TP_ERR_OK;
 }
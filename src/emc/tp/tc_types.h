@@ -54,6 +54,9 @@ typedef enum {
 #define TC_ACCEL_TRAPZ 0
 #define TC_ACCEL_RAMP 1
 
+// Lines a segment can absorb by merging, each reported in turn (see tpMergeLine)
+#define TC_MERGE_MAX_LINES 16
+
 /**
  * Spiral arc length approximation by quadratic fit.
  */
@@ -127,6 +130,7 @@ typedef struct {
     double finalvel;        // velocity to aim for at end of segment
     double term_vel;        // actual velocity at termination of segment
     double kink_vel;        // Temporary way to store our calculation of maximum velocity we can handle if this segment is declared tangent with the next
+    double planned_vel;     // corner speed cap at the end, planned in userspace, negative = none
 
     //Acceleration
     double maxaccel;        // accel calc'd by task
@@ -173,6 +177,18 @@ typedef struct {
                             * speed) */
     int finalized;
 
+    // Collinear segment merging (see tpMergeLine)
+    int merged;             // number of lines merged into this segment
+    double merge_error;     // worst-case path deviation caused by merging
+    double merge_split[TC_MERGE_MAX_LINES]; // progress at which each merged line starts
+    int merge_id[TC_MERGE_MAX_LINES];       // ids of the merged lines, in order
+    int merge_line[TC_MERGE_MAX_LINES];     // their line numbers; the rest of
+                                            // their state tags is that of tag
+
+    // Cartesian limits derived from the joint limits (see tpApplyJointLimits)
+    double kins_vel_limit;
+    double kins_acc_limit;
+
     // Temporary status flags (reset each cycle)
     int is_blending;
 } TC_STRUCT;
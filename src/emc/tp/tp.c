@@ -11,6 +11,7 @@
 * Copyright (c) 2004 All rights reserved.
 ********************************************************************/
 #include "rtapi.h"              /* rtapi_print_msg */
+#include "rtapi_string.h"       /* memset */
 #include "posemath.h"           /* Geometry types & functions */
 #include "tc.h"
 #include "tp.h"
@@ -72,6 +73,15 @@ STATIC inline int tpAddSegmentToQueue(
         TC_STRUCT * const tc,
         int inc_id);
 
+/**
+ * Record a planner event in the trace ring, if tracing is enabled.
+ */
+STATIC inline void tpTrace(TP_STRUCT const * const tp, int type, int id,
+        int arg, double a, double b)
+{
+    tpTraceWrite(tp->shared->trace, tp->time, type, id, arg, a, b);
+}
+
 STATIC inline double tpGetMaxTargetVel(
         TP_STRUCT const * const tp,
         TC_STRUCT const * const tc);
@@ -413,6 +423,7 @@ int tpClear(TP_STRUCT * const tp)
     tp->motionType = 0;
     tp->termCond = TC_TERM_COND_PARABOLIC;
     tp->tolerance = 0.0;
+    tp->plannedVel = -1.0;
     tp->done = 1;
     tp->depth = tp->activeDepth = 0;
     tp->aborting = 0;
@@ -461,6 +472,7 @@ int tpInit(TP_STRUCT * const tp)
     tpGetMachineActiveLimit(&tp->vMax, &vel_bound);
 
     tp->old_spindlepos = 0.0; // sanity - just a temporary
+    tp->time = 0.0;
     return tpClear(tp);
 }
 
@@ -603,6 +615,24 @@ int tpSetTermCond(TP_STRUCT * const tp, int cond, double tolerance)
     return TP_ERR_OK;
 }
 
+/**
+ * Sets the corner speed cap for the start of the next line or circle.
+ * Canon computes it from the jerk limit and the G64 tolerance when it sends
+ * the move. It is only ever an upper bound on the corner with the move
+ * before; the TP's own limits still apply. The value is used by the next
+ * tpAddLine or tpAddCircle and then cleared. Negative means no cap.
+ */
+int tpSetPlannedVel(TP_STRUCT * const tp, double vel)
+{
+    if (!tp) {
+        return TP_ERR_FAIL;
+    }
+
+    tp->plannedVel = vel;
+
+    return TP_ERR_OK;
+}
+
 /**
  * Used to tell the tp the initial position.
  * It sets the current position AND the goal position to be the same.  Used
@@ -727,6 +757,172 @@ STATIC double tpCalculateOptimizationInitialVel(TP_STRUCT const * const tp, TC_S
 }
 
 
+/**
+ * Reduce a segment's max velocity so that it lasts at least one cycle.
+ */
+STATIC int tpClampVelocityByLength(TP_STRUCT const * const tp,
+        TC_STRUCT * const tc)
+{
+    double maxvel = tc->maxvel;
+    int res = tcClampVelocityByLength(tc);
+    if (tc->maxvel < maxvel) {
+        tpTrace(tp, TP_TRACE_CLAMP, tc->id, TP_TRACE_CLAMP_SAMPLE,
+                tc->maxvel, maxvel);
+    }
+    return res;
+}
+
+/**
+ * Limit a segment's velocity and acceleration by the joint limits.
+ * For non-trivial kinematics the path velocity and acceleration that the
+ * joints can follow varies along the path. The joint positions are sampled
+ * along the segment through the inverse kinematics, a batch of sample points
+ * per call so the kinematics can loop over them, and the first and second
+ * derivatives of the joint positions with respect to path length (dq/ds and
+ * d2q/ds2) are found by central differences. Each joint then limits the path
+ * velocity and acceleration:
+ *
+ *   v * |dq/ds| <= vel_limit
+ *   v^2 * |d2q/ds2| <= acc_limit / 2
+ *   a * |dq/ds| <= acc_limit / 2
+ *
+ * so that the tangential and the curvature terms each get half of the joint's
+ * acceleration. The results are cached in the TC and applied to maxvel and
+ * maxaccel, so tpRunCycle does no extra work.
+ *
+ * The sampling itself runs when the segment is queued, in the motion command
+ * handler in the servo thread, and costs 2 * samples + 1 inverse kinematics
+ * solves. A new line or arc is sampled at most twice, itself and its blend
+ * arc, or once when it is merged into the previous line, so a motion command
+ * adds at most 2 * (2 * TP_JOINT_LIMIT_MAX_SAMPLES + 1) solves to the servo
+ * period it is handled in. [TRAJ]JOINT_LIMIT_SAMPLES has to be chosen so that
+ * this fits the period with the kinematics in use; kinsbench measures the
+ * time per solve.
+ */
+STATIC int tpApplyJointLimits(TP_STRUCT const * const tp,
+        TC_STRUCT * const tc)
+{
+    int samples = get_jointLimitSamples(tp->shared);
+    if (samples <= 0 || tc->target < TP_POS_EPSILON) {
+        return TP_ERR_NO_ACTION;
+    }
+    if (samples > TP_JOINT_LIMIT_MAX_SAMPLES) {
+        samples = TP_JOINT_LIMIT_MAX_SAMPLES;
+    }
+
+    double vel_limit[EMCMOT_MAX_JOINTS];
+    double acc_limit[EMCMOT_MAX_JOINTS];
+    // Rolling buffer of joint positions at the last three sample points
+    double q[3][EMCMOT_MAX_JOINTS];
+
+    int num_joints = GetJointLimits(tp->shared, vel_limit, acc_limit, q[2]);
+    if (num_joints <= 0) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    double progress_saved = tc->progress;
+    double h = tc->target / (2.0 * samples);
+    double v_max = TP_BIG_NUM;
+    double a_max = TP_BIG_NUM;
+    int res = TP_ERR_OK;
+    int i, j;
+
+    // Sample points in structure of arrays layout for the batch kinematics
+    double world[9][TP_JOINT_LIMIT_BATCH];
+    double joint[EMCMOT_MAX_JOINTS][TP_JOINT_LIMIT_BATCH];
+    double *joint_rows[EMCMOT_MAX_JOINTS];
+    EmcPoseBatch batch = {
+        world[0], world[1], world[2],
+        world[3], world[4], world[5],
+        world[6], world[7], world[8],
+    };
+    int points = 2 * samples + 1;
+    int base, count, solved, k;
+
+    for (j = 0; j < EMCMOT_MAX_JOINTS; ++j) {
+        joint_rows[j] = joint[j];
+    }
+
+    for (base = 0; base < points && res == TP_ERR_OK; base += count) {
+        count = points - base;
+        if (count > TP_JOINT_LIMIT_BATCH) {
+            count = TP_JOINT_LIMIT_BATCH;
+        }
+        for (k = 0; k < count; ++k) {
+            EmcPose pos;
+            tc->progress = rtapi_fmin((base + k) * h, tc->target);
+            tcGetPosReal(tc, TC_GET_PROGRESS, &pos);
+            world[0][k] = pos.tran.x;
+            world[1][k] = pos.tran.y;
+            world[2][k] = pos.tran.z;
+            world[3][k] = pos.a;
+            world[4][k] = pos.b;
+            world[5][k] = pos.c;
+            world[6][k] = pos.u;
+            world[7][k] = pos.v;
+            world[8][k] = pos.w;
+        }
+        // q[2] keeps the last solution as the seed
+        for (j = 0; j < EMCMOT_MAX_JOINTS; ++j) {
+            joint[j][0] = j < num_joints ? q[2][j] : 0.0;
+        }
+        solved = KinsInverseBatch(tp->shared, count, &batch, joint_rows,
+                num_joints);
+
+        for (k = 0; k < count; ++k) {
+            i = base + k;
+            if (k >= solved) {
+                tp_debug_print("joint limits: inverse kinematics failed on tc id %d at %f\n",
+                        tc->id, rtapi_fmin(i * h, tc->target));
+                res = TP_ERR_FAIL;
+                break;
+            }
+            // Shift the rows down
+            for (j = 0; j < num_joints; ++j) {
+                q[0][j] = q[1][j];
+                q[1][j] = q[2][j];
+                q[2][j] = joint[j][k];
+            }
+            if (i < 2) {
+                continue;
+            }
+
+            // Derivatives at the middle sample
+            for (j = 0; j < num_joints; ++j) {
+                double dq = rtapi_fabs(q[2][j] - q[0][j]) / (2.0 * h);
+                double ddq = rtapi_fabs(q[2][j] - 2.0 * q[1][j] + q[0][j]) / (h * h);
+                if (vel_limit[j] > 0.0 && dq > TP_POS_EPSILON) {
+                    v_max = rtapi_fmin(v_max, vel_limit[j] / dq);
+                }
+                if (acc_limit[j] > 0.0 && dq > TP_POS_EPSILON) {
+                    a_max = rtapi_fmin(a_max, 0.5 * acc_limit[j] / dq);
+                }
+                if (acc_limit[j] > 0.0 && ddq > TP_POS_EPSILON) {
+                    v_max = rtapi_fmin(v_max, pmSqrt(0.5 * acc_limit[j] / ddq));
+                }
+            }
+        }
+    }
+    tc->progress = progress_saved;
+
+    if (res != TP_ERR_OK) {
+        return res;
+    }
+
+    tc->kins_vel_limit = v_max;
+    tc->kins_acc_limit = a_max;
+    if (v_max < tc->maxvel) {
+        tpTrace(tp, TP_TRACE_CLAMP, tc->id, TP_TRACE_CLAMP_JOINT, v_max, tc->maxvel);
+    }
+    tc->maxvel = rtapi_fmin(tc->maxvel, v_max);
+    tc->maxaccel = rtapi_fmin(tc->maxaccel, a_max);
+    tp_debug_print("joint limits: tc id %d, v_max = %f, a_max = %f\n",
+            tc->id, v_max, a_max);
+
+    return TP_ERR_OK;
+}
+
+
 /**
  * Initialize a blend arc from its parent lines.
  * This copies and initializes properties from the previous and next lines to
@@ -754,6 +950,8 @@ STATIC int tpInitBlendArcFromPrev(TP_STRUCT const * const tp,
             prev_tc->atspeed);
     //FIXME refactor into Init
     blend_tc->tag = prev_tc->tag;
+    // Assigned again when queued, set here so that traces carry it
+    blend_tc->id = tp->nextId;
 
     // Copy over state data from TP
     tcSetupState(blend_tc, tp);
@@ -774,6 +972,8 @@ STATIC int tpInitBlendArcFromPrev(TP_STRUCT const * const tp,
     blend_tc->target = length;
     blend_tc->nominal_length = length;
 
+    tpApplyJointLimits(tp, blend_tc);
+
     // Set the blend arc to be tangent to the next segment
     tcSetTermCond(blend_tc, TC_TERM_COND_TANGENT);
 
@@ -839,6 +1039,122 @@ STATIC int tpCheckTangentPerformance(TP_STRUCT const * const tp,
 }
 
 
+/**
+ * Create a blend arc between segments that are not coplanar.
+ * Used for helices and for arcs whose plane does not contain the other
+ * segment, where the exact planar blends above have to give up. The blend is
+ * sized from the tangent lines at the intersection (see
+ * blendInit3FromTangents), fitted to the tangents of the trimmed segments, and
+ * only kept if the remaining kink is within the limit for the blend velocity.
+ */
+STATIC int tpCreateTangentBlend(TP_STRUCT * const tp, TC_STRUCT * const prev_tc, TC_STRUCT * const tc, TC_STRUCT * const blend_tc)
+{
+    tp_debug_print("-- Starting tangent approximated blend arc --\n");
+
+    PmCartesian acc_bound, vel_bound;
+
+    //Get machine limits
+    tpGetMachineAccelBounds(tp, &acc_bound);
+    tpGetMachineVelBounds(tp, &vel_bound);
+
+    //Populate blend geometry struct
+    BlendGeom3 geom;
+    BlendParameters param;
+    BlendPoints3 points_exact;
+
+    int res_init = blendInit3FromTangents(&geom, &param,
+            prev_tc,
+            tc,
+            &acc_bound,
+            &vel_bound,
+            get_maxFeedScale(tp->shared));
+
+    if (res_init != TP_ERR_OK) {
+        tp_debug_print("blend init failed with code %d, aborting blend arc\n",
+                res_init);
+        return res_init;
+    }
+
+    int res_param = blendComputeParameters(&param);
+    if (res_param != TP_ERR_OK) {
+        return res_param;
+    }
+
+    //Store trimmed working copies of geometry
+    BlendCut3 cut1, cut2;
+    int res_fit = blendTangentFit(&points_exact, &param, &geom,
+            prev_tc, tc, &cut1, &cut2);
+    if (res_fit != TP_ERR_OK) {
+        tp_debug_print("tangent fit failed, aborting arc\n");
+        return TP_ERR_FAIL;
+    }
+
+    blendCheckConsume(&param, &points_exact, prev_tc, get_arcBlendGapCycles(tp->shared));
+
+    blendPoints3Print(&points_exact);
+    int res_arc = arcFromBlendPoints3(&blend_tc->coords.arc.xyz, &points_exact, &geom, &param);
+    if (res_arc < 0) {
+        tp_debug_print("arc creation failed, aborting arc\n");
+        return TP_ERR_FAIL;
+    }
+
+    // Note that previous restrictions don't allow ABC or UVW movement, so the
+    // end and start points should be identical
+    EmcPose prev_end;
+    tcGetEndpoint(prev_tc, &prev_end);
+    blend_tc->coords.arc.abc.x = prev_end.a;
+    blend_tc->coords.arc.abc.y = prev_end.b;
+    blend_tc->coords.arc.abc.z = prev_end.c;
+    blend_tc->coords.arc.uvw.x = prev_end.u;
+    blend_tc->coords.arc.uvw.y = prev_end.v;
+    blend_tc->coords.arc.uvw.z = prev_end.w;
+
+    //set the max velocity to v_plan, since we'll violate constraints otherwise.
+    tpInitBlendArcFromPrev(tp, prev_tc, blend_tc, param.v_req,
+            param.v_plan, param.a_max);
+    blend_tc->target_vel = param.v_actual;
+
+    int res_tangent1 = checkTangentVector(&cut1.u_tan, &blend_tc->coords.arc.xyz, &param, tp->cycleTime, false);
+    int res_tangent2 = checkTangentVector(&cut2.u_tan, &blend_tc->coords.arc.xyz, &param, tp->cycleTime, true);
+    if (res_tangent1 || res_tangent2) {
+        tp_debug_print("failed tangent check, aborting arc...\n");
+        return TP_ERR_FAIL;
+    }
+
+    if (tpCheckTangentPerformance(tp, prev_tc, tc, blend_tc) == TP_ERR_NO_ACTION) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    tp_debug_print("Passed all tests, updating segments\n");
+
+    //TODO refactor to pass consume to connect function
+    if (param.consume) {
+        //Since we're consuming the previous segment, pop the last line off of the queue
+        int res_pop = tcqPopBack(&tp->queue);
+        if (res_pop) {
+            tp_debug_print("failed to pop segment, aborting arc\n");
+            return TP_ERR_FAIL;
+        }
+    } else if (prev_tc->motion_type == TC_LINEAR) {
+        tcSetLineXYZ(prev_tc, &cut1.line);
+    } else {
+        tcSetCircleXYZ(prev_tc, &cut1.circle);
+    }
+
+    if (tc->motion_type == TC_LINEAR) {
+        tcSetLineXYZ(tc, &cut2.line);
+    } else {
+        tcSetCircleXYZ(tc, &cut2.circle);
+    }
+
+    //Cleanup any mess from parabolic
+    tc->blend_prev = 0;
+    tcSetTermCond(prev_tc, TC_TERM_COND_TANGENT);
+
+    return TP_ERR_OK;
+}
+
+
 STATIC int tpCreateLineArcBlend(TP_STRUCT * const tp, TC_STRUCT * const prev_tc, TC_STRUCT * const tc, TC_STRUCT * const blend_tc)
 {
     tp_debug_print("-- Starting LineArc blend arc --\n");
@@ -874,8 +1190,8 @@ STATIC int tpCreateLineArcBlend(TP_STRUCT * const tp, TC_STRUCT * const prev_tc,
             TP_ANGLE_EPSILON);
 
     if (!coplanar) {
-        tp_debug_print("aborting arc, not coplanar\n");
-        return TP_ERR_FAIL;
+        tp_debug_print("not coplanar, trying tangent blend\n");
+        return tpCreateTangentBlend(tp, prev_tc, tc, blend_tc);
     }
 
     int res_param = blendComputeParameters(&param);
@@ -1038,8 +1354,8 @@ STATIC int tpCreateArcLineBlend(TP_STRUCT * const tp, TC_STRUCT * const prev_tc,
             TP_ANGLE_EPSILON);
 
     if (!coplanar) {
-        tp_debug_print("aborting arc, not coplanar\n");
-        return TP_ERR_FAIL;
+        tp_debug_print("not coplanar, trying tangent blend\n");
+        return tpCreateTangentBlend(tp, prev_tc, tc, blend_tc);
     }
 
     int res_param = blendComputeParameters(&param);
@@ -1153,9 +1469,9 @@ STATIC int tpCreateArcArcBlend(TP_STRUCT * const tp, TC_STRUCT * const prev_tc,
     int colinear = pmCartCartParallel(&prev_tc->coords.circle.xyz.normal,
             &tc->coords.circle.xyz.normal, TP_ANGLE_EPSILON);
     if (!colinear) {
-        // Fail out if not collinear
-        tp_debug_print("arc abort: not coplanar\n");
-        return TP_ERR_FAIL;
+        // Arcs in different planes can't use the planar blend below
+        tp_debug_print("arcs not coplanar, trying tangent blend\n");
+        return tpCreateTangentBlend(tp, prev_tc, tc, blend_tc);
     }
 
     PmCartesian acc_bound, vel_bound;
@@ -1188,16 +1504,16 @@ STATIC int tpCreateArcArcBlend(TP_STRUCT * const tp, TC_STRUCT * const prev_tc,
             TP_ANGLE_EPSILON);
 
     if (!coplanar1) {
-        tp_debug_print("aborting blend arc, arc id %d is not coplanar with binormal\n", prev_tc->id);
-        return TP_ERR_FAIL;
+        tp_debug_print("arc id %d is not coplanar with binormal, trying tangent blend\n", prev_tc->id);
+        return tpCreateTangentBlend(tp, prev_tc, tc, blend_tc);
     }
 
     int coplanar2 = pmCartCartParallel(&geom.binormal,
             &tc->coords.circle.xyz.normal,
             TP_ANGLE_EPSILON);
     if (!coplanar2) {
-        tp_debug_print("aborting blend arc, arc id %d is not coplanar with binormal\n", tc->id);
-        return TP_ERR_FAIL;
+        tp_debug_print("arc id %d is not coplanar with binormal, trying tangent blend\n", tc->id);
+        return tpCreateTangentBlend(tp, prev_tc, tc, blend_tc);
     }
 
 
@@ -1581,6 +1897,9 @@ STATIC int tpComputeOptimalVelocity(TP_STRUCT const * const tp, TC_STRUCT * cons
     if (prev1_tc->kink_vel >=0 ) {
         vf_limit_prev = rtapi_fmin(vf_limit_prev, prev1_tc->kink_vel);
     }
+    if (prev1_tc->planned_vel >= 0) {
+        vf_limit_prev = rtapi_fmin(vf_limit_prev, prev1_tc->planned_vel);
+    }
     //Limit the PREVIOUS velocity by how much we can overshoot into
     double vf_limit = rtapi_fmin(vf_limit_this, vf_limit_prev);
 
@@ -1591,6 +1910,11 @@ STATIC int tpComputeOptimalVelocity(TP_STRUCT const * const tp, TC_STRUCT * cons
         tp_debug_print("found peak due to v_limit\n");
     }
 
+    if (vs_back != prev1_tc->finalvel) {
+        tpTrace(tp, TP_TRACE_OPTIMIZE, prev1_tc->id,
+                prev1_tc->optimization_state == TC_OPTIM_AT_MAX,
+                vs_back, vf_limit);
+    }
     //Limit tc's target velocity to avoid creating "humps" in the velocity profile
     prev1_tc->finalvel = vs_back;
 
@@ -1902,6 +2226,8 @@ STATIC int tpHandleBlendArc(TP_STRUCT * const tp, TC_STRUCT * const tc) {
     }
 
     if (res_create == TP_ERR_OK) {
+        tpTrace(tp, TP_TRACE_BLEND, prev_tc->id, type,
+                blend_tc.target, blend_tc.maxvel);
         //Need to do this here since the length changed
         tpAddSegmentToQueue(tp, &blend_tc, false);
     } else {
@@ -1911,6 +2237,199 @@ STATIC int tpHandleBlendArc(TP_STRUCT * const tp, TC_STRUCT * const tc) {
     return TP_ERR_OK;
 }
 
+/**
+ * Apply the corner speed cap from userspace to the corner at the end of the
+ * queue, just before the new segment goes in. A blend arc replaces the
+ * corner, so the cap limits the whole arc; otherwise it limits the final
+ * velocity of the last segment.
+ */
+STATIC int tpApplyPlannedVel(TP_STRUCT * const tp, double planned_vel)
+{
+    TC_STRUCT *last_tc = tcqLast(&tp->queue);
+    if (!last_tc || planned_vel < 0) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    if (last_tc->motion_type == TC_SPHERICAL) {
+        last_tc->maxvel = rtapi_fmin(last_tc->maxvel, planned_vel);
+    } else if (last_tc->planned_vel < 0 || planned_vel < last_tc->planned_vel) {
+        last_tc->planned_vel = planned_vel;
+    }
+    tp_debug_print("planned corner vel %f for tc id %d\n", planned_vel, last_tc->id);
+
+    return TP_ERR_OK;
+}
+
+/**
+ * Check if a new line can be merged into the last segment in the queue.
+ * Merging is only allowed between two pure XYZ feed lines with identical
+ * motion parameters, in blending mode, where the new line carries no synced IO
+ * or spindle requirements. The merged line runs from the start of prev_tc to
+ * the end of tc. The accumulated deviation of all merged vertices from that
+ * line must stay within the G64 P tolerance.
+ *
+ * On success, the new worst-case deviation is written to merge_error.
+ */
+STATIC int tpCheckMergeLine(TP_STRUCT const * const tp,
+        TC_STRUCT const * const prev_tc,
+        TC_STRUCT const * const tc,
+        double * const merge_error)
+{
+    if (!prev_tc || !tc || !merge_error) {
+        return TP_ERR_MISSING_INPUT;
+    }
+
+    if (prev_tc->motion_type != TC_LINEAR || tc->motion_type != TC_LINEAR) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    // Never touch a segment the RT cycle has already started on
+    if (prev_tc->active || prev_tc->progress > 0.0 || prev_tc->finalized) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    if (prev_tc->term_cond != TC_TERM_COND_PARABOLIC &&
+            prev_tc->term_cond != TC_TERM_COND_TANGENT) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    if (tpRotaryMotionCheck(tp, prev_tc) || tpRotaryMotionCheck(tp, tc)) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    // Anything that has to happen at the start of the new line prevents a merge
+    if (tc->syncdio.anychanged || tc->atspeed || tc->indexrotary != -1 ||
+            prev_tc->indexrotary != -1) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    if (tc->synchronized != TC_SYNC_NONE || prev_tc->synchronized != TC_SYNC_NONE) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    // Each merged line is reported with its own id, as far as there is room
+    if (prev_tc->merged >= TC_MERGE_MAX_LINES) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    // The merged lines are reported with the state tag of prev_tc, so it has
+    // to be theirs but for the line number
+    struct state_tag_t tag = tc->tag;
+    tag.fields[GM_FIELD_LINE_NUMBER] = prev_tc->tag.fields[GM_FIELD_LINE_NUMBER];
+    if (memcmp(&tag, &prev_tc->tag, sizeof(tag))) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    if (tc->canon_motion_type != prev_tc->canon_motion_type ||
+            tc->enables != prev_tc->enables ||
+            tc->term_cond != prev_tc->term_cond ||
+            rtapi_fabs(tc->reqvel - prev_tc->reqvel) > TP_VEL_EPSILON ||
+            rtapi_fabs(tc->tolerance - prev_tc->tolerance) > TP_POS_EPSILON) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    PmCartesian const * const start = &prev_tc->coords.line.xyz.start;
+    PmCartesian const * const vertex = &prev_tc->coords.line.xyz.end;
+    PmCartesian const * const end = &tc->coords.line.xyz.end;
+
+    PmCartLine merged;
+    if (pmCartLineInit(&merged, start, end) || merged.tmag_zero) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    // Both parts must progress forward along the merged line (no reversals)
+    PmCartesian to_vertex, from_vertex;
+    double along_prev, along_next;
+    pmCartCartSub(vertex, start, &to_vertex);
+    pmCartCartSub(end, vertex, &from_vertex);
+    pmCartCartDot(&to_vertex, &merged.uVec, &along_prev);
+    pmCartCartDot(&from_vertex, &merged.uVec, &along_next);
+    if (along_prev <= 0.0 || along_next <= 0.0) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    // Distance of the shared vertex from the merged line
+    PmCartesian proj, perp;
+    double deviation;
+    pmCartScalMult(&merged.uVec, along_prev, &proj);
+    pmCartCartSub(&to_vertex, &proj, &perp);
+    pmCartMag(&perp, &deviation);
+
+    /* Vertices merged earlier were within prev_tc->merge_error of the old
+     * line, which itself deviates from the new one by at most the vertex
+     * deviation over its length, so the sum is a conservative bound.
+     */
+    double error = prev_tc->merge_error + deviation;
+    double tolerance = rtapi_fmax(prev_tc->tolerance, TP_MERGE_MIN_TOLERANCE);
+    if (error > tolerance) {
+        tp_debug_print("merge error %g exceeds tolerance %g\n", error, tolerance);
+        return TP_ERR_NO_ACTION;
+    }
+
+    /* If prev_tc is entered tangentially (blend arc or kink), changing its
+     * direction would break that tangency, so only exact collinear merges are
+     * allowed there.
+     */
+    int len = tcqLen(&tp->queue);
+    TC_STRUCT const * const prev2_tc = len > 1 ? tcqItem(&tp->queue, len - 2) : NULL;
+    if (prev2_tc && prev2_tc->term_cond == TC_TERM_COND_TANGENT &&
+            error > TP_MERGE_MIN_TOLERANCE) {
+        return TP_ERR_NO_ACTION;
+    }
+
+    *merge_error = error;
+    return TP_ERR_OK;
+}
+
+
+/**
+ * Extend the last line in the queue to absorb a new line.
+ * The merged segment keeps the id and state tag of its first line. The id and
+ * line number of each absorbed line are stored in order, along with the
+ * progress at which it begins, so that line number and state reporting step
+ * through all of them as the merged segment reaches each one.
+ */
+STATIC int tpMergeLine(TP_STRUCT * const tp,
+        TC_STRUCT * const prev_tc,
+        TC_STRUCT const * const tc,
+        EmcPose const * const end,
+        double merge_error)
+{
+    EmcPose start;
+    tcGetStartpoint(prev_tc, &start);
+
+    PmLine9 line;
+    if (pmLine9Init(&line, &start, end)) {
+        return TP_ERR_FAIL;
+    }
+
+    int n = prev_tc->merged;
+    PmCartesian to_vertex;
+    pmCartCartSub(&prev_tc->coords.line.xyz.end, &line.xyz.start, &to_vertex);
+    pmCartCartDot(&to_vertex, &line.xyz.uVec, &prev_tc->merge_split[n]);
+
+    prev_tc->coords.line = line;
+    prev_tc->target = pmLine9Target(&prev_tc->coords.line);
+    prev_tc->nominal_length = prev_tc->target;
+    prev_tc->merge_error = merge_error;
+    prev_tc->merge_id[n] = tp->nextId;
+    prev_tc->merge_line[n] = tc->tag.fields[GM_FIELD_LINE_NUMBER];
+    prev_tc->merged++;
+
+    // The new line's limits weren't clamped by its own length yet
+    prev_tc->maxvel = tc->maxvel;
+    prev_tc->maxaccel = rtapi_fmin(prev_tc->maxaccel, tc->maxaccel);
+    tpApplyJointLimits(tp, prev_tc);
+    tpClampVelocityByLength(tp, prev_tc);
+
+    tp->nextId++;
+    tp->goalPos = *end;
+    tp_debug_print("Merged line id %d into tc id %d, new length %f, error %g\n",
+            prev_tc->merge_id[n], prev_tc->id, prev_tc->target, merge_error);
+
+    return TP_ERR_OK;
+}
+
 //TODO final setup steps as separate functions
 //
 /**
@@ -1921,6 +2440,10 @@ STATIC int tpHandleBlendArc(TP_STRUCT * const tp, TC_STRUCT * const tc) {
 int tpAddLine(TP_STRUCT * const tp, EmcPose end, int canon_motion_type, double vel, double
         ini_maxvel, double acc, unsigned char enables, char atspeed, int indexrotary, struct state_tag_t tag) {
 
+    // The corner cap from userspace is for this move only
+    double planned_vel = tp->plannedVel;
+    tp->plannedVel = -1.0;
+
     if (tpErrorCheck(tp) < 0) {
         return TP_ERR_FAIL;
     }
@@ -1935,6 +2458,8 @@ int tpAddLine(TP_STRUCT * const tp, EmcPose end, int canon_motion_type, double v
             enables,
             atspeed);
     tc.tag = tag;
+    // Assigned again when queued, set here so that traces carry it
+    tc.id = tp->nextId;
 
     // Copy in motion parameters
     tcSetupMotion(&tc,
@@ -1958,7 +2483,6 @@ int tpAddLine(TP_STRUCT * const tp, EmcPose end, int canon_motion_type, double v
         return TP_ERR_ZERO_LENGTH;
     }
     tc.nominal_length = tc.target;
-    tcClampVelocityByLength(&tc);
 
     // For linear move, set rotary axis settings 
     tc.indexrotary = indexrotary;
@@ -1966,10 +2490,25 @@ int tpAddLine(TP_STRUCT * const tp, EmcPose end, int canon_motion_type, double v
     //TODO refactor this into its own function
     TC_STRUCT *prev_tc;
     prev_tc = tcqLast(&tp->queue);
+
+    // Coalesce collinear / tiny lines into the previous line if possible
+    double merge_error;
+    if (get_segmentMergeEnable(tp->shared) &&
+            tpCheckMergeLine(tp, prev_tc, &tc, &merge_error) == TP_ERR_OK &&
+            tpMergeLine(tp, prev_tc, &tc, &end, merge_error) == TP_ERR_OK) {
+        tpRunOptimization(tp);
+        return TP_ERR_OK;
+    }
+
+    // Not before the merge, which samples the merged line instead
+    tpApplyJointLimits(tp, &tc);
+
+    tpClampVelocityByLength(tp, &tc);
     tpCheckCanonType(prev_tc, &tc);
     if (get_arcBlendEnable(tp->shared)){
         tpHandleBlendArc(tp, &tc);
     }
+    tpApplyPlannedVel(tp, planned_vel);
     tcCheckLastParabolic(&tc, prev_tc);
     tcFinalizeLength(prev_tc);
     tcFlagEarlyStop(prev_tc, &tc);
@@ -2005,6 +2544,10 @@ int tpAddCircle(TP_STRUCT * const tp,
         char atspeed,
         struct state_tag_t tag)
 {
+    // The corner cap from userspace is for this move only
+    double planned_vel = tp->plannedVel;
+    tp->plannedVel = -1.0;
+
     if (tpErrorCheck(tp)<0) {
         return TP_ERR_FAIL;
     }
@@ -2021,6 +2564,8 @@ int tpAddCircle(TP_STRUCT * const tp,
             enables,
             atspeed);
     tc.tag = tag;
+    // Assigned again when queued, set here so that traces carry it
+    tc.id = tp->nextId;
     // Setup any synced IO for this move
     tpSetupSyncedIO(tp, &tc);
 
@@ -2046,7 +2591,7 @@ int tpAddCircle(TP_STRUCT * const tp,
     tc.nominal_length = tc.target;
 
     //Reduce max velocity to match sample rate
-    tcClampVelocityByLength(&tc);
+    tpClampVelocityByLength(tp, &tc);
 
     double v_max_actual = pmCircleActualMaxVel(&tc.coords.circle.xyz, ini_maxvel, acc, false);
 
@@ -2056,6 +2601,12 @@ int tpAddCircle(TP_STRUCT * const tp,
             v_max_actual,
             acc);
 
+    if (get_jointLimitSamples(tp->shared) > 0) {
+        // Sampling the arc by progress needs the spiral fit
+        findSpiralArcLengthFit(&tc.coords.circle.xyz, &tc.coords.circle.fit);
+        tpApplyJointLimits(tp, &tc);
+    }
+
     TC_STRUCT *prev_tc;
     prev_tc = tcqLast(&tp->queue);
 
@@ -2064,6 +2615,7 @@ int tpAddCircle(TP_STRUCT * const tp,
         tpHandleBlendArc(tp, &tc);
         findSpiralArcLengthFit(&tc.coords.circle.xyz, &tc.coords.circle.fit);
     }
+    tpApplyPlannedVel(tp, planned_vel);
     tcCheckLastParabolic(&tc, prev_tc);
     tcFinalizeLength(prev_tc);
     tcFlagEarlyStop(prev_tc, &tc);
@@ -2156,6 +2708,10 @@ STATIC int tpComputeBlendVelocity(TP_STRUCT const * const tp,
             v_blend_next = rtapi_fmin(v_blend_next, tblend_vel);
         }
     }
+    if (tc->planned_vel >= 0) {
+        v_blend_this = rtapi_fmin(v_blend_this, tc->planned_vel);
+        v_blend_next = rtapi_fmin(v_blend_next, tc->planned_vel);
+    }
 
     tc->blend_vel = v_blend_this;
     nexttc->blend_vel = v_blend_next;
@@ -2472,6 +3028,18 @@ STATIC int tpUpdateMovementStatus(TP_STRUCT * const tp, TC_STRUCT const * const
     set_enables_queued(tp->shared, tc->enables);
     // report our line number to the guis
     tp->execId = tc->id;
+    if (tc->merged) {
+        // The last of the lines merged into this segment that has started
+        int n = tc->merged;
+        while (n > 0 && tc->progress < tc->merge_split[n - 1]) {
+            n--;
+        }
+        tp->execTag = tc->tag;
+        if (n > 0) {
+            tp->execId = tc->merge_id[n - 1];
+            tp->execTag.fields[GM_FIELD_LINE_NUMBER] = tc->merge_line[n - 1];
+        }
+    }
     set_requested_vel(tp->shared, tc->reqvel);
     set_current_vel(tp->shared,   tc->currentvel);
     emcPoseSub2fp(&tc_pos, &tp->currentPos, tp->shared->dtg);
@@ -2737,6 +3305,8 @@ STATIC int tpActivateSegment(TP_STRUCT * const tp, TC_STRUCT * const tc) {
             tc->target);
 
     tc->active = 1;
+    tpTrace(tp, TP_TRACE_ACTIVATE, tc->id, tc->accel_mode,
+            tc->target, tpGetRealTargetVel(tp, tc));
     //Do not change initial velocity here, since tangent blending already sets this up
     tp->motionType = tc->canon_motion_type;
     tc->blending_next = 0;
@@ -3115,6 +3685,8 @@ STATIC int tpHandleSplitCycle(TP_STRUCT * const tp, TC_STRUCT * const tc,
 
     // Trigger removal of current segment at the end of the cycle
     tc->remove = 1;
+    tpTrace(tp, TP_TRACE_SPLIT, tc->id, 0,
+            tp->cycleTime - tc->cycle_time, tc->term_vel);
 
     if (!nexttc) {
         tp_debug_print("no nexttc in split cycle\n");
@@ -3205,6 +3777,8 @@ int tpRunCycle(TP_STRUCT * const tp, long period)
     tc = tcqItem(&tp->queue, 0);
     nexttc = tcqItem(&tp->queue, 1);
 
+    tp->time += tp->cycleTime;
+
     //Set GUI status to "zero" state
     tpUpdateInitialStatus(tp);
 
@@ -3349,6 +3923,8 @@ int tpAbort(TP_STRUCT * const tp)
         /* const to abort, signal a pause and set our abort flag */
         tpPause(tp);
         tp->aborting = 1;
+        tpTrace(tp, TP_TRACE_ABORT, tp->execId, 0,
+                get_current_vel(tp->shared), 0.0);
     }
     return tpClearDIOs(tp); //clears out any already cached DIOs
 }
@@ -35,6 +35,7 @@ typedef int (*tpSetId_t)(TP_STRUCT * tp, int id);
 typedef int (*tpGetExecId_t)(TP_STRUCT * tp);
 typedef struct state_tag_t (*tpGetExecTag_t)(TP_STRUCT * const tp);
 typedef int (*tpSetTermCond_t)(TP_STRUCT * tp, int cond, double tolerance);
+typedef int (*tpSetPlannedVel_t)(TP_STRUCT * tp, double vel);
 typedef int (*tpSetPos_t)(TP_STRUCT * tp, EmcPose const * const pos);
 typedef int (*tpAddCurrentPos_t)(TP_STRUCT * const tp, EmcPose const * const disp);
 typedef int (*tpSetCurrentPos_t)(TP_STRUCT * const tp, EmcPose const * const pos);
@@ -106,6 +107,7 @@ typedef struct {
     tpGetExecId_t	tpGetExecId;
     tpGetExecTag_t      tpGetExecTag;
     tpSetTermCond_t	tpSetTermCond;
+    tpSetPlannedVel_t	tpSetPlannedVel;
     tpSetPos_t          tpSetPos;
     tpAddCurrentPos_t   tpAddCurrentPos;
     tpSetCurrentPos_t   tpSetCurrentPos;
@@ -34,6 +34,8 @@ struct state_tag_t tpGetExecTag(TP_STRUCT * const tp);
 
 int tpSetTermCond(TP_STRUCT * tp, int cond, double tolerance);
 
+int tpSetPlannedVel(TP_STRUCT * tp, double vel);
+
 int tpSetPos(TP_STRUCT * tp, EmcPose const * const pos);
 
 int tpAddCurrentPos(TP_STRUCT * const tp, EmcPose const * const disp);
@@ -4,6 +4,9 @@
 #include "hal.h"
 #include "rtapi_math.h"
 #include "emcpose.h"
+#include "kinematics.h"
+#include "emcmotcfg.h"  // EMCMOT_MAX_JOINTS
+#include "tp_trace.h"
 
 typedef void (*emcmotDioWrite_t)(unsigned int index, hal_bit_t   value);
 typedef void (*emcmotAioWrite_t)(unsigned int index, hal_float_t value);
@@ -11,6 +14,17 @@ typedef void (*emcmotAioWrite_t)(unsigned int index, hal_float_t value);
 typedef void (*emcmotSetRotaryUnlock_t)(int axis, hal_bit_t unlock);
 typedef hal_bit_t  (*emcmotGetRotaryIsUnlocked_t)(int axis);
 
+// joints[] holds the starting guess for iterative kinematics on entry
+typedef int (*emcmotKinsInverse_t)(EmcPose const * const pos, double * const joints);
+// n points at once, see kinematics.h; joints[j][0] holds the starting guess
+// on entry, returns the number of leading points solved
+typedef int (*emcmotKinsInverseBatch_t)(int n, EmcPoseBatch const * const pos,
+					double * const * const joints);
+// returns the number of joints, limits are 0 for inactive joints
+typedef int (*emcmotGetJointLimits_t)(double * const vel_limit,
+				      double * const acc_limit,
+				      double * const pos_cmd);
+
 
 // this holds all shared data between using code and the tp
 // data items can be pins if so desired,
@@ -29,9 +43,14 @@ typedef struct tp_shared_t {
     hal_float_t *arcBlendRampFreq;
     hal_bit_t   *arcBlendFallbackEnable;
     hal_float_t *arcBlendTangentKinkRatio;
+    hal_bit_t   *segmentMergeEnable;
+    hal_s32_t   *jointLimitSamples;
     hal_float_t *maxFeedScale;
     hal_float_t *net_feed_scale;
 
+    // event trace ring, NULL if tracing is off (see tp_trace.h)
+    ringbuffer_t *trace;
+
     hal_float_t *acc_limit[3];
     hal_float_t *vel_limit[3];
 
@@ -65,6 +84,11 @@ typedef struct tp_shared_t {
     emcmotSetRotaryUnlock_t SetRotaryUnlock;
     emcmotGetRotaryIsUnlocked_t GetRotaryIsUnlocked;
 
+    // upcalls for joint limited planning
+    emcmotKinsInverse_t KinsInverse;
+    emcmotKinsInverseBatch_t KinsInverseBatch;
+    emcmotGetJointLimits_t GetJointLimits;
+
 } tp_shared_t;
 
 static inline int get_num_dio(tp_shared_t *ts)  { return *(ts->num_dio); }
@@ -145,6 +169,16 @@ static inline hal_float_t get_arcBlendTangentKinkRatio(tp_shared_t *ts)
     return rtapi_fmax(rtapi_fmin(*(ts->arcBlendTangentKinkRatio), max_ratio), min_ratio);
 }
 
+static inline hal_bit_t get_segmentMergeEnable(tp_shared_t *ts)
+{ return *(ts->segmentMergeEnable); }
+static inline void set_segmentMergeEnable(tp_shared_t *ts, hal_bit_t n)
+{ *(ts->segmentMergeEnable) = n; }
+
+static inline hal_s32_t get_jointLimitSamples(tp_shared_t *ts)
+{ return ts->jointLimitSamples ? *(ts->jointLimitSamples) : 0; }
+static inline void set_jointLimitSamples(tp_shared_t *ts, hal_s32_t n)
+{ *(ts->jointLimitSamples) = n; }
+
 static inline void dioWrite(tp_shared_t *ts, unsigned int index, char value)
 { if (ts->dioWrite) ts->dioWrite(index, value); }
 static inline void aioWrite(tp_shared_t *ts, unsigned int index, double value)
@@ -253,4 +287,58 @@ static inline int GetRotaryIsUnlocked(tp_shared_t *ts,
     return 0;
 }
 
+static inline int KinsInverse(tp_shared_t *ts,
+			      EmcPose const * const pos,
+			      double * const joints)
+{
+    if (ts->KinsInverse)
+	return ts->KinsInverse(pos, joints);
+    return -1;
+}
+
+// kinematics without the batch entry are solved here point by point
+// with KinsInverse, each point seeded with the previous solution
+static inline int KinsInverseBatch(tp_shared_t *ts, int n,
+				   EmcPoseBatch const * const pos,
+				   double * const * const joints,
+				   int num_joints)
+{
+    double q[EMCMOT_MAX_JOINTS];
+    EmcPose p;
+    int i, j;
+
+    if (ts->KinsInverseBatch)
+	return ts->KinsInverseBatch(n, pos, joints);
+    if (n <= 0)
+	return 0;
+    for (j = 0; j < num_joints; j++)
+	q[j] = joints[j][0];
+    for (i = 0; i < n; i++) {
+	p.tran.x = pos->x[i];
+	p.tran.y = pos->y[i];
+	p.tran.z = pos->z[i];
+	p.a = pos->a[i];
+	p.b = pos->b[i];
+	p.c = pos->c[i];
+	p.u = pos->u[i];
+	p.v = pos->v[i];
+	p.w = pos->w[i];
+	if (KinsInverse(ts, &p, q) != 0)
+	    return i;
+	for (j = 0; j < num_joints; j++)
+	    joints[j][i] = q[j];
+    }
+    return n;
+}
+
+static inline int GetJointLimits(tp_shared_t *ts,
+				 double * const vel_limit,
+				 double * const acc_limit,
+				 double * const pos_cmd)
+{
+    if (ts->GetJointLimits)
+	return ts->GetJointLimits(vel_limit, acc_limit, pos_cmd);
+    return 0;
+}
+
 #endif //_TP_SHARED_H
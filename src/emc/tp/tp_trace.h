@@ -0,0 +1,100 @@
+/********************************************************************
+* Description: tp_trace.h
+*   Binary event trace of the trajectory planner.
+*
+*   When motion is loaded with tp_trace_size > 0, it creates the HAL
+*   record ring "motion.tp-trace" and the TP writes one fixed size record
+*   per event to it. Writes never block: if the ring is full the event is
+*   dropped and counted in the ring's scratchpad. The tptrace script reads
+*   the ring (or a file dumped by tpsim -E) and prints a timeline.
+*
+* Author:
+* License: GPL Version 2
+* System: Linux
+*
+* Copyright (c) 2026 All rights reserved.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+********************************************************************/
+#ifndef TP_TRACE_H
+#define TP_TRACE_H
+
+#include "rtapi.h"
+#include "ring.h"
+
+#define TP_TRACE_RING_NAME "motion.tp-trace"
+#define TP_TRACE_MAGIC 0x54505452	/* "TPTR" */
+
+/* Event types. The meaning of arg, a and b for each type is listed here
+   and must match tptrace.py. */
+typedef enum {
+    TP_TRACE_ACTIVATE = 1,	/* segment starts: a = length, b = target vel,
+				   arg = accel mode */
+    TP_TRACE_BLEND = 2,		/* blend arc added after id: a = length,
+				   b = blend vel, arg = blend type */
+    TP_TRACE_OPTIMIZE = 3,	/* final vel planned: a = finalvel,
+				   b = limit, arg = 1 if at the limit */
+    TP_TRACE_SPLIT = 4,		/* segment ends within a cycle: a = time left
+				   in the cycle, b = final vel */
+    TP_TRACE_CLAMP = 5,		/* max vel lowered: a = new, b = old,
+				   arg = reason, see below */
+    TP_TRACE_ABORT = 6,		/* abort requested: a = current vel */
+} tp_trace_event_t;
+
+/* reasons for TP_TRACE_CLAMP */
+typedef enum {
+    TP_TRACE_CLAMP_SAMPLE = 1,	/* segment shorter than one cycle at speed */
+    TP_TRACE_CLAMP_JOINT = 2,	/* joint limits through the kinematics */
+} tp_trace_clamp_t;
+
+typedef struct {
+    double time;		/* planner time in seconds */
+    __s32 id;		/* segment id */
+    __u16 type;		/* tp_trace_event_t */
+    __u16 arg;
+    double a;
+    double b;
+} tp_trace_record_t;
+
+/* ring scratchpad */
+typedef struct {
+    __u32 magic;
+    __u32 dropped;		/* events lost to a full ring */
+} tp_trace_header_t;
+
+static inline void tpTraceWrite(ringbuffer_t *rb, double time, int type,
+				int id, int arg, double a, double b)
+{
+    tp_trace_record_t *rec;
+
+    if (!rb) {
+	return;
+    }
+    if (record_write_begin(rb, (void **) &rec, sizeof(*rec))) {
+	if (rb->scratchpad) {
+	    ((tp_trace_header_t *) rb->scratchpad)->dropped++;
+	}
+	return;
+    }
+    rec->time = time;
+    rec->id = id;
+    rec->type = type;
+    rec->arg = arg;
+    rec->a = a;
+    rec->b = b;
+    record_write_end(rb, rec, sizeof(*rec));
+}
+
+#endif				/* TP_TRACE_H */
@@ -19,7 +19,7 @@
 #include "tc_types.h"
 #include "tcq.h"
 
-#if defined(BUILD_SYS_USER_DSO)
+#if defined(BUILD_SYS_USER_DSO) || defined(ULAPI)
 #include <stdbool.h>
 #endif
 
@@ -47,6 +47,16 @@
 #define TP_MIN_ARC_ANGLE 1e-3
 #define TP_MIN_ARC_LENGTH 1e-6
 #define TP_BIG_NUM 1e10
+/* Deviation accepted when merging lines with no G64 P tolerance set, i.e.
+ * only numerically collinear lines are merged. */
+#define TP_MERGE_MIN_TOLERANCE 1e-9
+
+/* Upper bound on the samples per segment used to apply joint limits. Each
+ * sampled segment takes 2 * samples + 1 inverse kinematics solves in the
+ * servo thread, see tpApplyJointLimits. */
+#define TP_JOINT_LIMIT_MAX_SAMPLES 8
+/* Sample points passed to the batch inverse kinematics per call */
+#define TP_JOINT_LIMIT_BATCH (2 * TP_JOINT_LIMIT_MAX_SAMPLES + 1)
 
 /**
  * TP return codes.
@@ -129,6 +139,11 @@ typedef struct {
     double tolerance;           /* for subsequent motions, stay within this
                                    distance of the programmed path during
                                    blends */
+    double plannedVel;          /* corner speed cap for the start of the
+                                   next move, planned in userspace, < 0 if
+                                   none */
+    double time;                /* planner time, advanced every cycle, for
+                                   the event trace */
     int synchronized;       // spindle sync required for this move
     int velocity_mode; 	        /* TRUE if spindle sync is in velocity mode,
 				   FALSE if in position mode */
@@ -5,7 +5,7 @@
 #include "tp.h"
 #include "tp_private.h"
 
-#define VTVERSION  VTTP_VERSION1
+#define VTVERSION  VTTP_VERSION2
 
 MODULE_AUTHOR("Michael Haberler");
 MODULE_DESCRIPTION("machinekit trajectory planner");
@@ -26,6 +26,7 @@ static vtp_t vtp = {
     .tpGetExecId       = tpGetExecId,
     .tpGetExecTag      = tpGetExecTag,
     .tpSetTermCond     = tpSetTermCond,
+    .tpSetPlannedVel   = tpSetPlannedVel,
     .tpSetPos          = tpSetPos,
     .tpAddCurrentPos   = tpAddCurrentPos,
     .tpSetCurrentPos   = tpSetCurrentPos,
@@ -0,0 +1,731 @@
+/********************************************************************
+* Description: tpsim.c
+*   Offline trajectory planner simulator and benchmark driver.
+*
+*   Runs the realtime trajectory planner (tp.c and friends) in userspace
+*   against a canon call stream as printed by the standalone interpreter:
+*
+*       rs274 -g program.ngc | tpsim [options]
+*
+*   Motion is advanced in simulated time, one tpRunCycle() per cycle, while
+*   the host CPU time spent in each call is measured. A summary is printed
+*   on exit (key = value, one per line, for performance tracking), and an
+*   optional per-cycle trace of position, velocity, acceleration, jerk and
+*   queue depth can be written as CSV. The planner's own event trace (see
+*   tp_trace.h) can be dumped in binary for the tptrace script.
+*
+* Author:
+* License: GPL Version 2
+* System: Linux
+*
+* Copyright (c) 2026 All rights reserved.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "rtapi.h"
+#include "rtapi_math.h"
+#include "posemath.h"
+#include "emcpose.h"
+#include "tc.h"
+#include "tcq.h"
+#include "tp.h"
+#include "tp_private.h"
+#include "tp_shared.h"
+#include "motion_types.h"
+#include "emcmotcfg.h"
+
+#define TPSIM_DEFAULT_CYCLE_TIME 0.001
+#define TPSIM_HIST_BINS 200          /* per-cycle CPU time histogram bins */
+#define TPSIM_HIST_BIN_NS 250        /* width of one bin */
+#define TPSIM_MAX_IDLE_CYCLES 100000 /* give up if the TP stops making progress */
+#define TPSIM_MIN_QUEUE_SIZE 32      /* must exceed the tcqFull() margin */
+#define TPSIM_EVENT_RING_SIZE 65536  /* drained every cycle */
+
+// storage behind the tp_shared_t pointers, normally owned by motion
+static struct {
+    hal_s32_t num_dio;
+    hal_s32_t num_aio;
+    hal_s32_t arcBlendGapCycles;
+    hal_s32_t arcBlendOptDepth;
+    hal_bit_t arcBlendEnable;
+    hal_float_t arcBlendRampFreq;
+    hal_bit_t arcBlendFallbackEnable;
+    hal_float_t arcBlendTangentKinkRatio;
+    hal_bit_t segmentMergeEnable;
+    hal_s32_t jointLimitSamples;
+    hal_float_t maxFeedScale;
+    hal_float_t net_feed_scale;
+    hal_float_t acc_limit[3];
+    hal_float_t vel_limit[3];
+    hal_bit_t stepping;
+    hal_u32_t enables_new;
+    hal_s32_t spindle_direction;
+    hal_float_t spindleRevs;
+    hal_float_t spindleSpeedIn;
+    hal_float_t spindle_speed;
+    hal_bit_t spindle_index_enable;
+    hal_bit_t spindle_is_atspeed;
+    hal_bit_t spindleSync;
+    hal_float_t current_vel;
+    hal_float_t dtg[9];
+    hal_float_t requested_vel;
+    hal_float_t distance_to_go;
+    hal_u32_t enables_queued;
+    hal_u32_t tcqlen;
+} sim;
+
+static tp_shared_t shared;
+static TP_STRUCT tp;
+static TC_STRUCT *tcSpace;
+
+// interpreter-side state, as kept by emccanon
+static struct {
+    double feed;            /* units/sec */
+    double vmax;            /* machine velocity limit, units/sec */
+    double amax;            /* machine acceleration limit, units/sec^2 */
+    double corner_vel;      /* corner speed cap sent with each move, < 0 = none */
+    int plane;              /* 1 = XY, 2 = YZ, 3 = XZ (CANON_PLANE) */
+    int next_id;
+    EmcPose pos;
+} canon;
+
+// statistics
+static struct {
+    long cycles;
+    long segments;
+    long max_depth;
+    double depth_sum;
+    double sim_time;
+    double dwell_time;
+    double cpu_sum;
+    double cpu_max;
+    double cpu_min;
+    long hist[TPSIM_HIST_BINS + 1];
+    double v_max, a_max, j_max;
+    double v_prev, a_prev;
+    EmcPose pos_prev;
+    long errors;
+} stats;
+
+static FILE *trace;
+static FILE *events;
+static ringbuffer_t event_ring;
+
+static int sim_kins_inverse(EmcPose const * const pos, double * const joints)
+{
+    joints[0] = pos->tran.x;
+    joints[1] = pos->tran.y;
+    joints[2] = pos->tran.z;
+    return 0;
+}
+
+static int sim_kins_inverse_batch(int n, EmcPoseBatch const * const pos,
+        double * const * const joints)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+        joints[0][i] = pos->x[i];
+        joints[1][i] = pos->y[i];
+        joints[2][i] = pos->z[i];
+    }
+    return n;
+}
+
+static int sim_get_joint_limits(double * const vel_limit,
+        double * const acc_limit, double * const pos_cmd)
+{
+    int i;
+    for (i = 0; i < 3; i++) {
+        vel_limit[i] = sim.vel_limit[i];
+        acc_limit[i] = sim.acc_limit[i];
+        pos_cmd[i] = 0.0;
+    }
+    return 3;
+}
+
+static void init_shared(void)
+{
+    int i;
+    shared.num_dio = &sim.num_dio;
+    shared.num_aio = &sim.num_aio;
+    shared.arcBlendGapCycles = &sim.arcBlendGapCycles;
+    shared.arcBlendOptDepth = &sim.arcBlendOptDepth;
+    shared.arcBlendEnable = &sim.arcBlendEnable;
+    shared.arcBlendRampFreq = &sim.arcBlendRampFreq;
+    shared.arcBlendFallbackEnable = &sim.arcBlendFallbackEnable;
+    shared.arcBlendTangentKinkRatio = &sim.arcBlendTangentKinkRatio;
+    shared.segmentMergeEnable = &sim.segmentMergeEnable;
+    shared.jointLimitSamples = &sim.jointLimitSamples;
+    shared.maxFeedScale = &sim.maxFeedScale;
+    shared.net_feed_scale = &sim.net_feed_scale;
+    for (i = 0; i < 3; i++) {
+        shared.acc_limit[i] = &sim.acc_limit[i];
+        shared.vel_limit[i] = &sim.vel_limit[i];
+    }
+    shared.stepping = &sim.stepping;
+    shared.enables_new = &sim.enables_new;
+    shared.spindle_direction = &sim.spindle_direction;
+    shared.spindleRevs = &sim.spindleRevs;
+    shared.spindleSpeedIn = &sim.spindleSpeedIn;
+    shared.spindle_speed = &sim.spindle_speed;
+    shared.spindle_index_enable = &sim.spindle_index_enable;
+    shared.spindle_is_atspeed = &sim.spindle_is_atspeed;
+    shared.spindleSync = &sim.spindleSync;
+    shared.current_vel = &sim.current_vel;
+    for (i = 0; i < 9; i++) {
+        shared.dtg[i] = &sim.dtg[i];
+    }
+    shared.requested_vel = &sim.requested_vel;
+    shared.distance_to_go = &sim.distance_to_go;
+    shared.enables_queued = &sim.enables_queued;
+    shared.tcqlen = &sim.tcqlen;
+    // no synced IO or indexing axes in the simulator
+    shared.dioWrite = NULL;
+    shared.aioWrite = NULL;
+    shared.SetRotaryUnlock = NULL;
+    shared.GetRotaryIsUnlocked = NULL;
+    // trivial kinematics on XYZ for joint limited planning
+    shared.KinsInverse = sim_kins_inverse;
+    shared.KinsInverseBatch = sim_kins_inverse_batch;
+    shared.GetJointLimits = sim_get_joint_limits;
+    shared.trace = NULL;
+}
+
+/**
+ * Set up a local ring for the planner event trace, as motion would in HAL
+ * memory.
+ */
+static int sim_events_init(void)
+{
+    size_t size = ring_memsize(RINGTYPE_RECORD, TPSIM_EVENT_RING_SIZE,
+                               sizeof(tp_trace_header_t));
+    ringheader_t *header = calloc(1, size);
+    if (!header) {
+        return -1;
+    }
+    ringheader_init(header, RINGTYPE_RECORD, TPSIM_EVENT_RING_SIZE,
+                    sizeof(tp_trace_header_t));
+    ringbuffer_init(header, &event_ring);
+    ((tp_trace_header_t *) event_ring.scratchpad)->magic = TP_TRACE_MAGIC;
+    shared.trace = &event_ring;
+    return 0;
+}
+
+/**
+ * Copy pending planner events to the event file.
+ */
+static void sim_events_drain(void)
+{
+    const void *data;
+    ringsize_t size;
+
+    if (!shared.trace) {
+        return;
+    }
+    while (record_read(&event_ring, &data, &size) == 0) {
+        fwrite(data, size, 1, events);
+        record_shift(&event_ring);
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Run one planner cycle and account for it.
+ */
+static void sim_cycle(void)
+{
+    double t0 = now_ns();
+    tpRunCycle(&tp, (long)(tp.cycleTime * 1e9));
+    double dt = now_ns() - t0;
+
+    long bin = (long)(dt / TPSIM_HIST_BIN_NS);
+    stats.hist[bin < TPSIM_HIST_BINS ? bin : TPSIM_HIST_BINS]++;
+    stats.cpu_sum += dt;
+    stats.cpu_max = rtapi_fmax(stats.cpu_max, dt);
+    stats.cpu_min = stats.cycles ? rtapi_fmin(stats.cpu_min, dt) : dt;
+
+    stats.cycles++;
+    stats.sim_time += tp.cycleTime;
+    long depth = tcqLen(&tp.queue);
+    stats.depth_sum += depth;
+    if (depth > stats.max_depth) {
+        stats.max_depth = depth;
+    }
+
+    // Finite differences of the commanded position
+    EmcPose pos, disp;
+    tpGetPos(&tp, &pos);
+    emcPoseSub(&pos, &stats.pos_prev, &disp);
+    double mag;
+    emcPoseMagnitude(&disp, &mag);
+    double v = mag / tp.cycleTime;
+    double a = (v - stats.v_prev) / tp.cycleTime;
+    double j = (a - stats.a_prev) / tp.cycleTime;
+    if (stats.cycles > 2) {
+        stats.v_max = rtapi_fmax(stats.v_max, v);
+        stats.a_max = rtapi_fmax(stats.a_max, rtapi_fabs(a));
+        stats.j_max = rtapi_fmax(stats.j_max, rtapi_fabs(j));
+    }
+
+    if (trace) {
+        fprintf(trace, "%.6f,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%ld,%d,%.0f\n",
+                stats.sim_time,
+                pos.tran.x, pos.tran.y, pos.tran.z,
+                v, a, j,
+                depth,
+                tpGetExecId(&tp),
+                dt);
+    }
+
+    stats.pos_prev = pos;
+    stats.v_prev = v;
+    stats.a_prev = a;
+
+    sim_events_drain();
+}
+
+/**
+ * Run cycles until the queue has room for another segment.
+ */
+static void sim_wait_for_room(void)
+{
+    while (tcqFull(&tp.queue)) {
+        sim_cycle();
+    }
+}
+
+/**
+ * Run cycles until all queued motion is complete.
+ */
+static void sim_drain(void)
+{
+    long idle = 0;
+    EmcPose last = tp.currentPos;
+    while (!tpIsDone(&tp) || tcqLen(&tp.queue)) {
+        sim_cycle();
+        if (memcmp(&last, &tp.currentPos, sizeof(last))) {
+            idle = 0;
+            last = tp.currentPos;
+        } else if (++idle > TPSIM_MAX_IDLE_CYCLES) {
+            fprintf(stderr, "tpsim: planner stalled with %d segments queued\n",
+                    tcqLen(&tp.queue));
+            stats.errors++;
+            tpAbort(&tp);
+            return;
+        }
+    }
+}
+
+static struct state_tag_t sim_tag(int line)
+{
+    struct state_tag_t tag;
+    memset(&tag, 0, sizeof(tag));
+    tag.fields[GM_FIELD_LINE_NUMBER] = line;
+    tag.feed = canon.feed;
+    return tag;
+}
+
+static void sim_check(int res, int line, const char *what)
+{
+    if (res == TP_ERR_OK) {
+        stats.segments++;
+    } else if (res != TP_ERR_ZERO_LENGTH) {
+        fprintf(stderr, "tpsim: %s at line %d failed with %d\n", what, line, res);
+        stats.errors++;
+    }
+}
+
+static void sim_line(int line, EmcPose const * const end, int type)
+{
+    double vel = type == EMC_MOTION_TYPE_TRAVERSE ? canon.vmax :
+        rtapi_fmin(canon.feed, canon.vmax);
+    if (vel <= 0.0) {
+        fprintf(stderr, "tpsim: feed move with zero feed rate at line %d\n", line);
+        stats.errors++;
+        return;
+    }
+    sim_wait_for_room();
+    tpSetId(&tp, canon.next_id++);
+    tpSetPlannedVel(&tp, canon.corner_vel);
+    sim_check(tpAddLine(&tp, *end, type, vel, canon.vmax, canon.amax,
+                    0, 0, -1, sim_tag(line)), line, "tpAddLine");
+    canon.pos = *end;
+}
+
+/**
+ * Translate ARC_FEED arguments into a circle, the same way emccanon does.
+ */
+static void sim_arc(int line, double first_end, double second_end,
+        double first_axis, double second_axis, int rotation,
+        double axis_end, double a, double b, double c)
+{
+    EmcPose end = canon.pos;
+    PmCartesian center, normal;
+    end.a = a;
+    end.b = b;
+    end.c = c;
+
+    switch (canon.plane) {
+    case 2: // YZ
+        end.tran.y = first_end;
+        end.tran.z = second_end;
+        end.tran.x = axis_end;
+        center.y = first_axis;
+        center.z = second_axis;
+        center.x = axis_end;
+        normal.x = 1.0; normal.y = 0.0; normal.z = 0.0;
+        break;
+    case 3: // XZ
+        end.tran.z = first_end;
+        end.tran.x = second_end;
+        end.tran.y = axis_end;
+        center.z = first_axis;
+        center.x = second_axis;
+        center.y = axis_end;
+        normal.x = 0.0; normal.y = 1.0; normal.z = 0.0;
+        break;
+    default: // XY
+        end.tran.x = first_end;
+        end.tran.y = second_end;
+        end.tran.z = axis_end;
+        center.x = first_axis;
+        center.y = second_axis;
+        center.z = axis_end;
+        normal.x = 0.0; normal.y = 0.0; normal.z = 1.0;
+        break;
+    }
+
+    if (rotation == 0) {
+        sim_line(line, &end, EMC_MOTION_TYPE_ARC);
+        return;
+    }
+
+    int turn = rotation > 0 ? rotation - 1 : rotation;
+    double vel = rtapi_fmin(canon.feed, canon.vmax);
+    sim_wait_for_room();
+    tpSetId(&tp, canon.next_id++);
+    tpSetPlannedVel(&tp, canon.corner_vel);
+    sim_check(tpAddCircle(&tp, end, center, normal, turn, EMC_MOTION_TYPE_ARC,
+                    vel, canon.vmax, canon.amax, 0, 0, sim_tag(line)),
+            line, "tpAddCircle");
+    canon.pos = end;
+}
+
+/**
+ * Handle a single line of canon output.
+ * Lines look like "   42 N..... STRAIGHT_FEED(1.0000, 2.0000, ...)".
+ */
+static void sim_canon(char *text)
+{
+    int line;
+    char name[64];
+    char *args;
+    double v[9];
+    int n;
+
+    if (sscanf(text, "%d", &line) != 1) {
+        return;
+    }
+    // skip the sequence number and the N word
+    args = strchr(text, 'N');
+    if (!args || !(args = strchr(args, ' '))) {
+        return;
+    }
+    if (sscanf(args, " %63[A-Z_]", name) != 1) {
+        return;
+    }
+    args = strchr(args, '(');
+    if (!args) {
+        return;
+    }
+    args++;
+
+    if (!strcmp(name, "STRAIGHT_FEED") || !strcmp(name, "STRAIGHT_TRAVERSE")) {
+        EmcPose end = canon.pos;
+        n = sscanf(args, "%lf, %lf, %lf, %lf, %lf, %lf",
+                &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]);
+        if (n < 3) {
+            return;
+        }
+        end.tran.x = v[0];
+        end.tran.y = v[1];
+        end.tran.z = v[2];
+        if (n == 6) {
+            end.a = v[3];
+            end.b = v[4];
+            end.c = v[5];
+        }
+        sim_line(line, &end, name[9] == 'F' ?
+                EMC_MOTION_TYPE_FEED : EMC_MOTION_TYPE_TRAVERSE);
+    } else if (!strcmp(name, "ARC_FEED")) {
+        int rotation;
+        n = sscanf(args, "%lf, %lf, %lf, %lf, %d, %lf, %lf, %lf, %lf",
+                &v[0], &v[1], &v[2], &v[3], &rotation, &v[4], &v[5], &v[6], &v[7]);
+        if (n < 6) {
+            return;
+        }
+        if (n < 9) {
+            v[5] = canon.pos.a;
+            v[6] = canon.pos.b;
+            v[7] = canon.pos.c;
+        }
+        sim_arc(line, v[0], v[1], v[2], v[3], rotation, v[4], v[5], v[6], v[7]);
+    } else if (!strcmp(name, "SET_FEED_RATE")) {
+        if (sscanf(args, "%lf", &v[0]) == 1) {
+            // canon feed rates are per minute, motion runs per second
+            canon.feed = v[0] / 60.0;
+        }
+    } else if (!strcmp(name, "SELECT_PLANE")) {
+        if (strstr(args, "YZ")) {
+            canon.plane = 2;
+        } else if (strstr(args, "XZ")) {
+            canon.plane = 3;
+        } else {
+            canon.plane = 1;
+        }
+    } else if (!strcmp(name, "SET_MOTION_CONTROL_MODE")) {
+        if (strstr(args, "CANON_CONTINUOUS")) {
+            double tolerance = 0.0;
+            char *comma = strchr(args, ',');
+            if (comma) {
+                sscanf(comma + 1, "%lf", &tolerance);
+            }
+            tpSetTermCond(&tp, TC_TERM_COND_PARABOLIC, tolerance);
+        } else if (strstr(args, "CANON_EXACT_PATH")) {
+            tpSetTermCond(&tp, TC_TERM_COND_EXACT, 0.0);
+        } else {
+            tpSetTermCond(&tp, TC_TERM_COND_STOP, 0.0);
+        }
+    } else if (!strcmp(name, "DWELL")) {
+        if (sscanf(args, "%lf", &v[0]) == 1) {
+            sim_drain();
+            stats.dwell_time += v[0];
+        }
+    } else if (!strcmp(name, "PROGRAM_END") || !strcmp(name, "PROGRAM_STOP") ||
+            !strcmp(name, "OPTIONAL_PROGRAM_STOP") || !strcmp(name, "CHANGE_TOOL")) {
+        // queue busters in task
+        sim_drain();
+    }
+}
+
+static double hist_percentile(double p)
+{
+    long target = (long)(p * stats.cycles);
+    long count = 0;
+    int i;
+    for (i = 0; i <= TPSIM_HIST_BINS; i++) {
+        count += stats.hist[i];
+        if (count > target) {
+            return (i + 1) * TPSIM_HIST_BIN_NS;
+        }
+    }
+    return stats.cpu_max;
+}
+
+static void print_summary(FILE *out)
+{
+    double mean = stats.cycles ? stats.cpu_sum / stats.cycles : 0.0;
+    fprintf(out, "segments = %ld\n", stats.segments);
+    fprintf(out, "errors = %ld\n", stats.errors);
+    fprintf(out, "cycles = %ld\n", stats.cycles);
+    fprintf(out, "cycle_time = %g\n", tp.cycleTime);
+    fprintf(out, "machining_time = %.6f\n", stats.sim_time + stats.dwell_time);
+    fprintf(out, "motion_time = %.6f\n", stats.sim_time);
+    fprintf(out, "queue_depth_max = %ld\n", stats.max_depth);
+    fprintf(out, "queue_depth_mean = %.2f\n",
+            stats.cycles ? stats.depth_sum / stats.cycles : 0.0);
+    fprintf(out, "cpu_ns_min = %.0f\n", stats.cpu_min);
+    fprintf(out, "cpu_ns_mean = %.0f\n", mean);
+    fprintf(out, "cpu_ns_p50 = %.0f\n", hist_percentile(0.5));
+    fprintf(out, "cpu_ns_p99 = %.0f\n", hist_percentile(0.99));
+    fprintf(out, "cpu_ns_p999 = %.0f\n", hist_percentile(0.999));
+    fprintf(out, "cpu_ns_max = %.0f\n", stats.cpu_max);
+    fprintf(out, "vel_max = %.6f\n", stats.v_max);
+    fprintf(out, "acc_max = %.6f\n", stats.a_max);
+    fprintf(out, "jerk_max = %.6f\n", stats.j_max);
+}
+
+static void print_histogram(FILE *out)
+{
+    int i;
+    fprintf(out, "# cpu time histogram: bin_ns,count\n");
+    for (i = 0; i <= TPSIM_HIST_BINS; i++) {
+        if (stats.hist[i]) {
+            fprintf(out, "%d,%ld\n", i * TPSIM_HIST_BIN_NS, stats.hist[i]);
+        }
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options] [canon-file]\n"
+            "Reads canon calls as printed by 'rs274 -g' (stdin if no file given).\n"
+            "  -c secs     cycle time (default %g)\n"
+            "  -v vel      machine velocity limit, units/sec (default 10)\n"
+            "  -a acc      machine acceleration limit, units/sec^2 (default 100)\n"
+            "  -q size     TC queue size (default %d, minimum %d)\n"
+            "  -d depth    arc blend optimization depth (default 50)\n"
+            "  -B          disable arc blends (parabolic blending only)\n"
+            "  -M          enable collinear segment merging\n"
+            "  -J samples  limit segments by joint limits, sampled N times\n"
+            "  -P vel      corner speed cap sent with every move, as canon does\n"
+            "              for [TRAJ]PREPLAN_MAX_JERK\n"
+            "  -t file     write per-cycle trace CSV\n"
+            "  -E file     write the planner event trace (read with tptrace)\n"
+            "  -H          print the per-cycle CPU time histogram\n",
+            prog, TPSIM_DEFAULT_CYCLE_TIME, DEFAULT_TC_QUEUE_SIZE,
+            TPSIM_MIN_QUEUE_SIZE);
+}
+
+int main(int argc, char *argv[])
+{
+    double cycle_time = TPSIM_DEFAULT_CYCLE_TIME;
+    int queue_size = DEFAULT_TC_QUEUE_SIZE;
+    int histogram = 0;
+    FILE *in = stdin;
+    char buf[LINELEN * 2];
+    int opt, i;
+
+    canon.vmax = 10.0;
+    canon.amax = 100.0;
+    canon.corner_vel = -1.0;
+    canon.plane = 1;
+    canon.next_id = 1;
+
+    sim.num_dio = 4;
+    sim.num_aio = 4;
+    sim.arcBlendEnable = 1;
+    sim.arcBlendFallbackEnable = 0;
+    sim.arcBlendOptDepth = 50;
+    sim.arcBlendGapCycles = 4;
+    sim.arcBlendRampFreq = 100.0;
+    sim.arcBlendTangentKinkRatio = 0.1;
+    sim.maxFeedScale = 1.0;
+    sim.net_feed_scale = 1.0;
+    sim.spindle_is_atspeed = 1;
+
+    while ((opt = getopt(argc, argv, "c:v:a:q:d:BMJ:P:t:E:Hh")) != -1) {
+        switch (opt) {
+        case 'c': cycle_time = atof(optarg); break;
+        case 'v': canon.vmax = atof(optarg); break;
+        case 'a': canon.amax = atof(optarg); break;
+        case 'q': queue_size = atoi(optarg); break;
+        case 'd': sim.arcBlendOptDepth = atoi(optarg); break;
+        case 'B': sim.arcBlendEnable = 0; break;
+        case 'M': sim.segmentMergeEnable = 1; break;
+        case 'J': sim.jointLimitSamples = atoi(optarg); break;
+        case 'P': canon.corner_vel = atof(optarg); break;
+        case 't':
+            trace = fopen(optarg, "w");
+            if (!trace) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 'E':
+            events = fopen(optarg, "wb");
+            if (!events) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 'H': histogram = 1; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc) {
+        in = fopen(argv[optind], "r");
+        if (!in) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    if (cycle_time <= 0.0 || queue_size < TPSIM_MIN_QUEUE_SIZE || canon.vmax <= 0.0 || canon.amax <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < 3; i++) {
+        sim.vel_limit[i] = canon.vmax;
+        sim.acc_limit[i] = canon.amax;
+    }
+    init_shared();
+    if (events && sim_events_init()) {
+        fprintf(stderr, "tpsim: failed to allocate the event ring\n");
+        return 1;
+    }
+
+    // motion allocates a few spare TCs for blend arcs
+    tcSpace = calloc(queue_size + 10, sizeof(TC_STRUCT));
+    if (!tcSpace || tpCreate(&tp, queue_size, tcSpace, &shared)) {
+        fprintf(stderr, "tpsim: failed to create trajectory planner\n");
+        return 1;
+    }
+    tpSetCycleTime(&tp, cycle_time);
+    tpSetVmax(&tp, canon.vmax, canon.vmax);
+    tpSetVlimit(&tp, canon.vmax);
+    tpSetAmax(&tp, canon.amax);
+    ZERO_EMC_POSE(canon.pos);
+    tpSetPos(&tp, &canon.pos);
+    stats.pos_prev = canon.pos;
+
+    if (trace) {
+        fprintf(trace, "time,x,y,z,vel,acc,jerk,depth,id,cpu_ns\n");
+    }
+
+    while (fgets(buf, sizeof(buf), in)) {
+        sim_canon(buf);
+    }
+    sim_drain();
+
+    print_summary(stdout);
+    if (histogram) {
+        print_histogram(stdout);
+    }
+
+    if (trace) {
+        fclose(trace);
+    }
+    if (events) {
+        sim_events_drain();
+        if (((tp_trace_header_t *) event_ring.scratchpad)->dropped) {
+            fprintf(stderr, "tpsim: %u planner events dropped\n",
+                    ((tp_trace_header_t *) event_ring.scratchpad)->dropped);
+        }
+        fclose(events);
+        free(event_ring.header);
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    free(tcSpace);
+    return stats.errors ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#!/usr/bin/python2
+# encoding: utf-8
+"""
+tptrace.py
+
+Decodes the trajectory planner event trace (see emc/tp/tp_trace.h), either
+live from the HAL ring motion creates when loaded with tp_trace_size > 0, or
+from a file written by 'tpsim -E'. Prints CSV, or a Chrome trace (JSON) that
+can be loaded in chrome://tracing or Perfetto, with one span per active
+segment and instant events for everything else.
+"""
+
+import sys
+import time
+import json
+import struct
+import argparse
+
+RING_NAME = 'motion.tp-trace'
+RECORD = struct.Struct('=diHHdd')  # must match tp_trace_record_t
+
+# event type: (name, arg, a, b), must match tp_trace_event_t
+EVENTS = {
+    1: ('activate', 'accel_mode', 'length', 'target_vel'),
+    2: ('blend', 'blend_type', 'length', 'blend_vel'),
+    3: ('optimize', 'at_limit', 'finalvel', 'limit'),
+    4: ('split', 'arg', 'time_left', 'finalvel'),
+    5: ('clamp', 'reason', 'new_vel', 'old_vel'),
+    6: ('abort', 'arg', 'current_vel', 'b'),
+}
+CLAMP_REASONS = {1: 'sample', 2: 'joint'}
+
+
+def decode(data):
+    time_, id_, type_, arg, a, b = RECORD.unpack(data)
+    return {'time': time_, 'id': id_, 'type': type_, 'arg': arg, 'a': a, 'b': b}
+
+
+def events_from_file(filename):
+    with open(filename, 'rb') as f:
+        while True:
+            data = f.read(RECORD.size)
+            if len(data) < RECORD.size:
+                return
+            yield decode(data)
+
+
+def events_from_ring(name, follow, poll):
+    from machinekit import hal
+    r = hal.Ring(name)  # attach now so a missing ring is reported early
+
+    def consume():
+        while True:
+            for rec in r:
+                yield decode(rec.tobytes())
+                r.shift()
+            if not follow:
+                return
+            time.sleep(poll)
+    return consume()
+
+
+def event_name(ev):
+    name = EVENTS.get(ev['type'], ('unknown',))[0]
+    if name == 'clamp':
+        name += '-' + CLAMP_REASONS.get(ev['arg'], str(ev['arg']))
+    return name
+
+
+def write_csv(events, out):
+    out.write('time,event,id,arg,a,b\n')
+    for ev in events:
+        out.write('%.6f,%s,%d,%d,%.9g,%.9g\n' % (ev['time'], event_name(ev),
+                                                 ev['id'], ev['arg'],
+                                                 ev['a'], ev['b']))
+        out.flush()
+
+
+def write_chrome(events, out):
+    trace = []
+    active = None
+    last_time = 0.0
+    try:
+        for ev in events:
+            us = ev['time'] * 1e6
+            last_time = us
+            names = EVENTS.get(ev['type'], ('unknown', 'arg', 'a', 'b'))
+            args = {names[1]: ev['arg'], names[2]: ev['a'], names[3]: ev['b']}
+            if ev['type'] == 1:
+                if active:
+                    active['dur'] = us - active['ts']
+                    trace.append(active)
+                active = {'name': 'segment %d' % ev['id'], 'ph': 'X',
+                          'ts': us, 'pid': 1, 'tid': 1, 'args': args}
+            else:
+                trace.append({'name': event_name(ev), 'ph': 'i', 's': 't',
+                              'ts': us, 'pid': 1, 'tid': 2,
+                              'args': dict(args, id=ev['id'])})
+    except KeyboardInterrupt:
+        pass
+    if active:
+        active['dur'] = last_time - active['ts']
+        trace.append(active)
+    json.dump({'traceEvents': trace, 'displayTimeUnit': 'ms'}, out)
+    out.write('\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the trajectory planner event trace')
+    parser.add_argument('file', nargs='?',
+                        help='event file from tpsim -E (default: read the HAL ring)')
+    parser.add_argument('-r', '--ring', default=RING_NAME,
+                        help='HAL ring name (default %s)' % RING_NAME)
+    parser.add_argument('-f', '--format', choices=['csv', 'chrome'], default='csv',
+                        help='output format (default csv)')
+    parser.add_argument('-F', '--follow', action='store_true',
+                        help='keep reading the ring until interrupted')
+    parser.add_argument('-o', '--output', help='output file (default stdout)')
+    args = parser.parse_args()
+
+    if args.file:
+        events = events_from_file(args.file)
+    else:
+        try:
+            events = events_from_ring(args.ring, args.follow, 0.1)
+        except NameError as e:
+            sys.stderr.write('tptrace: %s\n' % e)
+            sys.exit(1)
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    try:
+        if args.format == 'chrome':
+            write_chrome(events, out)
+        else:
+            write_csv(events, out)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -317,6 +317,10 @@ static PyMemberDef Stat_members[] = {
     {(char*)"rotation_xy", T_DOUBLE, O(task.rotation_xy), READONLY},
     {(char*)"delay_left", T_DOUBLE, O(task.delayLeft), READONLY},
     {(char*)"queued_mdi_commands", T_INT, O(task.queuedMDIcommands), READONLY},
+    {(char*)"prescan_state", T_INT, O(task.prescanState), READONLY},
+    {(char*)"prescan_error_line", T_INT, O(task.prescanErrorLine), READONLY},
+    {(char*)"prescan_time", T_DOUBLE, O(task.prescanTime), READONLY},
+    {(char*)"prescan_file", T_STRING_INPLACE, O(task.prescanFile), READONLY},
 
 // motion
 //   EMC_TRAJ_STAT traj
@@ -331,6 +335,7 @@ static PyMemberDef Stat_members[] = {
     {(char*)"queue", T_INT, O(motion.traj.queue), READONLY},
     {(char*)"active_queue", T_INT, O(motion.traj.activeQueue), READONLY},
     {(char*)"queue_full", T_BOOL, O(motion.traj.queueFull), READONLY},
+    {(char*)"aux_planners", T_INT, O(motion.traj.auxPlanners), READONLY},
     {(char*)"id", T_INT, O(motion.traj.id), READONLY},
     {(char*)"paused", T_BOOL, O(motion.traj.paused), READONLY},
     {(char*)"feedrate", T_DOUBLE, O(motion.traj.scale), READONLY},
@@ -418,6 +423,14 @@ static PyObject *Stat_g5x_offset(pyStatChannel *s) {
     return pose(s->status.task.g5x_offset);
 }
 
+static PyObject *Stat_prescan_min(pyStatChannel *s) {
+    return pose(s->status.task.prescanMin);
+}
+
+static PyObject *Stat_prescan_max(pyStatChannel *s) {
+    return pose(s->status.task.prescanMax);
+}
+
 static PyObject *Stat_g92_offset(pyStatChannel *s) {
     return pose(s->status.task.g92_offset);
 }
@@ -503,6 +516,14 @@ static PyObject *Stat_homed(pyStatChannel *s) {
     return res;
 }
 
+static PyObject *Stat_aux_queue(pyStatChannel *s) {
+    return int_array(s->status.motion.traj.auxQueue, EMCMOT_MAX_AUX_PLANNERS);
+}
+
+static PyObject *Stat_aux_id(pyStatChannel *s) {
+    return int_array(s->status.motion.traj.auxId, EMCMOT_MAX_AUX_PLANNERS);
+}
+
 static PyObject *Stat_ain(pyStatChannel *s) {
     return double_array(s->status.motion.analog_input, EMC_MAX_AIO);
 }
@@ -621,6 +642,8 @@ static PyGetSetDef Stat_getsetlist[] = {
     {(char*)"actual_position", (getter)Stat_actual},
     {(char*)"ain", (getter)Stat_ain},
     {(char*)"aout", (getter)Stat_aout},
+    {(char*)"aux_id", (getter)Stat_aux_id},
+    {(char*)"aux_queue", (getter)Stat_aux_queue},
     {(char*)"axis", (getter)Stat_axis},
     {(char*)"din", (getter)Stat_din},
     {(char*)"dout", (getter)Stat_dout},
@@ -631,6 +654,8 @@ static PyGetSetDef Stat_getsetlist[] = {
     {(char*)"g5x_offset", (getter)Stat_g5x_offset},
     {(char*)"g5x_index", (getter)Stat_g5x_index},
     {(char*)"g92_offset", (getter)Stat_g92_offset},
+    {(char*)"prescan_min", (getter)Stat_prescan_min},
+    {(char*)"prescan_max", (getter)Stat_prescan_max},
     {(char*)"position", (getter)Stat_position},
     {(char*)"dtg", (getter)Stat_dtg},
     {(char*)"joint_position", (getter)Stat_joint_position},
@@ -1047,7 +1072,10 @@ static PyObject *unhome(pyCommandChannel *s, PyObject *o) {
 // Additional call to set Axis Home Params
 static PyObject *set_home_parameters(pyCommandChannel *s, PyObject *o) {
     EMC_AXIS_SET_HOMING_PARAMS m;
-    if(!PyArg_ParseTuple(o, "idddddiiiiii", &m.axis, &m.home, &m.offset, &m.home_final_vel, &m.search_vel, &m.latch_vel, &m.use_index, &m.ignore_limits, &m.is_shared, &m.home_sequence, &m.volatile_home, &m.locking_indexer))
+    m.home_group = 0;
+    m.search_jerk = 0.0;
+    m.index_direct = 0;
+    if(!PyArg_ParseTuple(o, "idddddiiiiii|idi", &m.axis, &m.home, &m.offset, &m.home_final_vel, &m.search_vel, &m.latch_vel, &m.use_index, &m.ignore_limits, &m.is_shared, &m.home_sequence, &m.volatile_home, &m.locking_indexer, &m.home_group, &m.search_jerk, &m.index_direct))
  
         return NULL;
     m.serial_number = next_serial(s);
@@ -1244,6 +1272,42 @@ static PyObject *set_teleop_vector(pyCommandChannel *s, PyObject *o) {
     return Py_None;
 }
 
+static PyObject *aux_move(pyCommandChannel *s, PyObject *o) {
+    EMC_TRAJ_AUX_LINEAR_MOVE m;
+    PyObject *end;
+
+    m.end.a = m.end.b = m.end.c = 0.;
+    m.end.u = m.end.v = m.end.w = 0.;
+
+    if(!PyArg_ParseTuple(o, "iiOddd", &m.planner, &m.id, &end,
+                         &m.vel, &m.ini_maxvel, &m.acc))
+        return NULL;
+    if(!PyArg_ParseTuple(end, "ddd|dddddd", &m.end.tran.x, &m.end.tran.y,
+                         &m.end.tran.z, &m.end.a, &m.end.b, &m.end.c,
+                         &m.end.u, &m.end.v, &m.end.w))
+        return NULL;
+
+    m.serial_number = next_serial(s);
+    s->c->write(m);
+    emcWaitCommandReceived(s->serial, s->s);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject *aux_abort(pyCommandChannel *s, PyObject *o) {
+    EMC_TRAJ_AUX_ABORT m;
+    if(!PyArg_ParseTuple(o, "i", &m.planner))
+        return NULL;
+
+    m.serial_number = next_serial(s);
+    s->c->write(m);
+    emcWaitCommandReceived(s->serial, s->s);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
 static PyObject *set_min_limit(pyCommandChannel *s, PyObject *o) {
     EMC_AXIS_SET_MIN_POSITION_LIMIT m;
     if(!PyArg_ParseTuple(o, "id", &m.axis, &m.limit))
@@ -1367,6 +1431,8 @@ static PyMethodDef Command_methods[] = {
     {"debug", (PyCFunction)debug, METH_VARARGS},
     {"teleop_enable", (PyCFunction)teleop, METH_VARARGS},
     {"teleop_vector", (PyCFunction)set_teleop_vector, METH_VARARGS},
+    {"aux_move", (PyCFunction)aux_move, METH_VARARGS},
+    {"aux_abort", (PyCFunction)aux_abort, METH_VARARGS},
     {"traj_mode", (PyCFunction)set_traj_mode, METH_VARARGS},
     {"wait_complete", (PyCFunction)wait_complete, METH_VARARGS},
     {"state", (PyCFunction)state, METH_VARARGS},
@@ -2254,6 +2320,11 @@ initlinuxcnc(void) {
     ENUMX(9, EMC_TASK_INTERP_PAUSED);
     ENUMX(9, EMC_TASK_INTERP_WAITING);
 
+    ENUMX(9, EMC_TASK_PRESCAN_NONE);
+    ENUMX(9, EMC_TASK_PRESCAN_RUNNING);
+    ENUMX(9, EMC_TASK_PRESCAN_DONE);
+    ENUMX(9, EMC_TASK_PRESCAN_ERROR);
+
     ENUMX(9, EMC_TASK_MODE_MDI);
     ENUMX(9, EMC_TASK_MODE_MANUAL);
     ENUMX(9, EMC_TASK_MODE_AUTO);
@@ -199,6 +199,7 @@ void halg_add_object(const bool use_hal_mutex,
     // insert new object after the new insertion point.
     // if nothing found, insert after head.
     dlist_add_before(&o.hdr->list, args.user_ptr2);
+    hal_data->config_generation++;
 
     // make sure all values visible everywhere
     rtapi_smp_mb();
@@ -219,6 +220,7 @@ int halg_free_object(const bool use_hal_mutex,
     // zap the header, including valid bit
     // marks object for garbage collection by halg_sweep()
     hh_clear_hdr(o.hdr);
+    hal_data->config_generation++;
     // make sure all values visible everywhere
     rtapi_smp_mb();
     return 0;
@@ -332,6 +332,7 @@ void unlink_pin(hal_pin_t * pin)
 	}
 	/* mark pin as unlinked */
 	pin_set_unlinked(pin);
+	hal_data->config_generation++;
 
 	// propagate the news
 	rtapi_smp_mb();
@@ -219,6 +219,11 @@ typedef struct {
 
     unsigned char lock;         /* hal locking, can be one of the HAL_LOCK_* types */
 
+    // bumped whenever an object is added or freed, or a pin is linked or
+    // unlinked; users caching value pointers of pins, signals or params
+    // by name compare it to notice their pointers may be stale
+    unsigned long config_generation;
+
     unsigned long long dead_beef; // value poison for legacy pin data_ptr_addr use
     size_t default_ringsize;    // if no exlicit size given
 
@@ -702,7 +707,7 @@ typedef struct hal_vtable {
    meaningfull error messages in case of a mismatch.
 */
 #include "rtapi_shmkeys.h"
-#define HAL_VER   13	/* version code */
+#define HAL_VER   14	/* version code */
 
 
 /***********************************************************************
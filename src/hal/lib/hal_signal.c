@@ -324,6 +324,7 @@ int halg_link(const int use_hal_mutex,
 	}
 	/* and update the pin */
 	set_signal(pin, sig);
+	hal_data->config_generation++;
 
 	// propagate the pin->signal assignment because
 	// halg_signal_propagate_barriers() triggers on
@@ -1915,24 +1915,22 @@ int pmCircleStretch(PmCircle * const circ, double new_angle, int from_end)
         return PM_ERR;
     }
 
-    double mag = 0;
-    pmCartMagSq(&circ->rHelix, &mag);
-    if ( mag > 1e-6 ) {
-        //Can't handle helices
-        return PM_ERR;
-    }
     //TODO handle spiral?
     if (from_end) {
         //Not implemented yet, way more reprocessing...
-        PmCartesian new_start;
+        PmCartesian new_start, helix_start;
         double start_angle = circ->angle - new_angle;
         pmCirclePoint(circ, start_angle, &new_start);
+        // Move the center up the helix axis to the new start point
+        pmCartScalMult(&circ->rHelix, start_angle / circ->angle, &helix_start);
+        pmCartCartAddEq(&circ->center, &helix_start);
         pmCartCartSub(&new_start, &circ->center, &circ->rTan);
         pmCartCartCross(&circ->normal, &circ->rTan, &circ->rPerp);
         pmCartMag(&circ->rTan, &circ->radius);
     }
-    //Reduce the spiral proportionally
+    //Reduce the spiral and helix proportionally
     circ->spiral *= (new_angle / circ->angle);
+    pmCartScalMultEq(&circ->rHelix, new_angle / circ->angle);
     // Easy to grow / shrink from start
     circ->angle = new_angle;
 
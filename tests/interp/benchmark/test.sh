@@ -0,0 +1,7 @@
+#!/bin/bash
+# the timings vary, the counts must not
+for f in adaptive.ngc surface.ngc macro.ngc; do
+    rs274 -B $f 2>&1 >/dev/null | grep -E '^(program|lines|blocks|canon-calls) '
+    [ ${PIPESTATUS[0]} -eq 0 ] || exit 1
+done
+exit 0
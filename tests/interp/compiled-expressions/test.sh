@@ -0,0 +1,6 @@
+#!/bin/bash
+# the program ends with an error, which goes after the canon calls
+rs274 -g test.ngc 2> stderr | awk '{$1=""; print}'
+grep -v '^executing$' stderr
+rm -f stderr
+exit 0
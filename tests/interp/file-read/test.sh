@@ -0,0 +1,5 @@
+#!/bin/bash
+rs274 -i test.ini -g test.ngc | awk '{$1=""; print}' > loaded
+rs274 -i stdio.ini -g test.ngc | awk '{$1=""; print}' > stdio
+cat loaded
+diff -u loaded stdio
@@ -0,0 +1,5 @@
+#!/bin/bash
+# once for the checkpoint used, once for the canon calls from line 26 on
+rs274 -g -r 26 test.ngc 2>&1 >/dev/null
+rs274 -g -r 26 test.ngc 2>/dev/null | awk '{$1=""; print}'
+exit ${PIPESTATUS[0]}
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+realtime start
+kinsbench trivkins -n 2000
+kinsbench XYZACkins -n 2000 -r a=-90:90 -r c=-180:180
+kinsbench 5axiskins -n 2000 -r b=-45:45 -r c=-180:180
+realtime stop
+
+exit $?
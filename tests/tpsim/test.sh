@@ -0,0 +1,27 @@
+#!/bin/bash
+# Run the planner simulator over the programs here and print the
+# deterministic part of its summary; checkresult checks it.
+run() {
+    name=$1; prog=$2; shift 2
+    echo "run = $name"
+    rs274 -g $prog 2>/dev/null | tpsim "$@" | grep -v '^cpu_ns'
+    [ ${PIPESTATUS[1]} -eq 0 ] || exit 1
+}
+
+run corners corners.ngc
+run corners-parabolic corners.ngc -B
+run corners-capped corners.ngc -P 0.5 -t trace.csv
+# the lowest speed near each vertex of the zigzag, and the highest of those
+awk -F, 'NR > 1 {
+        vx = int($2 + 0.5); vy = (vx % 2) * 5
+        if ((($2 - vx) ^ 2 + ($3 - vy) ^ 2) < 0.01 && vx >= 1 && vx < 20 &&
+            (!(vx in low) || $5 < low[vx]))
+            low[vx] = $5
+    }
+    END { for (v in low) { n++; if (low[v] > m) m = low[v] }
+          printf "corners = %d\ncorner_vel_max = %f\n", n, m }' trace.csv
+rm -f trace.csv
+run arcs arcs.ngc
+run segments segments.ngc
+run segments-merged segments.ngc -M
+exit 0
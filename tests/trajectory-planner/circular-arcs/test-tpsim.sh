@@ -0,0 +1,17 @@
+#!/bin/bash
+# Run the offline planner simulator over a directory of G-code programs and
+# print one summary line per program. Extra arguments are passed to tpsim,
+# e.g. "./test-tpsim.sh nc_files/performance -M" to enable segment merging.
+DIR=${1:-nc_files/performance}
+shift
+printf "%-40s %10s %10s %8s %8s %8s\n" program time cycles p99_ns max_ns depth
+for f in "$DIR"/*.ngc
+do
+    rs274 -g "$f" 2> /dev/null | tpsim "$@" > tpsim.out || echo "$f: tpsim reported errors" >&2
+    awk -v name="$(basename "$f")" '
+        { v[$1] = $3 }
+        END { printf "%-40s %10s %10s %8s %8s %8s\n", name,
+                v["machining_time"], v["cycles"], v["cpu_ns_p99"],
+                v["cpu_ns_max"], v["queue_depth_max"] }' tpsim.out
+done
+rm -f tpsim.out